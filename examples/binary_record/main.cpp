@@ -0,0 +1,46 @@
+#include <Arduino.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Record.h"
+#include "ADS1219Packet.h"
+
+// Same scan as read_single_ended, but written to Serial as binary delta record frames instead of text lines.
+// The frames carry no length, so each one goes out as a COBS framed packet : the host finds the frame
+// boundaries, and lost or damaged frames, with ADS1219PacketReader, e.g. in tools/ads1219_decode.
+
+uint8_t retcode;
+ADS1219 adc;
+ADS1219ScanPlan plan;
+ADS1219RecordEncoder encoder(true);
+ADS1219PacketWriter writer(Serial);
+
+void setup() {
+  delay(2000);
+
+  Serial.begin(115200);
+
+  adc.begin();
+  if ( ! adc.detect() ) {
+    while(true){
+      delay(50);
+    }
+  }
+  adc.reset();
+
+  // Scan the shorted inputs followed by the 4 single ended channels, 10 times per second
+  plan.add(ADS1219_MUX_SHORTED);
+  for ( uint8_t i = 0; i<4; i++ ) plan.addSingleEnded(i);
+  plan.setInterval(100000UL);
+}
+
+void loop() {
+  int32_t values[5];
+  uint8_t frame[ADS1219_RECORD_MAX_FRAME];
+
+  unsigned long t = micros();
+  if ( ! adc.scanIfDue(plan, values) ) return;
+
+  size_t len = encoder.encodeScan(plan, values, t, ADS1219_DATARATE_20SPS, ADS1219_GAIN_ONE, frame, sizeof(frame));
+  writer.send(ADS1219_PACKET_RECORD, frame, len);
+}
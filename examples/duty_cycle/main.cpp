@@ -0,0 +1,54 @@
+#include <Arduino.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219DutyCycle.h"
+
+// Battery powered logging : the 4 single ended channels once a minute at 2 µV RMS noise, with the ADS1219 
+// powered down between the bursts, and the estimated energy per sample
+
+ADS1219 adc;
+ADS1219ScanPlan plan;
+ADS1219DutyCycle duty(adc, plan);
+
+void setup() {
+  delay(2000);
+
+  Serial.begin(115200);
+
+  adc.begin();
+  if ( ! adc.detect() ) {
+    while(true){
+      delay(50);
+    }
+  }
+  adc.reset();
+
+  for ( uint8_t i = 0; i<4; i++ ) plan.addSingleEnded(i);
+
+  // picks the data rate and averaging with the shortest time awake for this noise level
+  duty.setNoise(2.f);
+  duty.begin(60000000UL);
+}
+
+void loop() {
+  int32_t values[4];
+  uint8_t err;
+  ADS1219DutyStats st;
+
+  if ( ! duty.run(values) ) {
+    // the place to put the MCU to sleep until duty.nextBurst()
+    delay(10);
+    return;
+  }
+
+  for ( uint8_t i = 0; i<4; i++ ) {
+    Serial.print(adc.milliVolts(values[i], ADS1219_GAIN_ONE, &err), 4);
+    Serial.print(";");
+  }
+  duty.stats(&st);
+  Serial.print(st.energy_per_sample_uj, 2);
+  Serial.print(" uJ/sample;");
+  Serial.print(st.average_ua, 2);
+  Serial.println(" uA");
+}
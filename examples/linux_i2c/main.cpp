@@ -0,0 +1,41 @@
+#include <Arduino.h>
+
+#include "ADS1219.h"
+#include "ADS1219LinuxI2C.h"
+
+// Linux host (e.g. a Raspberry Pi) with the ADS1219 on /dev/i2c-1, built against the Arduino core of
+// lib/ArduinoNative, without the emulator : pio run -e linux_i2c. The clock follows the host clock so the
+// conversion waits are real.
+
+ADS1219LinuxI2C bus("/dev/i2c-1");
+ADS1219 adc(bus);
+
+void setup() {
+  ArduinoNative::setRealTime(true);
+
+  uint8_t retcode = bus.begin();
+  Serial.print("Open /dev/i2c-1 : "); Serial.println(retcode);
+
+  adc.begin();
+  if ( ! adc.detect() ) {
+    Serial.println("NOT FOUND");
+    return;
+  }
+  adc.reset();
+
+  ADS1219Config config(ADS1219_MUX_SINGLE_0, ADS1219_GAIN_ONE, ADS1219_DATARATE_90SPS);
+  retcode = adc.applyConfig(config);
+  Serial.print("Configure : "); Serial.println(retcode);
+
+  // read the channel 10 times, command and response are one ioctl each
+  for ( int i = 0; i < 10; i++ ) {
+    int32_t value = adc.readSingleEnded(0, &retcode);
+    Serial.print(value);
+    Serial.print(";");
+    Serial.println(retcode);
+  }
+  Serial.print("ioctl calls : "); Serial.println(bus.transfers());
+}
+
+void loop() {
+}
@@ -0,0 +1,26 @@
+#include <Arduino.h>
+
+#include "ADS1219.h"
+#include "ADS1219Packet.h"
+
+// AIN0 at 1000 SPS to the PC as COBS framed packets over USB serial, decode them on the PC with
+//
+//     ads1219_decode -t -c samples.csv /dev/ttyACM0
+//
+// (see tools/ads1219_decode). With DRDY wired to pin 6 no status polls take bus time away from the readout.
+
+ADS1219 adc(0x40, 6);
+ADS1219PacketStream stream(adc, Serial);
+
+void setup() {
+  Serial.begin(921600);
+  while ( ! Serial ) {}
+
+  adc.begin();
+  adc.reset();
+  stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS);
+}
+
+void loop() {
+  stream.service();
+}
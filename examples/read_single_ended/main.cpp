@@ -1,9 +1,11 @@
 #include <Arduino.h>
 
 #include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
 
 uint8_t retcode;
 ADS1219 adc;
+ADS1219ScanPlan plan;
 
 void setup() {
   delay(2000);
@@ -30,17 +32,16 @@ void setup() {
   retcode = adc.reset();
   Serial.print("Return : "); Serial.println(retcode);
 
-  // Setting internal voltage reference (a bit redundant after reset, but ok)
-  adc.setVREF(ADS1219_VREF_INTERNAL);
+  // Internal voltage reference, gain one, single shot at 20 SPS in one register write
+  // (a bit redundant after reset, but ok)
+  ADS1219Config config(ADS1219_MUX_SHORTED, ADS1219_GAIN_ONE, ADS1219_DATARATE_20SPS, 
+                       ADS1219_CM_SINGLE_SHOT, ADS1219_VREF_INTERNAL);
+  retcode = adc.applyConfig(config);
+  Serial.print("Configure : "); Serial.println(retcode);
 
-  // Setting GAIN one
-  adc.setGain(ADS1219_GAIN_ONE);
-
-  // Setting the conversion mode
-  adc.setConversionMode(ADS1219_CM_SINGLE_SHOT);
-
-  // Setting the data rate
-  adc.setDataRate( ADS1219_DATARATE_20SPS );
+  // Scan the shorted inputs followed by the 4 single ended channels
+  plan.add(ADS1219_MUX_SHORTED);
+  for ( uint8_t i = 0; i<4; i++ ) plan.addSingleEnded(i);
 }
 
 void loop() {
@@ -48,9 +49,8 @@ void loop() {
   int32_t values[5];
   float   mvolts[5];
 
-    // read shorted
-  values[0] = adc.readShorted(&retcode);
-  for ( uint8_t i = 0; i<4; i++ ) values[i+1] = adc.readSingleEnded(i, &retcode );
+  // read shorted and the single ended channels in one scan
+  retcode = adc.scan(plan, values);
 
   // convert to mV
   for (uint8_t i = 0; i<5; i++ ) mvolts[i] = adc.milliVolts(values[i], ADS1219_GAIN_ONE, &retcode );
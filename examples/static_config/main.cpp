@@ -0,0 +1,32 @@
+#include <Arduino.h>
+
+#include "ADS1219T.h"
+
+// Fixed configuration : gain 1, internal reference, 90 SPS, single shot. Checked and folded at compile time.
+typedef ADS1219StaticConfig<ADS1219_GAIN_ONE, ADS1219_VREF_INTERNAL, ADS1219_DATARATE_90SPS> Config;
+
+ADS1219T<0x40, 0, ADS1219Wire, Config> adc;
+
+void setup() {
+  delay(2000);
+
+  Serial.begin(9600);
+  Serial.println("Starting up...");
+
+  uint8_t retcode = adc.begin();
+  Serial.print("Begin : "); Serial.println(retcode);
+}
+
+void loop() {
+  uint8_t retcode;
+
+  int32_t value = adc.read<ADS1219_MUX_SINGLE_0>(&retcode);
+
+  Serial.print(value);
+  Serial.print(";");
+  Serial.print(adc.microVolts(value));
+  Serial.print(";");
+  Serial.println(retcode);
+
+  delay(1000);
+}
@@ -3,6 +3,10 @@
 #include <Arduino.h>
 #include <Wire.h>
 
+#include "ADS1219Bus.h"
+
+#include "ADS1219RingBuffer.h"
+
 // Default I2C address, A0 and A1 both to DGND
 #define ADS1219_I2C_ADDRESS      0x40
 
@@ -47,6 +51,68 @@
 #define ADS1219_CM_SINGLE_SHOT   0     // single shot conversion mode
 #define ADS1219_CM_CONTINUOUS    1     // continuous conversion mode
 
+// Config register encodings, constexpr so the compile time ADS1219T template (ADS1219T.h) uses the same ones
+constexpr bool     ads1219_valid_mux( uint8_t mux ) { return ( mux & ~ADS1219_CONFIG_MASK_MUX ) == mux; }
+constexpr uint8_t  ads1219_gain_bits( uint8_t gain ) { return gain == ADS1219_GAIN_FOUR ? ( 1 << 4 ) : 0; }
+constexpr uint8_t  ads1219_config( uint8_t mux, uint8_t gain, uint8_t rate, uint8_t mode, uint8_t vref ) {
+    return mux | ads1219_gain_bits( gain ) | ( rate << 2 ) | ( mode << 1 ) | vref;
+}
+
+// Conversion time in periods of the 1.024 MHz oscillator, see table 4 in the specs. Single-shot conversions
+// are timed from the START/SYNC command, continuous ones from the previous DRDY falling edge.
+constexpr uint32_t ads1219_conversion_clk( uint8_t rate, uint8_t mode ) {
+    return mode == ADS1219_CM_CONTINUOUS ?
+           ( rate == ADS1219_DATARATE_20SPS ? 51192UL : 
+             rate == ADS1219_DATARATE_90SPS ? 11532UL : 
+             rate == ADS1219_DATARATE_330SPS ? 3116UL : 1036UL ) :
+           ( rate == ADS1219_DATARATE_20SPS ? 51213UL : 
+             rate == ADS1219_DATARATE_90SPS ? 11557UL : 
+             rate == ADS1219_DATARATE_330SPS ? 3141UL : 1061UL );
+}
+
+// Conversion time in µs at the nominal oscillator frequency, rounded up
+constexpr uint32_t ads1219_conversion_us( uint8_t rate, uint8_t mode = ADS1219_CM_SINGLE_SHOT ) {
+    return ( ads1219_conversion_clk( rate, mode ) * 1000UL + 1023UL ) / 1024UL;
+}
+
+// Accuracy of the internal oscillator in percent, the conversion times scale with it
+#define ADS1219_OSC_TOLERANCE    2
+
+// Ways to detect the end of a conversion
+#define ADS1219_READY_STATUS     0     // poll the DRDY bit in the status register over I2C (default)
+#define ADS1219_READY_DRDY_POLL  1     // read the DRDY pin with digitalRead
+#define ADS1219_READY_DRDY_IRQ   2     // falling edge interrupt on the DRDY pin
+#define ADS1219_READY_BUS        3     // DRDY line provided by the bus backend (ADS1219Bus::hasDrdy)
+
+// Maximum number of devices which can use the DRDY interrupt, one per I2C address
+#define ADS1219_MAX_DRDY_IRQ     4
+
+// State of a conversion started with beginConversion()
+#define ADS1219_STATE_IDLE       0     // no conversion in progress
+#define ADS1219_STATE_WAITING    1     // conversion started, waiting for the result
+
+// Number of samples buffered while streaming, power of two <= 128
+#ifndef ADS1219_STREAM_BUFFER_SIZE
+#define ADS1219_STREAM_BUFFER_SIZE 32
+#endif
+
+// Register and data reads send the command and read the response with a repeated START in between, set 
+// to 0 for Wire implementations which don't handle a repeated START (see ADS1219::setRepeatedStart)
+#ifndef ADS1219_REPEATED_START
+#define ADS1219_REPEATED_START   1
+#endif
+
+// Number of buckets in the latency histograms, bucket 0 holds < 128 µs, bucket i < 128 << i µs and 
+// the last one everything above
+#define ADS1219_HIST_BUCKETS     12
+
+// Bus instrumentation, only compiled in when ADS1219_ENABLE_STATS is defined (e.g. as a build flag)
+#ifdef ADS1219_ENABLE_STATS
+#define ADS1219_STAT(x) x
+#else
+#define ADS1219_STAT(x)
+#endif
+
 // Some error codes
 #define ADS1219_OK                 0     // all is well
 #define ADS1219_BUFFER_TOO_LARGE   1     // the buffers passed to the _write is too large for the architecture internal Wire buffer
@@ -61,12 +127,132 @@
 #define ADS1219_INVALID_MUX       10     // invalid mux config pattern given
 #define ADS1219_ADC_OVERFLOW      11     // ADS1219 returns 0x7FFFFF -- overflow
 #define ADS1219_ADC_UNDERFLOW     12     // ADS1219 returns 0x800000 -- underflow
+#define ADS1219_VERIFY_FAILED     13     // config register read back does not match the value written
+#define ADS1219_BUSY              14     // a conversion or stream is already in progress
+#define ADS1219_NOT_STARTED       15     // poll() called without a conversion in progress
+#define ADS1219_PLAN_FULL         16     // no more room in the scan plan
+#define ADS1219_FILTER_PENDING    17     // the filter chain holds the sample back (decimating), no new result
+#define ADS1219_RECORD_TRUNCATED  18     // not enough data for a record frame
+#define ADS1219_RECORD_INVALID    19     // malformed record frame, or a value which doesn't fit in one
+#define ADS1219_RECORD_NO_LAYOUT  20     // record frame before the first keyframe, skipped
+#define ADS1219_GROUP_FULL        21     // no more room in the device group
+#define ADS1219_RECORD_FULL       22     // no more room in the record frame
+#define ADS1219_STREAM_IRREGULAR  23     // the stream doesn't deliver a sample per conversion (decimating filter, suppressing window)
+
+// Errors of the bus itself (NACK, lost arbitration, short read), which may go away when tried again
+constexpr bool ads1219_bus_error( uint8_t code ) {
+    return code == ADS1219_FAILED_TO_WRITE || code == ADS1219_FAILED_TO_END || code == ADS1219_FAILED_TO_RECEIVE;
+}
+
+class ADS1219ScanPlan;
+struct ADS1219ScanEntry;
+class ADS1219Filter;
+class ADS1219Window;
+
+
+/**
+ * @brief Result of ADS1219::oversample()
+ */
+struct ADS1219Oversample {
+    int32_t  mean;        //! mean of the valid samples in counts, rounded to the nearest count (halves up)
+    int32_t  value;       //! mean with extra_bits fractional bits, i.e. mean * 2^extra_bits, rounded likewise
+    int32_t  min;         //! smallest valid sample
+    int32_t  max;         //! largest valid sample
+    uint16_t valid;       //! number of valid samples, clipped (over/underflow) samples count as valid
+    uint8_t  extra_bits;  //! number of fractional bits in value
+};
+
+
+/**
+ * @brief Snapshot of the bus instrumentation counters, see ADS1219::stats()
+ * 
+ * The histograms count latencies in µs, per bucket (see ADS1219_HIST_BUCKETS), saturating at 0xFFFF.
+ */
+struct ADS1219Stats {
+    uint32_t writes;          //! number of write transactions
+    uint32_t reads;           //! number of read transactions
+    uint32_t bytes_written;   //! bytes written, excluding the address byte
+    uint32_t bytes_read;      //! bytes read, excluding the address byte
+    uint32_t ready_polls;     //! status register reads by conversionReady()
+    uint32_t timeouts;        //! conversions which timed out
+    uint32_t overflows;       //! conversion results at positive full scale
+    uint32_t underflows;      //! conversion results at negative full scale
+
+    uint16_t readout_us[ADS1219_HIST_BUCKETS];   //! single conversion, from start to result
+    uint16_t register_us[ADS1219_HIST_BUCKETS];  //! register read or write
+    uint16_t scan_us[ADS1219_HIST_BUCKETS];      //! full scan of a scan plan
+
+    /**
+     * @brief Histogram bucket for a latency in µs
+     */
+    static uint8_t bucket( unsigned long us );
+
+    /**
+     * @brief Upper limit (exclusive) in µs of a histogram bucket, 0 for the last, open ended bucket
+     */
+    static unsigned long bucketLimit( uint8_t i );
+};
+
+
+/**
+ * @brief Error recovery counters, see ADS1219::setRetry(), ADS1219::recover() and ADS1219::recovery()
+ */
+struct ADS1219Recovery {
+    uint32_t      retries;         //! transactions repeated after a bus error
+    uint32_t      failures;        //! transactions which still failed after all retries
+    uint32_t      bus_clears;      //! bus clears done by the backend
+    uint32_t      resets;          //! device resets with the configuration replayed
+    unsigned long stall_max_us;    //! longest time from the first bus error of a transaction to its end
+    unsigned long recover_max_us;  //! longest recover()
+};
+
+
+/**
+ * @brief Complete device configuration, applied in one register write by ADS1219::applyConfig()
+ * 
+ * The defaults are the power-on configuration of the device. The reference voltages are only used with 
+ * the external reference, the internal one is always 0 to 2048 mV. 
+ */
+struct ADS1219Config {
+    uint8_t mux;       //! multiplexer setting, one of the ADS1219_MUX_* values
+    uint8_t gain;      //! ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+    uint8_t rate;      //! one of the ADS1219_DATARATE_* values
+    uint8_t mode;      //! ADS1219_CM_SINGLE_SHOT or ADS1219_CM_CONTINUOUS
+    uint8_t vref;      //! ADS1219_VREF_INTERNAL or ADS1219_VREF_EXTERNAL
+    float   aref_n;    //! negative external reference in mV
+    float   aref_p;    //! positive external reference in mV
+
+    ADS1219Config( uint8_t mux = ADS1219_MUX_DIFF_0_1, uint8_t gain = ADS1219_GAIN_ONE, 
+                   uint8_t rate = ADS1219_DATARATE_20SPS, uint8_t mode = ADS1219_CM_SINGLE_SHOT, 
+                   uint8_t vref = ADS1219_VREF_INTERNAL, float aref_n = 0.f, float aref_p = 2048.f )
+        : mux(mux), gain(gain), rate(rate), mode(mode), vref(vref), aref_n(aref_n), aref_p(aref_p) {}
+
+    /**
+     * @brief The configuration register value, only meaningful for a valid configuration
+     */
+    uint8_t reg( void ) const { return ads1219_config( mux, gain, rate, mode, vref ); }
+};
+
+
+/**
+ * @brief Result of a conversion started with beginConversion()
+ */
+struct ADS1219Sample {
+    int32_t value;     //! the raw ADC count, 0x80000000 in case of an error
+    uint8_t mux;       //! multiplexer setting used for the conversion
+    uint8_t err_code;  //! error code of the conversion, ADS1219_OK if all was well
+};
+
 
 /**
  * @brief Class to communicate with and ADS1219 chip via I2C 
  *
  * Most routines return their status code as the return value and return values through pointers in the arguments, 
  * except for the routines which read the conversion results.  
+ * 
+ * The driver keeps a shadow copy of the configuration register, which is refreshed on begin(), reset() and 
+ * syncConfig(). The getters are served from this copy and the setters only write to the device when the 
+ * register value actually changes, so no read-modify-write cycle is needed on the bus.
  */
 class ADS1219 {
 public:
@@ -76,21 +262,43 @@ public:
      * 
      * @param i2c_addr the I2C address, default for this module is 0x40, (A0 and A1  to DGND), see specs for wiring 
      * @param drdy_pin GPIO pin to which the DRDY signal is connected, per default it's not used and the conversion 
-     *        readiness is read from the status register
+     *        readiness is read from the status register. If given, begin() attaches a falling edge interrupt
+     *        to the pin, or falls back to reading the pin if it can't be used as an interrupt.
      * @param wire address of the TwoWire bus object
      */
     ADS1219(uint8_t i2c_addr = ADS1219_I2C_ADDRESS, uint8_t drdy_pin = 0, TwoWire *wire = &Wire);
 
+    /**
+     * @brief Constructor for a device on another bus backend, e.g. ADS1219LinuxI2C
+     * 
+     * @param bus the bus backend, if it provides the DRDY line (ADS1219Bus::hasDrdy) and no pin is given, 
+     *        that's used to detect the end of a conversion
+     * @param i2c_addr the I2C address, default for this module is 0x40
+     * @param drdy_pin GPIO pin to which the DRDY signal is connected, 0 if not used
+     */
+    ADS1219(ADS1219Bus& bus, uint8_t i2c_addr = ADS1219_I2C_ADDRESS, uint8_t drdy_pin = 0);
+
     virtual ~ADS1219();
 
     /**
      * @brief Startup the device
      *
-     * This does nothing more than starting the wire bus and setting the begun flag 
+     * Starts the wire bus, sets the begun flag and loads the shadow copy of the configuration register from
+     * the device. If the device does not respond, the shadow copy is reloaded on the next register access.
+     * 
+     * When a DRDY pin was given to the constructor, the pin is configured here as well.
      */
     void begin( void );
 
 
+    /**
+     * @brief How the end of a conversion is detected
+     * 
+     * @return ADS1219_READY_STATUS, ADS1219_READY_DRDY_POLL or ADS1219_READY_DRDY_IRQ
+     */
+    uint8_t readyMode( void ) { return _ready_mode; }
+
+
     /**
      * @brief Detect presence of the device
      * 
@@ -102,10 +310,10 @@ public:
     /**
      * @brief How many bytes we can read in a transaction
      * 
-     * Depends, see Wire.h for specific architecture. RingBuffer in SAMD seems to have 256, others 32
-     * Note that in I2CDevice from Adafruit, there is 250 for SAMD ??? 
+     * Depends on the bus backend, for Wire see Wire.h for specific architecture. RingBuffer in SAMD seems to 
+     * have 256, others 32. Note that in I2CDevice from Adafruit, there is 250 for SAMD ??? 
      */
-    size_t maxBufferSize() { return _maxBufferSize; }
+    size_t maxBufferSize() { return _bus->maxTransfer(); }
 
 
     /**
@@ -115,6 +323,9 @@ public:
      * latched before starting to communicate with the device as long as the timing requirements (see the I2C Timing
      * Requirements table) for the (repeated) START and STOP conditions are met.
      * 
+     * On success the shadow copy of the configuration register is set to its default value (0x00) and the 
+     * analog references are set back to the internal 2.048 V reference.
+     * 
      * @return error code
      */
     uint8_t reset(void);
@@ -123,6 +334,8 @@ public:
     /**
      * @brief Start command
      * 
+     * Also clears the pending DRDY interrupt count, so a following wait only sees the new conversion.
+     * 
      *  @return error code
      */
     uint8_t start(void);
@@ -141,6 +354,132 @@ public:
     uint8_t powerDown(void);
 
 
+    /**
+     * @brief Resynchronise the shadow copy of the configuration register from the device
+     * 
+     * Use this when the device may have been changed behind the driver's back, e.g. after a brown-out or
+     * when another bus master wrote the register. 
+     * 
+     * @return error code
+     */
+    uint8_t syncConfig(void);
+
+
+    /**
+     * @brief Use a repeated START between the command and the response of register and data reads
+     * 
+     * With a repeated START, the RREG or RDATA command and the read of the result form one bus transaction : 
+     * no STOP and bus free time in between, and no other master can get on the bus. Disable it for Wire 
+     * implementations which don't handle endTransmission(false) properly, the command is then sent with a 
+     * STOP, as two separate transactions. The default is set by ADS1219_REPEATED_START. 
+     * 
+     * @param repeated_start true to use the repeated START
+     */
+    void setRepeatedStart( bool repeated_start ) { _repeated_start = repeated_start; }
+
+
+    /**
+     * @brief Apply a complete configuration in one bus transaction
+     * 
+     * All fields are validated before anything is sent, then the register is written with a single WREG, 
+     * or not at all if it already holds this value. The reference voltages used for the conversion to 
+     * voltages are updated along with it, so switching between measurement profiles is one transaction. 
+     * 
+     * @param config the configuration to apply
+     * 
+     * @return error code, ADS1219_INVALID_* if a field is out of range, nothing is changed in that case
+     */
+    uint8_t applyConfig( const ADS1219Config& config );
+
+
+    /**
+     * @brief Read the complete configuration from the device with one RREG
+     * 
+     * The shadow copy of the register is refreshed as well. The reference voltages are the ones known 
+     * by the driver, they're not stored in the device. 
+     * 
+     * @param config variable pointer to recieve the configuration
+     * 
+     * @return error code
+     */
+    uint8_t readConfig( ADS1219Config* config );
+
+
+    /**
+     * @brief Returns the configuration register as known by the driver
+     * 
+     * @param config variable pointer to recieve the register value
+     * 
+     * @return error code
+     */
+    uint8_t getConfig( uint8_t* config );
+
+
+    /**
+     * @brief Enable or disable verification of register writes
+     * 
+     * When enabled, every write of the configuration register is followed by a read back of the register. A 
+     * mismatch returns ADS1219_VERIFY_FAILED and the shadow copy is reloaded from the device. 
+     * 
+     * @param verify true to enable verification (default off)
+     */
+    void setVerify( bool verify ) { _verify = verify; }
+
+
+    /**
+     * @brief Retry policy for bus errors (ADS1219_FAILED_TO_WRITE, _TO_END and _TO_RECEIVE)
+     * 
+     * A failed transaction is repeated straight away, further retries first let the bus backend clear the 
+     * bus, in case the device holds SDA low (see setBusClearPins()). No retry starts once the deadline has 
+     * passed since the first error, which bounds the stall of a single transaction.
+     * 
+     * @param retries number of retries per transaction, 0 (default) returns the first error
+     * @param deadline_us time after the first error after which no more retries start, 0 for no limit
+     */
+    void setRetry( uint8_t retries, unsigned long deadline_us = 0 ) { _retries = retries; _deadline_us = deadline_us; }
+
+
+    /**
+     * @brief Recover the device automatically when a transaction fails all its retries
+     * 
+     * The single readouts (readSingleEnded(), scan entries, ...) and the register writes of scans then call 
+     * recover() and try once more, so a glitch costs a delayed sample rather than a lost one. 
+     * 
+     * @param enable true to enable (default off)
+     */
+    void setAutoRecover( bool enable ) { _auto_recover = enable; }
+
+
+    /**
+     * @brief Bring the device back to a known state after bus errors
+     * 
+     * Clears the bus, resets the device and writes back the last configuration written successfully (and 
+     * the reference voltages). If that write fails too, the next recover() replays the same configuration. 
+     * A stream in progress is restarted. Any conversion in progress with beginConversion() is abandoned.
+     * 
+     * @return error code
+     */
+    uint8_t recover( void );
+
+
+    /**
+     * @brief SDA and SCL pins for the bus clear of the TwoWire backend
+     * 
+     * The bus clear releases the Wire peripheral, clocks SCL until the device lets go of SDA (at most 9 
+     * clocks), sends a STOP and restarts Wire at the given clock. The lines are only ever pulled low, the bus 
+     * pull-ups take them high. Without the pins it only restarts Wire. 
+     * Only for the TwoWire constructor, other backends have their own bus recovery. 
+     */
+    void setBusClearPins( uint8_t sda_pin, uint8_t scl_pin, uint32_t clock = 100000 ) { _wire_bus.setClearPins( sda_pin, scl_pin, clock ); }
+
+
+    /**
+     * @brief Error recovery counters
+     */
+    void recovery( ADS1219Recovery* recovery ) const { *recovery = _recovery; }
+    void resetRecovery( void );
+
+
     /**
      * @brief return the device gain
      * 
@@ -235,19 +574,58 @@ public:
     /**
      * @brief returns the conversion time in ms, depending on the configured datarate
      * 
-     * This routine checks the register for the current datarate & calculates the 
-     * conversion time in ms. The conversion time is given by table 4 in the specs and 
-     * is roughly independent of the conversion mode. It's value is given by 1000 devided 
-     * by the datarate : 20, 90, 330 or 1000, so being 50 ms, 11 ms, 3 ms or 1 ms. 
+     * This routine checks the shadow register for the current datarate & returns the single-shot 
+     * conversion time of table 4 in the specs, rounded up to the next ms : 51 ms, 12 ms, 4 ms or 2 ms. 
+     * Use getConversionTimeMicros() for the exact value. 
      * 
      * If an error is encountered during the reading of the register, the largest conversion
-     * rate of 50 ms is returned. 
+     * rate of 51 ms is returned. 
      * 
      * @return conversion time in ms 
      */
     uint16_t getConversionTime( void );
 
 
+    /**
+     * @brief returns the conversion time in µs for the configured datarate and conversion mode
+     * 
+     * Without adaptive timing this is the value of table 4 in the specs at the nominal oscillator 
+     * frequency. With adaptive timing it's the conversion time learned from this device, once known. 
+     * In continuous mode it's the time between two results, the first one takes the single-shot time. 
+     * 
+     * If an error is encountered during the reading of the register, the 20 SPS time is returned. 
+     * 
+     * @return conversion time in µs
+     */
+    unsigned long getConversionTimeMicros( void );
+
+
+    /**
+     * @brief Enable or disable adaptive conversion timing
+     * 
+     * The internal oscillator is only accurate to 2 %, so without adaptive timing the first status poll 
+     * happens 2 % after the nominal conversion time. With adaptive timing the driver learns the actual 
+     * conversion time of the device per datarate from the observed DRDY or status transitions and checks 
+     * the status just after it, which cuts the time lost after each conversion without extra status reads. 
+     * 
+     * @param adaptive true to enable adaptive timing (default off)
+     */
+    void setAdaptiveTiming( bool adaptive ) { _adaptive = adaptive; }
+
+
+    /**
+     * @brief returns the learned single-shot conversion time in µs for a datarate
+     * 
+     * The time is counted from the end of the START command. When polling the status register it's the time 
+     * to start the status read, so it's shorter than the actual conversion time by the latency of that read. 
+     * 
+     * @param rate ADS1219_DATARATE_20SPS, ADS1219_DATARATE_90SPS, ADS1219_DATARATE_330SPS or ADS1219_DATARATE_1000SPS
+     * 
+     * @return learned conversion time in µs, 0 if no conversion was observed at this datarate yet
+     */
+    unsigned long learnedConversionTime( uint8_t rate ) const { return ( _learned[rate & 0x03] + 8 ) >> 4; }
+
+
     /**
      * @brief Checks the status register to see if a conversion result is ready
      * 
@@ -260,12 +638,24 @@ public:
     bool conversionReady( uint8_t* err_code );
 
 
+    /**
+     * @brief Checks the DRDY pin to see if a conversion result is ready
+     * 
+     * Does not use the I2C bus. In interrupt mode this checks whether a falling edge was seen since the last
+     * start(), in pin mode the DRDY pin is read directly (active low). Always false if no DRDY pin is used.
+     * 
+     * @return true if a conversion result is ready 
+     */
+    bool drdyReady( void );
+
+
     /**
      * @brief Reads a single ended result from channel
      * 
      * @param channel the channel number to read 0-3
      * @param err_code returns an error code, 0 if all was well
-     * @param offset_cycles the number of offset cycles to assess the internal bias (default 0)
+     * @param offset_cycles the number of offset cycles to assess the internal bias (default 0), with 0 and 
+     * setOffsetCorrection(true) the cached offset is subtracted instead, without any extra conversion
      * 
      * @return the value
      */
@@ -275,14 +665,261 @@ public:
     /**
      * @brief Read shorted value
      * 
+     * For more than 1 sample, the average is computed by oversample(), rounded to the nearest count.
+     * 
      * @param err_code returns an error code, 0 if all was well
      * @param samples read and average over this many samples, default 1
      * 
-     * @return the value
+     * @return the value, 0x80000000 if no valid sample was read
      */
     int32_t readShorted(uint8_t* err_code, uint16_t samples = 1 );
 
 
+    /**
+     * @brief Subtract the cached offset from the readouts
+     * 
+     * The driver keeps the offset (the result of a conversion of the shorted inputs) per gain and data rate. 
+     * With the correction enabled, readSingleEnded() without offset samples and every scan entry (except the 
+     * shorted input itself) get the cached offset of the gain and data rate of their conversion subtracted, 
+     * at no extra conversion. Without a cached offset for the combination the result is left as it is. 
+     * 
+     * @param enable true to enable (default off)
+     */
+    void setOffsetCorrection( bool enable ) { _offset_correction = enable; }
+
+
+    /**
+     * @brief Keep the offset cache up to date from the scans
+     * 
+     * A scan which is due for a refresh adds one conversion of the shorted inputs after its entries, at the 
+     * data rate and (in turns) at each gain of its entries, and folds it into the cache with an exponential 
+     * average. A scan is also due when it used a gain without a cached offset, or after requestOffsetRefresh().
+     * 
+     * @param every_scans refresh every this many scans, 0 for no scan count
+     * @param every_us refresh when this much time has passed since the last one, 0 for no timer
+     * @param shift weight of a new conversion in the average is 1 / 2^shift, default 3 (1/8)
+     */
+    void setOffsetRefresh( uint16_t every_scans, unsigned long every_us = 0, uint8_t shift = 3 );
+
+
+    /**
+     * @brief Refresh the offset cache on the next scan, e.g. after a temperature change
+     */
+    void requestOffsetRefresh( void ) { _offset_due = true; }
+
+
+    /**
+     * @brief Measure the offset at the current gain and data rate and put it in the cache
+     * 
+     * @param samples number of conversions averaged, see readShorted()
+     * 
+     * @return error code
+     */
+    uint8_t calibrateOffset( uint16_t samples = 16 );
+
+
+    /**
+     * @brief Cached offset in counts for a data rate and gain
+     * 
+     * @return false if there is none
+     */
+    bool cachedOffset( uint8_t rate, uint8_t gain, int32_t* offset ) const;
+
+
+    /**
+     * @brief Empty the offset cache
+     */
+    void clearOffsets( void ) { _offset_valid = 0; }
+
+
+    /**
+     * @brief Number of shorted conversions added to scans by the offset refresh
+     */
+    uint32_t offsetRefreshes( void ) const { return _offset_refreshes; }
+
+
+    /**
+     * @brief Run all measurements in a scan plan
+     * 
+     * The entries are measured in order. Between consecutive entries only the register bits which differ 
+     * (multiplexer and gain) are written, in a single register write. Entries with more than one sample 
+     * return the rounded average of the valid conversions. 
+     * 
+     * @param plan the scan plan
+     * @param results array with room for plan.size() values, receives the raw ADC counts
+     * @param err_codes optional array with room for plan.size() error codes
+     * 
+     * @return error code, the first error encountered during the scan, ADS1219_BUSY without touching the 
+     * device if a conversion or stream is in progress
+     */
+    uint8_t scan( ADS1219ScanPlan& plan, int32_t* results, uint8_t* err_codes = nullptr );
+
+
+    /**
+     * @brief Run the scan plan if its interval (see ADS1219ScanPlan::setInterval) has passed
+     * 
+     * Call this from the main loop. Scans are scheduled on a fixed cadence from the moment the interval was 
+     * set, if a scan is late by more than one interval the schedule restarts from now. 
+     * 
+     * @return true if a scan was done, results and err_codes are only updated in that case
+     */
+    bool scanIfDue( ADS1219ScanPlan& plan, int32_t* results, uint8_t* err_codes = nullptr );
+
+
+    /**
+     * @brief Start a conversion without waiting for the result
+     * 
+     * Sets the multiplexer (only written when it changes) and issues a START, then returns. Use poll() to 
+     * collect the result, in between the MCU and the bus are free for other work.
+     * 
+     * @param mux the multiplexer setting, one of the ADS1219_MUX_* values
+     * 
+     * @return error code, ADS1219_BUSY if a conversion or stream is already running
+     */
+    uint8_t beginConversion( uint8_t mux );
+
+
+    /**
+     * @brief Advance the conversion started with beginConversion()
+     * 
+     * Never blocks. The bus is not used before the conversion time has passed, after that the status 
+     * register is checked at most once every 1 ms (5 ms at 20 SPS), or the DRDY pin is checked if one is used.
+     * 
+     * @param sample receives the result once the conversion is done, or timed out
+     * 
+     * @return true when the sample is filled in and the driver is idle again
+     */
+    bool poll( ADS1219Sample* sample );
+
+    /**
+     * @brief micros() just after the START command of the last conversion (or oversampling run)
+     */
+    unsigned long conversionStart( void ) const { return _conv_start_us; }
+
+    /**
+     * @brief micros() at which the end of the last conversion (the last one of an oversampling run) was 
+     * seen, through DRDY or the status register, just before its data is read
+     */
+    unsigned long conversionEnd( void ) const { return _conv_end_us; }
+
+
+    /**
+     * @brief State of the asynchronous conversion
+     * 
+     * @return ADS1219_STATE_IDLE or ADS1219_STATE_WAITING
+     */
+    uint8_t conversionState( void ) { return _conv_state; }
+
+
+    /**
+     * @brief Start streaming conversions in continuous mode
+     * 
+     * Sets the multiplexer, data rate and continuous conversion mode in a single register write and issues 
+     * one START. After that, serviceStream() only needs an RDATA read for every conversion, the results are 
+     * collected in a fixed size ring buffer (ADS1219_STREAM_BUFFER_SIZE) to be read with readBuffered(). 
+     * 
+     * With a filter chain, every sample goes through the chain first and only its outputs are buffered, so 
+     * a decimating filter also reduces the rate at which the buffer fills. 
+     * 
+     * @param mux the multiplexer setting, one of the ADS1219_MUX_* values
+     * @param rate the data rate, one of the ADS1219_DATARATE_* values
+     * @param filter optional filter chain (ADS1219Filter.h) for the samples, nullptr (default) for raw counts
+     * 
+     * @return error code
+     */
+    uint8_t startStream( uint8_t mux, uint8_t rate, ADS1219Filter* filter = nullptr );
+
+
+    /**
+     * @brief Stop streaming, puts the device back in single shot mode
+     * 
+     * Samples which are still in the buffer can be read afterwards.
+     * 
+     * @return error code
+     */
+    uint8_t stopStream( void );
+
+
+    /**
+     * @brief Move a finished conversion from the device into the stream buffer
+     * 
+     * This is the producer side of the stream. Call it from the main loop, or from a timer interrupt on cores 
+     * where the Wire library can be used in interrupt context, at least once per conversion period. When using
+     * the DRDY interrupt, conversions which went by without being read are counted as overruns, as are 
+     * samples which don't fit in the buffer anymore. 
+     * 
+     * @return error code, ADS1219_OK also when there was no new conversion yet
+     */
+    uint8_t serviceStream( void );
+
+
+    /**
+     * @brief Number of samples waiting in the stream buffer
+     */
+    size_t available( void ) { return _stream.size(); }
+
+
+    /**
+     * @brief Read samples from the stream buffer, consumer side of the stream
+     * 
+     * @param out array to recieve the raw ADC counts
+     * @param n maximum number of samples to read
+     * 
+     * @return the number of samples copied to out
+     */
+    size_t readBuffered( int32_t* out, size_t n );
+
+
+    /**
+     * @brief Number of samples lost since startStream(), either not read from the device in time or not 
+     *        fitting in the buffer
+     */
+    uint32_t overruns( void ) { return _overruns; }
+
+
+    /**
+     * @brief Attach a window comparator (ADS1219Window.h) to a multiplexer setting
+     * 
+     * Every conversion of that multiplexer setting goes through the comparator, right where it's read from 
+     * the device, whichever way it was started. The thresholds of the window are converted to counts with 
+     * the reference of the driver now and whenever it changes. With the window's suppression on, a stream 
+     * on that multiplexer setting only buffers the samples which complete a crossing.
+     * 
+     * @param mux the multiplexer setting, one of the ADS1219_MUX_* values
+     * @param window the comparator, nullptr to detach the one attached, it must stay alive while attached
+     * 
+     * @return error code
+     */
+    uint8_t setWindow( uint8_t mux, ADS1219Window* window );
+
+
+    /**
+     * @brief Window comparator attached to a multiplexer setting, nullptr if none
+     */
+    ADS1219Window* window( uint8_t mux ) { return _windows[ mux >> 5 ]; }
+
+
+    /**
+     * @brief Average a number of conversions on one multiplexer setting
+     * 
+     * The device is switched to continuous conversion mode (together with the multiplexer, in one register 
+     * write) and started once, then every sample only costs an RDATA read. Afterwards the conversion mode is 
+     * set back to what it was. The samples are summed in a 64 bit accumulator. When all samples are valid and 
+     * their number is a power of two, the mean is decimated with a rounding shift, otherwise it's divided by 
+     * the number of valid samples. Both round to the nearest value, halves up. With extra_bits > 0, value 
+     * holds the mean with that many extra bits of resolution (which is only meaningful when the noise dithers
+     * the samples).
+     * 
+     * @param mux the multiplexer setting, one of the ADS1219_MUX_* values
+     * @param samples number of conversions
+     * @param result structure to recieve the mean, min, max and number of valid samples
+     * @param extra_bits number of fractional bits in result->value, 0-7
+     * 
+     * @return error code, the last bus or timeout error, or ADS1219_ADC_OVERFLOW/UNDERFLOW if samples were clipped
+     */
+    uint8_t oversample( uint8_t mux, uint16_t samples, ADS1219Oversample* result, uint8_t extra_bits = 0 );
+
+
     /**
      * @brief Convert to millivolt
      * 
@@ -295,6 +932,52 @@ public:
     float milliVolts(int32_t adc_count, uint8_t gain, uint8_t* err_code);
 
 
+    /**
+     * @brief Convert a batch of raw ADC counts to microvolts, in fixed point
+     * 
+     * Uses a 64 bit fixed point scale (µV per count, 32 fractional bits), which is computed once whenever the 
+     * reference or the gain changes, so there is no floating point math per sample. The result is rounded to
+     * the nearest µV, halves are rounded up (towards +infinity), i.e. out = floor( counts * scale + 0.5 ).
+     * The scale itself is rounded to the nearest 2^-32 µV from the float reference span, for the internal 
+     * reference it is exact. The gain is the one currently configured in the device.
+     * 
+     * @param counts array of raw ADC counts
+     * @param out array to recieve the values in µV, may be the same array as counts
+     * @param n number of values
+     */
+    void toMicroVolts(const int32_t* counts, int32_t* out, size_t n);
+
+
+    /**
+     * @brief Convert a batch of raw ADC counts to millivolts, in floating point
+     * 
+     * Same as milliVolts(), but with the scale precomputed for the current reference and gain, so only one 
+     * multiplication per sample. Meant for architectures with an FPU, e.g. SAMD. 
+     * 
+     * @param counts array of raw ADC counts
+     * @param out array to recieve the values in mV
+     * @param n number of values
+     */
+    void toMilliVolts(const int32_t* counts, float* out, size_t n);
+
+
+    /**
+     * @brief Get a snapshot of the bus instrumentation
+     * 
+     * Only available when the library is built with ADS1219_ENABLE_STATS, otherwise the counters cost nothing
+     * and the snapshot is all zeros.
+     * 
+     * @param stats structure to recieve the counters and histograms
+     */
+    void stats( ADS1219Stats* stats );
+
+
+    /**
+     * @brief Set all instrumentation counters and histograms to zero
+     */
+    void resetStats( void );
+
+
     /**
      * @brief Send a single byte command, low level routine to build the above more advances
      * 
@@ -305,29 +988,110 @@ public:
     uint8_t send_cmd(uint8_t cmd);
 
 private:
+    // Common constructor : bus is the backend in use, nullptr for the TwoWire backend on wire
+    ADS1219(ADS1219Bus* bus, TwoWire* wire, uint8_t i2c_addr, uint8_t drdy_pin);
+
     // Low level routines
-    uint8_t _write(const uint8_t *buffer, size_t len, bool stop = true, const uint8_t *prefix_buffer = nullptr, size_t prefix_len = 0);
+    uint8_t _write(const uint8_t *buffer, size_t len, bool stop = true);
     uint8_t _read(uint8_t *buffer, size_t len, bool stop = true);
 
+    uint8_t _command_read(uint8_t cmd, uint8_t* buffer, size_t len);
     uint8_t _read_register(uint8_t reg, uint8_t* data);
     uint8_t _write_register(uint8_t data);
     uint8_t _modify_register(uint8_t value, uint8_t mask );
+    uint8_t _get_config(uint8_t* data);
+    void    _set_config(uint8_t data);
+    void    _update_scale( void );
 
     int32_t _read_value( uint8_t* err_code );
     int32_t _readout( uint8_t mux, uint8_t* err_code );
+    int32_t _scan_entry( const ADS1219ScanEntry& e, uint8_t gain, uint8_t* err_code );
+    bool    _retry( uint8_t code, uint8_t attempt, unsigned long* tfail );
+    bool    _try_recover( uint8_t code );
+    void    _offset_update( int32_t value, bool replace );
+    int32_t _offset_correct( int32_t value );
+    void    _offset_refresh( ADS1219ScanPlan& plan );
+    uint8_t _wait_conversion( unsigned long deadline_us, unsigned long ct_us );
+    unsigned long _expected_us( uint8_t config );
+    void    _learn( uint8_t rate, unsigned long miss_us, unsigned long ready_us );
+    unsigned long _margin_us( unsigned long ct_us ) const { return _adaptive ? ct_us >> 7 : ct_us * ADS1219_OSC_TOLERANCE / 100; }
+
+    static void _stats_hist( uint16_t* hist, unsigned long us );
+
+    void    _attach_drdy( void );
+    void    _detach_drdy( void );
+    
+    static void _drdy_isr0( void );
+    static void _drdy_isr1( void );
+    static void _drdy_isr2( void );
+    static void _drdy_isr3( void );
+
+    static ADS1219* _drdy_devices[ADS1219_MAX_DRDY_IRQ]; //! devices using the DRDY interrupt, indexed by slot
 
 private:
     uint8_t  _i2c_addr;   //! I2C address, default is 0x40 when A0 and A1 both connected to DGND (see spec p22)
     uint8_t  _drdy_pin;   //! data ready pin (default is 0, meaning it's not used)
-    TwoWire* _wire;       //! the wire bus
+    uint8_t  _ready_mode; //! how conversion readiness is detected, see ADS1219_READY_*
+    int8_t   _drdy_slot;  //! slot in _drdy_devices when using the interrupt, -1 otherwise
+    volatile uint8_t _drdy_count; //! number of DRDY falling edges since the last start()
+    ADS1219TwoWireBus _wire_bus; //! backend for the TwoWire constructor, not bound to a TwoWire otherwise
+    ADS1219Bus* _bus;     //! the bus backend in use
     bool     _begun;      //! flag to indicate if the device has started
     
     uint8_t  _buffer[3];  //! buffer to recieve the ADC readout value
 
     unsigned long _timeout_ms; //! timeout in ms to wait for the ADC conversion result
 
-    size_t   _maxBufferSize;
-
     float    _aref_n;     //! analog negative reference in mV
     float    _aref_p;     //! analog positive reference in mV
+
+    uint8_t  _conv_state;      //! state of the asynchronous conversion, see ADS1219_STATE_*
+    uint8_t  _conv_mux;        //! multiplexer of the asynchronous conversion
+    unsigned long _conv_start_us;  //! micros() at the start of the asynchronous conversion
+    unsigned long _conv_end_us;    //! micros() at which the end of the last conversion was seen
+    unsigned long _conv_time_us;   //! expected conversion time
+    unsigned long _conv_poll_us;   //! time after the start at which the status register is checked next
+    unsigned long _conv_miss_us;   //! time after the start of the last status check which wasn't ready, 0 if none
+    uint8_t  _conv_rate;       //! datarate of the asynchronous conversion
+
+    bool     _adaptive;   //! schedule the status checks with the learned conversion times
+    uint32_t _learned[4]; //! learned single-shot conversion time per datarate in 1/16 µs, 0 if unknown
+
+    ADS1219RingBuffer<ADS1219_STREAM_BUFFER_SIZE> _stream; //! samples collected while streaming
+    bool     _streaming;  //! flag to indicate the device is streaming in continuous mode
+    ADS1219Filter* _stream_filter; //! filter chain for the streamed samples, nullptr if none
+    uint32_t _overruns;   //! samples lost while streaming
+    ADS1219Window* _windows[8]; //! window comparator per multiplexer setting (mux >> 5), nullptr if none
+    bool     _window_pass; //! the last sample is to be delivered, see ADS1219Window::check()
+
+#ifdef ADS1219_ENABLE_STATS
+    ADS1219Stats _stats;  //! bus instrumentation
+#endif
+
+    int64_t  _uv_scale;   //! µV per count, 32 fractional bits, for the current reference & gain
+    float    _mv_scale;   //! mV per count for the current reference & gain
+
+    uint8_t  _config;     //! shadow copy of the configuration register
+    bool     _config_valid; //! flag to indicate the shadow copy is in sync with the device
+    uint8_t  _config_written; //! last configuration written successfully, the one recover() replays
+    bool     _replay_pending; //! the last recover() failed, the device may not have _config_written
+    bool     _verify;     //! read back the configuration register after every write
+    bool     _repeated_start; //! repeated START between a read command and its response
+
+    uint8_t  _retries;      //! retries per transaction after a bus error
+    unsigned long _deadline_us; //! no retries after this time since the first error, 0 for no limit
+    bool     _auto_recover; //! recover() and try again when a transaction fails all its retries
+    ADS1219Recovery _recovery; //! error recovery counters
+
+    bool     _offset_correction; //! subtract the cached offset from the readouts
+    int32_t  _offset_q8[8];      //! cached offset per config bits 2-4 (data rate, gain), 8 fractional bits
+    uint8_t  _offset_valid;      //! bit per cache slot holding an offset
+    uint16_t _offset_every;      //! refresh every this many scans, 0 if not
+    uint16_t _offset_scans;      //! scans since the last refresh
+    unsigned long _offset_every_us; //! refresh after this time, 0 if not
+    unsigned long _offset_last_us;  //! micros() of the last refresh
+    uint8_t  _offset_shift;      //! weight of a refresh is 1 / 2^shift
+    uint8_t  _offset_turn;       //! alternates the gain of the refreshes
+    bool     _offset_due;        //! refresh on the next scan
+    uint32_t _offset_refreshes;  //! refresh conversions done
 };
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Wire.h>
+
+
+/**
+ * @brief I2C bus backend of the ADS1219 driver
+ *
+ * The driver only talks to the device through this interface, so it runs on any bus for which there is an
+ * implementation : ADS1219TwoWireBus for the Arduino Wire library (the default) and ADS1219LinuxI2C for
+ * /dev/i2c-N on Linux. All routines return one of the ADS1219_* error codes.
+ *
+ * A backend can also provide the DRDY line of the device, for platforms where it isn't an Arduino pin.
+ */
+class ADS1219Bus {
+public:
+    virtual ~ADS1219Bus() {}
+
+    /**
+     * @brief Prepare the bus, called from ADS1219::begin()
+     */
+    virtual uint8_t begin( void );
+
+    /**
+     * @brief Write bytes to the device
+     *
+     * @param addr 7 bit I2C address
+     * @param data bytes to write
+     * @param len number of bytes, 0 only checks whether the device acknowledges its address
+     * @param stop false to keep the bus for a repeated START
+     */
+    virtual uint8_t write( uint8_t addr, const uint8_t* data, size_t len, bool stop = true ) = 0;
+
+    /**
+     * @brief Read bytes from the device
+     */
+    virtual uint8_t read( uint8_t addr, uint8_t* data, size_t len, bool stop = true ) = 0;
+
+    /**
+     * @brief Write a command and read the response
+     *
+     * The default implementation is a write followed by a read. Backends which can combine both in one
+     * bus operation override it.
+     *
+     * @param repeated_start true to start the read with a repeated START instead of a STOP and a START
+     */
+    virtual uint8_t writeRead( uint8_t addr, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len,
+                               bool repeated_start = true );
+
+    /**
+     * @brief Maximum number of bytes in a single write or read
+     */
+    virtual size_t maxTransfer( void ) const = 0;
+
+    /**
+     * @brief Whether this backend provides the DRDY line of the device
+     */
+    virtual bool hasDrdy( void ) const { return false; }
+
+    /**
+     * @brief DRDY is asserted (low), only meaningful when hasDrdy()
+     */
+    virtual bool drdyReady( void ) { return false; }
+
+    /**
+     * @brief Wait for DRDY to be asserted
+     *
+     * The default implementation polls drdyReady() with yield() in between, backends with an event based
+     * DRDY (e.g. a GPIO interrupt) can sleep instead.
+     *
+     * @param timeout_us maximum time to wait in µs
+     *
+     * @return ADS1219_OK, or ADS1219_TIMEOUT
+     */
+    virtual uint8_t waitDrdy( unsigned long timeout_us );
+
+    /**
+     * @brief Free a bus on which a device holds SDA low, e.g. after a glitch in the middle of a read
+     *
+     * Called by the driver before retrying a failed transaction a second time and from ADS1219::recover().
+     * The default does nothing, e.g. Linux i2c-dev leaves the bus recovery to the kernel driver.
+     *
+     * @return true if a bus clear was done
+     */
+    virtual bool clear( void ) { return false; }
+};
+
+
+/**
+ * @brief ADS1219Bus on an Arduino TwoWire object
+ */
+class ADS1219TwoWireBus : public ADS1219Bus {
+public:
+    explicit ADS1219TwoWireBus( TwoWire* wire = &Wire ) : _wire(wire), _sda_pin(0xFF), _scl_pin(0xFF), _clock(100000) {}
+
+    uint8_t begin( void ) override;
+    uint8_t write( uint8_t addr, const uint8_t* data, size_t len, bool stop = true ) override;
+    uint8_t read( uint8_t addr, uint8_t* data, size_t len, bool stop = true ) override;
+    size_t  maxTransfer( void ) const override;
+    bool    clear( void ) override;
+
+    /**
+     * @brief Pins for clear(), and the bus clock to restore after it, see ADS1219::setBusClearPins()
+     */
+    void setClearPins( uint8_t sda_pin, uint8_t scl_pin, uint32_t clock = 100000 ) { _sda_pin = sda_pin; _scl_pin = scl_pin; _clock = clock; }
+
+    /**
+     * @brief The underlying TwoWire object
+     */
+    TwoWire* wire( void ) const { return _wire; }
+
+private:
+    TwoWire* _wire;     //! the wire bus
+    uint8_t  _sda_pin;  //! SDA pin for the bus clear, 0xFF if not set
+    uint8_t  _scl_pin;  //! SCL pin for the bus clear, 0xFF if not set
+    uint32_t _clock;    //! bus clock restored after the bus clear
+};
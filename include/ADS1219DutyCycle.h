@@ -0,0 +1,143 @@
+#pragma once
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+
+
+/**
+ * @brief Supply currents and noise of the device, for ADS1219DutyCycle
+ * 
+ * The defaults are rough typical figures for a 3.3 V supply and the internal reference, measure the 
+ * currents on the actual board and take the noise from the datasheet for the actual setup.
+ */
+struct ADS1219PowerModel {
+    float supply_v;         //! supply voltage
+    float converting_ua;    //! current while converting (analog and digital supply)
+    float idle_ua;          //! current while powered up but not converting
+    float powerdown_ua;     //! current in power-down mode
+    float noise_uv[4][2];   //! input referred noise in µV RMS per data rate, for gain 1 and gain 4
+
+    ADS1219PowerModel()
+        : supply_v(3.3f), converting_ua(415.f), idle_ua(250.f), powerdown_ua(0.5f)
+        , noise_uv{ { 1.0f, 0.45f }, { 2.1f, 0.95f }, { 4.0f, 1.8f }, { 7.1f, 3.2f } } {}
+
+    /**
+     * @brief Noise of one conversion in µV RMS
+     */
+    float noise( uint8_t rate, uint8_t gain ) const { return noise_uv[rate & 0x03][gain == ADS1219_GAIN_FOUR ? 1 : 0]; }
+};
+
+
+/**
+ * @brief Counters of an ADS1219DutyCycle, see ADS1219DutyCycle::stats()
+ */
+struct ADS1219DutyStats {
+    uint32_t bursts;            //! bursts run
+    uint32_t samples;           //! results delivered
+    uint64_t on_us;             //! time from the wake up to the power down, over all bursts
+    uint64_t off_us;            //! time powered down between bursts
+    uint64_t converting_us;     //! estimated time converting, from the conversion times of the plan
+    float    duty;              //! fraction of the time powered up
+    float    energy_uj;         //! estimated energy of the device, from the power model
+    float    energy_per_sample_uj; //! energy_uj / samples
+    float    average_ua;        //! average current of the device
+};
+
+
+/**
+ * @brief Duty cycled acquisition for battery powered nodes
+ * 
+ * Every period, the device wakes up with the START of the first conversion, runs the scan plan (a burst), 
+ * and is powered down straight after it, so the analog front end only draws current while it's needed. 
+ * Call run() from the main loop, between bursts the application can sleep until nextBurst().
+ * 
+ * setNoise() picks the data rate and the number of conversions averaged per entry which reach a noise 
+ * level with the shortest time awake, from the noise figures of the power model. The on and off times 
+ * are measured, the energy per sample is estimated with the currents of the model.
+ */
+class ADS1219DutyCycle {
+public:
+    ADS1219DutyCycle( ADS1219& adc, ADS1219ScanPlan& plan );
+
+    void setModel( const ADS1219PowerModel& model ) { _model = model; }
+    const ADS1219PowerModel& model( void ) const { return _model; }
+
+    /**
+     * @brief Time awake for a burst of one conversion averaged over samples, from the conversion times
+     */
+    static unsigned long burstTime( uint8_t rate, uint16_t samples );
+
+    /**
+     * @brief Pick the data rate and number of samples which reach a noise level in the shortest time
+     * 
+     * The noise of n averaged conversions is that of one conversion / sqrt(n). 
+     * 
+     * @param noise_uv noise level in µV RMS
+     * @param gain gain for the noise figures
+     * @param rate receives the data rate
+     * @param samples receives the number of conversions to average, at most max_samples
+     * 
+     * @return true if the noise level can be reached
+     */
+    bool bestRate( float noise_uv, uint8_t gain, uint8_t* rate, uint16_t* samples, uint16_t max_samples = 1024 ) const;
+
+    /**
+     * @brief Configure the device and the plan for a noise level, see bestRate()
+     * 
+     * Sets the data rate of the device, and the gain and number of samples of every plan entry, so the 
+     * noise figures hold : the gain replaces the gain settings of the entries, auto-ranging included.
+     * 
+     * @param gain ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+     * 
+     * @return error code, ADS1219_INVALID_GAIN for another gain, ADS1219_INVALID_DATARATE if the level 
+     * can't be reached
+     */
+    uint8_t setNoise( float noise_uv, uint8_t gain = ADS1219_GAIN_ONE );
+
+    /**
+     * @brief Start the bursts, the first one is due straight away, also clears the statistics
+     * 
+     * Powers the device down until then.
+     * 
+     * @param period_us time between the start of consecutive bursts
+     */
+    uint8_t begin( unsigned long period_us );
+
+    /**
+     * @brief Run the burst when it's due
+     * 
+     * @param results receives the results of the plan, see ADS1219::scan()
+     * @param err_codes optionally receives the error code per entry
+     * 
+     * @return true if a burst was run. false while a conversion or stream started by the application keeps 
+     * the driver busy (lastError() is ADS1219_BUSY), the burst is then run on a later call
+     */
+    bool run( int32_t* results, uint8_t* err_codes = nullptr );
+
+    /**
+     * @brief micros() at which the next burst is due
+     */
+    unsigned long nextBurst( void ) const { return _next_us; }
+
+    /**
+     * @brief Error code of the last burst, the scan or the power down
+     */
+    uint8_t lastError( void ) const { return _error; }
+
+    void stats( ADS1219DutyStats* s ) const;
+    void resetStats( void );
+
+private:
+    unsigned long _converting( void );
+
+    ADS1219&          _adc;
+    ADS1219ScanPlan&  _plan;
+    ADS1219PowerModel _model;
+    unsigned long     _period_us;
+    unsigned long     _next_us;
+    unsigned long     _down_us;   //! micros() of the last power down
+    uint8_t           _error;
+
+    uint32_t          _bursts, _samples;
+    uint64_t          _on_us, _off_us, _converting_us;
+};
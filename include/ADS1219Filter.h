@@ -0,0 +1,213 @@
+#pragma once
+
+#include <stdint.h>
+
+
+// Integer log2 of a power of two, for the compile time filter parameters
+constexpr uint8_t ads1219_log2( uint32_t n ) { return n <= 1 ? 0 : 1 + ads1219_log2( n >> 1 ); }
+
+// Arithmetic right shift, rounded to the nearest integer (halves up) without an overflowing rounding constant
+inline int32_t ads1219_shift_round( int32_t value, uint8_t shift )
+{
+    return shift == 0 ? value : ( ( value >> ( shift - 1 ) ) + 1 ) >> 1;
+}
+
+
+/**
+ * @brief Base class of the streaming filters on raw ADC counts
+ *
+ * Filters work on the 24 bit counts in 32 bit integer arithmetic, without allocation and without floating
+ * point. They can be chained with then() : a.then(b).then(c) feeds the output of a into b and of b into c,
+ * filter() on the first one runs the whole chain. A chain can be attached to a scan plan entry
+ * (ADS1219ScanPlan::add) or to the stream (ADS1219::startStream), or be used on its own.
+ *
+ * Decimating filters don't produce an output for every input, filter() returns false in that case.
+ */
+class ADS1219Filter {
+public:
+    ADS1219Filter() : _next(nullptr), _last(static_cast<int32_t>(0x80000000)) {}
+    virtual ~ADS1219Filter() {}
+
+    /**
+     * @brief Append a filter to this one
+     *
+     * @param next filter which gets the output of this one
+     *
+     * @return the appended filter, to continue the chain
+     */
+    ADS1219Filter& then( ADS1219Filter& next ) { _next = &next; return next; }
+
+    /**
+     * @brief Run a sample through the chain starting at this filter
+     *
+     * @param in raw ADC count
+     * @param out receives the output of the last filter in the chain
+     *
+     * @return true if the chain produced an output, false if a decimating filter holds it back
+     */
+    bool filter( int32_t in, int32_t* out );
+
+    /**
+     * @brief Last output of the chain, 0x80000000 if there is none yet
+     */
+    int32_t last( void ) const { return _last; }
+
+    /**
+     * @brief Clear the state of all filters in the chain, the next sample starts afresh
+     */
+    void reset( void );
+
+    /**
+     * @brief true if a filter in the chain starting at this one decimates
+     */
+    bool decimating( void ) const;
+
+protected:
+    virtual bool _process( int32_t in, int32_t* out ) = 0;
+    virtual void _reset( void ) = 0;
+    virtual bool _decimates( void ) const { return false; }
+
+private:
+    ADS1219Filter* _next;  //! next filter in the chain, nullptr for the last one
+    int32_t        _last;  //! last output of the chain
+};
+
+
+/**
+ * @brief Boxcar moving average over the last N samples
+ *
+ * A running sum makes the update O(1) for any N : add the new sample, subtract the one leaving the window,
+ * divide by a shift. The window is filled with the first sample, so there is an output from the start.
+ *
+ * @tparam N window length, a power of two up to 128 so the sum of 24 bit counts fits in 32 bits
+ */
+template <uint8_t N>
+class ADS1219MovingAverage : public ADS1219Filter {
+    static_assert( N > 0 && N <= 128 && ( N & ( N - 1 ) ) == 0, "ADS1219MovingAverage length must be a power of two <= 128" );
+
+public:
+    ADS1219MovingAverage() { _reset(); }
+
+protected:
+    bool _process( int32_t in, int32_t* out ) override
+    {
+        if ( ! _primed ) {
+            for ( uint8_t i = 0; i < N; i++ ) _window[i] = in;
+            _sum    = in * static_cast<int32_t>( N );
+            _primed = true;
+        } else {
+            _sum += in - _window[_pos];
+            _window[_pos] = in;
+            _pos = ( _pos + 1 ) & ( N - 1 );
+        }
+        *out = ads1219_shift_round( _sum, ads1219_log2( N ) );
+        return true;
+    }
+
+    void _reset( void ) override { _sum = 0; _pos = 0; _primed = false; }
+
+private:
+    int32_t _window[N];  //! last N samples
+    int32_t _sum;        //! sum of the window
+    uint8_t _pos;        //! oldest sample in the window
+    bool    _primed;     //! the window holds samples
+};
+
+
+/**
+ * @brief Single pole low pass, y += ( x - y ) / 2^Shift
+ *
+ * The state keeps Shift fractional bits, so small steps aren't lost to truncation and a constant input
+ * comes out exactly. The time constant is about 2^Shift samples. The state starts at the first sample.
+ *
+ * @tparam Shift coefficient as a power of two, 1 to 8 so the scaled 24 bit state fits in 32 bits
+ */
+template <uint8_t Shift>
+class ADS1219IIR : public ADS1219Filter {
+    static_assert( Shift >= 1 && Shift <= 8, "ADS1219IIR shift must be 1 to 8" );
+
+public:
+    ADS1219IIR() { _reset(); }
+
+protected:
+    bool _process( int32_t in, int32_t* out ) override
+    {
+        if ( ! _primed ) {
+            _state  = in * ( static_cast<int32_t>(1) << Shift );
+            _primed = true;
+        } else {
+            _state += in - ads1219_shift_round( _state, Shift );
+        }
+        *out = ads1219_shift_round( _state, Shift );
+        return true;
+    }
+
+    void _reset( void ) override { _state = 0; _primed = false; }
+
+private:
+    int32_t _state;   //! output with Shift fractional bits
+    bool    _primed;  //! the state holds a sample
+};
+
+
+/**
+ * @brief Cascaded integrator-comb decimator
+ *
+ * Order integrators run at the input rate and Order combs at the output rate, one output per Decimation
+ * inputs. That's the response of Order cascaded moving averages of Decimation samples, for only Order
+ * additions per input. The registers wrap around modulo 2^32, which is harmless as long as the output fits,
+ * hence the limit on the bit growth. The output is scaled back to counts. The first Order - 1 outputs,
+ * which only see part of the input, are held back.
+ *
+ * @tparam Order number of integrator and comb stages, 1 to 4
+ * @tparam Decimation input samples per output sample, a power of two from 2 to 128
+ */
+template <uint8_t Order, uint8_t Decimation>
+class ADS1219CIC : public ADS1219Filter {
+    static_assert( Order >= 1 && Order <= 4, "ADS1219CIC order must be 1 to 4" );
+    static_assert( Decimation >= 2 && Decimation <= 128 && ( Decimation & ( Decimation - 1 ) ) == 0,
+                   "ADS1219CIC decimation must be a power of two from 2 to 128" );
+    static_assert( Order * ads1219_log2( Decimation ) <= 8, "ADS1219CIC bit growth must be at most 8 bits" );
+
+public:
+    ADS1219CIC() { _reset(); }
+
+protected:
+    bool _process( int32_t in, int32_t* out ) override
+    {
+        uint32_t v = static_cast<uint32_t>( in );
+        for ( uint8_t k = 0; k < Order; k++ ) {
+            _integrator[k] += v;
+            v = _integrator[k];
+        }
+        if ( ++_count < Decimation ) return false;
+        _count = 0;
+
+        for ( uint8_t k = 0; k < Order; k++ ) {
+            uint32_t d = v - _comb[k];
+            _comb[k] = v;
+            v = d;
+        }
+        if ( _warmup > 0 ) {
+            _warmup--;
+            return false;
+        }
+        *out = ads1219_shift_round( static_cast<int32_t>( v ), Order * ads1219_log2( Decimation ) );
+        return true;
+    }
+
+    bool _decimates( void ) const override { return true; }
+
+    void _reset( void ) override
+    {
+        for ( uint8_t k = 0; k < Order; k++ ) _integrator[k] = _comb[k] = 0;
+        _count  = 0;
+        _warmup = Order - 1;
+    }
+
+private:
+    uint32_t _integrator[Order];  //! integrator stages, at the input rate
+    uint32_t _comb[Order];        //! previous input of each comb stage, at the output rate
+    uint8_t  _count;              //! inputs since the last output
+    uint8_t  _warmup;             //! outputs still to be held back
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "ADS1219.h"
+
+// Maximum number of devices in a group, the A0/A1 pins give 4 addresses per bus
+#define ADS1219_GROUP_MAX_DEVICES 4
+
+
+/**
+ * @brief Runs conversions on several ADS1219 devices sharing one I2C bus in parallel
+ * 
+ * Instead of converting one device after the other, the group issues the START to all devices back to back 
+ * and then collects the results as each device finishes. The conversions overlap, so a full group readout
+ * takes roughly one conversion time instead of one per device. The devices are owned by the caller and 
+ * should have been started with begin().
+ */
+class ADS1219Group {
+public:
+    ADS1219Group();
+
+    /**
+     * @brief Add a device to the group
+     * 
+     * @param adc pointer to the device
+     * 
+     * @return error code, ADS1219_GROUP_FULL if the group already has ADS1219_GROUP_MAX_DEVICES devices
+     */
+    uint8_t add( ADS1219* adc );
+
+    /**
+     * @brief Number of devices in the group
+     */
+    uint8_t size( void ) const { return _size; }
+
+    /**
+     * @brief Device at position i
+     */
+    ADS1219* device( uint8_t i ) { return _devices[i]; }
+
+    /**
+     * @brief Convert the same multiplexer setting on all devices in parallel
+     * 
+     * @param mux the multiplexer setting, one of the ADS1219_MUX_* values
+     * @param results array with room for size() values, receives the raw ADC counts in the order the 
+     *        devices were added
+     * @param err_codes optional array with room for size() error codes
+     * 
+     * @return error code, the first error encountered
+     */
+    uint8_t convert( uint8_t mux, int32_t* results, uint8_t* err_codes = nullptr );
+
+    /**
+     * @brief Convert a different multiplexer setting on every device in parallel
+     * 
+     * @param muxes array with size() multiplexer settings, one per device
+     * @param results array with room for size() values
+     * @param err_codes optional array with room for size() error codes
+     * 
+     * @return error code, the first error encountered
+     */
+    uint8_t convert( const uint8_t* muxes, int32_t* results, uint8_t* err_codes = nullptr );
+
+    /**
+     * @brief Duration of the last convert() in µs
+     */
+    unsigned long duration( void ) const { return _duration_us; }
+
+    /**
+     * @brief Aggregate throughput of the last convert() in samples per second, over all devices
+     */
+    float throughput( void ) const;
+
+private:
+    ADS1219*      _devices[ADS1219_GROUP_MAX_DEVICES];
+    uint8_t       _size;
+
+    unsigned long _duration_us;  //! duration of the last convert
+    uint8_t       _samples;      //! number of valid samples in the last convert
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include "ADS1219Bus.h"
+
+struct i2c_msg;
+
+
+/**
+ * @brief ADS1219Bus on a Linux I2C adapter (/dev/i2c-N, i2c-dev)
+ *
+ * Every write and read is an I2C_RDWR ioctl, a command with its response (ADS1219Bus::writeRead) is one
+ * ioctl with two messages, which the kernel puts on the bus with a repeated START in between. The ioctl
+ * function can be replaced, e.g. by an in-process fake device for testing without hardware.
+ *
+ * The driver itself still uses the Arduino API for its timing (micros, delay, yield), on Linux that comes
+ * from lib/ArduinoNative with ArduinoNative::setRealTime(true), see examples/linux_i2c for the build.
+ */
+class ADS1219LinuxI2C : public ADS1219Bus {
+public:
+    //! signature of ioctl(2)
+    typedef int (*IoctlFunction)( int fd, unsigned long request, void* arg );
+
+    /**
+     * @brief Constructor
+     *
+     * @param device path of the I2C adapter, e.g. "/dev/i2c-1"
+     * @param ioctl_fn replacement for ioctl(2), nullptr (default) for the real one
+     */
+    explicit ADS1219LinuxI2C( const char* device, IoctlFunction ioctl_fn = nullptr );
+    ~ADS1219LinuxI2C();
+
+    /**
+     * @brief Open the device node
+     *
+     * @return ADS1219_OK, or ADS1219_FAILED_TO_END if it can't be opened
+     */
+    uint8_t begin( void ) override;
+
+    /**
+     * @brief Close the device node
+     */
+    void end( void );
+
+    uint8_t write( uint8_t addr, const uint8_t* data, size_t len, bool stop = true ) override;
+    uint8_t read( uint8_t addr, uint8_t* data, size_t len, bool stop = true ) override;
+    uint8_t writeRead( uint8_t addr, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len,
+                       bool repeated_start = true ) override;
+    size_t  maxTransfer( void ) const override { return 8192; }
+
+    /**
+     * @brief Number of ioctl calls so far
+     */
+    uint32_t transfers( void ) const { return _transfers; }
+
+    /**
+     * @brief errno of the last failed ioctl, 0 if none failed
+     */
+    int lastError( void ) const { return _errno; }
+
+private:
+    uint8_t _transfer( struct i2c_msg* msgs, uint32_t n );
+
+    const char*   _device;     //! path of the device node
+    int           _fd;         //! file descriptor of the device node, -1 if closed
+    IoctlFunction _ioctl;      //! ioctl(2) or a replacement
+    uint32_t      _transfers;  //! number of ioctl calls
+    int           _errno;      //! errno of the last failed ioctl
+};
+
+#endif
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "ADS1219.h"
+#include "ADS1219Record.h"
+
+// Packet types
+#define ADS1219_PACKET_RECORD      0x01  // the payload is one ADS1219Record frame
+
+// Largest packet before framing : type, 16 bit sequence number, payload and CRC
+#define ADS1219_PACKET_MAX         ( 3 + ADS1219_RECORD_MAX_FRAME + 2 )
+
+// Largest packet on the wire : COBS adds a byte per 254 and the 0x00 delimiter follows
+#define ADS1219_PACKET_MAX_ENCODED ( ADS1219_PACKET_MAX + ADS1219_PACKET_MAX / 254 + 2 )
+
+// Number of continuous conversions packed into one packet by ADS1219PacketStream
+#ifndef ADS1219_PACKET_SAMPLES
+#define ADS1219_PACKET_SAMPLES     ADS1219_RECORD_MAX_SAMPLES
+#endif
+
+
+/**
+ * @brief CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF), "123456789" gives 0x29B1
+ */
+uint16_t ads1219_crc16( const uint8_t* data, size_t len, uint16_t crc = 0xFFFF );
+
+/**
+ * @brief Consistent overhead byte stuffing : removes all 0x00 bytes, so 0x00 can delimit the packets
+ *
+ * @param out room for len + len / 254 + 1 bytes
+ *
+ * @return number of bytes written, without a delimiter
+ */
+size_t ads1219_cobs_encode( const uint8_t* in, size_t len, uint8_t* out );
+
+/**
+ * @brief Undo ads1219_cobs_encode(), in and out may be the same buffer
+ *
+ * @param len length without the delimiter
+ *
+ * @return number of bytes written, 0 for invalid input (a 0x00 byte or a code past the end)
+ */
+size_t ads1219_cobs_decode( const uint8_t* in, size_t len, uint8_t* out );
+
+
+/**
+ * @brief Sends packets over a serial link (or anything else with the Print interface)
+ *
+ * A packet is the type byte, a 16 bit sequence number (little endian) that increments with every packet,
+ * the payload and the CRC-16 of all that (big endian), COBS encoded and followed by a 0x00 delimiter. A
+ * receiver finds the start of the next packet after any corruption and sees lost packets in the sequence.
+ */
+class ADS1219PacketWriter {
+public:
+    explicit ADS1219PacketWriter( Print& out ) : _out(out), _seq(0) {}
+
+    /**
+     * @brief Send a packet
+     *
+     * @param payload at most ADS1219_RECORD_MAX_FRAME bytes
+     *
+     * @return number of bytes written to the output, 0 if the payload is too large
+     */
+    size_t send( uint8_t type, const uint8_t* payload, size_t len );
+
+    /**
+     * @brief Sequence number of the next packet
+     */
+    uint16_t sequence( void ) const { return _seq; }
+
+private:
+    Print&   _out;
+    uint16_t _seq;
+};
+
+
+/**
+ * @brief Reassembles packets from a byte stream, see ADS1219PacketWriter
+ */
+class ADS1219PacketReader {
+public:
+    ADS1219PacketReader();
+
+    /**
+     * @brief Feed one received byte
+     *
+     * @return true if it completed a good packet, available with type(), payload(), length() and sequence()
+     * until the next call
+     */
+    bool push( uint8_t c );
+
+    uint8_t        type( void ) const { return _buf[0]; }
+    uint16_t       sequence( void ) const { return _seq; }
+    const uint8_t* payload( void ) const { return _buf + 3; }
+    size_t         length( void ) const { return _len; }
+
+    uint32_t packets( void ) const { return _packets; }            //! good packets
+    uint32_t crcErrors( void ) const { return _crc_errors; }       //! packets with a CRC mismatch
+    uint32_t framingErrors( void ) const { return _framing_errors; } //! overlong, short or invalid COBS packets
+    uint32_t dropped( void ) const { return _dropped; }            //! packets missing in the sequence
+
+    /**
+     * @brief The last good packet came after a gap in the sequence
+     */
+    bool gap( void ) const { return _gap; }
+
+private:
+    uint8_t  _buf[ADS1219_PACKET_MAX_ENCODED];
+    size_t   _pos;          //! bytes received since the last delimiter
+    bool     _overflow;     //! the current packet is too long, skip it
+    size_t   _len;          //! payload length of the last good packet
+    uint16_t _seq;          //! sequence number of the last good packet
+    bool     _have_seq;
+    bool     _gap;
+    uint32_t _packets, _crc_errors, _framing_errors, _dropped;
+};
+
+
+/**
+ * @brief One sample taken apart by ADS1219PacketDecoder
+ */
+struct ADS1219PacketSample {
+    uint64_t time_us;   //! micros() on the device, unwrapped to 64 bit
+    uint16_t seq;       //! sequence number of the packet
+    uint8_t  mux;       //! multiplexer setting
+    uint8_t  gain;      //! ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+    uint8_t  rate;      //! data rate
+    int32_t  value;     //! raw count
+};
+
+
+/**
+ * @brief Turns a received byte stream back into samples, e.g. on the host
+ *
+ * Runs the bytes through an ADS1219PacketReader and the record frames through an ADS1219RecordDecoder.
+ * After a lost packet the record decoder waits for the next keyframe. Repeated samples of the same
+ * multiplexer setting in a frame are consecutive continuous conversions : the n-th one is timestamped n
+ * conversion periods after the frame. Missing (invalid) samples are left out.
+ */
+class ADS1219PacketDecoder {
+public:
+    typedef void (*SampleFunction)( const ADS1219PacketSample& sample, void* context );
+
+    /**
+     * @param fn called for every sample
+     * @param context passed on to fn
+     */
+    ADS1219PacketDecoder( SampleFunction fn, void* context = nullptr );
+
+    /**
+     * @brief Feed received bytes
+     */
+    void push( const uint8_t* data, size_t len );
+
+    const ADS1219PacketReader& reader( void ) const { return _reader; }
+
+    uint64_t samples( void ) const { return _samples; }          //! samples passed on
+    uint32_t frames( void ) const { return _frames; }            //! record frames decoded
+    uint32_t skippedFrames( void ) const { return _skipped; }    //! frames skipped while waiting for a keyframe
+    uint32_t badFrames( void ) const { return _bad; }            //! packets with a good CRC but a bad frame
+
+private:
+    void _frame( void );
+
+    ADS1219PacketReader  _reader;
+    ADS1219RecordDecoder _decoder;
+    SampleFunction       _fn;
+    void*                _context;
+    uint64_t             _samples;
+    uint32_t             _frames, _skipped, _bad;
+};
+
+
+/**
+ * @brief Streams continuous conversions as packets, e.g. 1000 SPS over USB serial
+ *
+ * Runs the driver in streaming mode (ADS1219::startStream) and packs every ADS1219_PACKET_SAMPLES samples
+ * from its ring buffer into a record frame, sent with an ADS1219PacketWriter. The frame timestamp is that
+ * of the first sample, estimated from the time of packing and the conversion period, and the decoder
+ * spaces the samples a conversion period apart : the stream has to deliver every conversion, so decimating
+ * filters and windows which suppress samples are refused. Call service() from the main loop at least once
+ * per ADS1219_STREAM_BUFFER_SIZE conversions.
+ */
+class ADS1219PacketStream {
+public:
+    /**
+     * @param delta delta+zigzag+varint samples (a keyframe every 16 packets), false for 24 bit samples
+     */
+    ADS1219PacketStream( ADS1219& adc, Print& out, bool delta = true );
+
+    /**
+     * @brief Start the stream
+     *
+     * @param filter filter chain on the samples, it mustn't decimate
+     *
+     * @return error code of ADS1219::startStream(), ADS1219_STREAM_IRREGULAR for a decimating filter or a
+     * window with suppression attached to mux (don't turn it on while the stream runs)
+     */
+    uint8_t begin( uint8_t mux, uint8_t rate, ADS1219Filter* filter = nullptr );
+
+    /**
+     * @brief Read conversions from the device and send full packets
+     *
+     * @return error code of ADS1219::serviceStream()
+     */
+    uint8_t service( void );
+
+    /**
+     * @brief Send the samples left over and stop the stream
+     */
+    uint8_t end( void );
+
+    ADS1219PacketWriter& writer( void ) { return _writer; }
+
+    uint32_t packets( void ) const { return _packets; }  //! packets sent
+    uint32_t bytes( void ) const { return _bytes; }      //! bytes sent
+
+private:
+    void _send( size_t n );
+
+    ADS1219&             _adc;
+    ADS1219PacketWriter  _writer;
+    ADS1219RecordEncoder _encoder;
+    uint8_t              _mux;
+    uint8_t              _gain;
+    uint8_t              _rate;
+    uint32_t             _packets;
+    uint32_t             _bytes;
+};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "ADS1219.h"
+
+// Maximum number of samples in one record frame (4 bit count in the frame header)
+#define ADS1219_RECORD_MAX_SAMPLES 15
+
+// Maximum size of an encoded frame in bytes : header, 32 bit timestamp varint, layout, invalid mask and
+// 4 byte varint deltas
+#define ADS1219_RECORD_MAX_FRAME   ( 1 + 5 + 1 + ADS1219_RECORD_MAX_SAMPLES + 2 + 4 * ADS1219_RECORD_MAX_SAMPLES )
+
+// Frame header bits, the low nibble is the number of samples
+#define ADS1219_RECORD_LAYOUT      0x10  // keyframe : the layout follows and the timestamp is absolute
+#define ADS1219_RECORD_DELTA       0x20  // samples are zigzag varint deltas instead of 24 bit values
+#define ADS1219_RECORD_MASK        0x40  // an invalid sample mask follows
+#define ADS1219_RECORD_RESERVED    0x80  // must be 0
+
+class ADS1219ScanPlan;
+
+
+// Unsigned LEB128 varint : 7 bits per byte, least significant first, high bit set on all but the last byte
+inline uint8_t ads1219_put_varint( uint8_t* buf, uint32_t value )
+{
+    uint8_t n = 0;
+    while ( value >= 0x80 ) {
+        buf[n++] = static_cast<uint8_t>( value | 0x80 );
+        value >>= 7;
+    }
+    buf[n++] = static_cast<uint8_t>( value );
+    return n;
+}
+
+// Signed to unsigned with the sign in bit 0, so small magnitudes of either sign give short varints
+inline uint32_t ads1219_zigzag( int32_t value )
+{
+    return ( static_cast<uint32_t>( value ) << 1 ) ^ static_cast<uint32_t>( value >> 31 );
+}
+
+inline int32_t ads1219_unzigzag( uint32_t value )
+{
+    return static_cast<int32_t>( value >> 1 ) ^ -static_cast<int32_t>( value & 1 );
+}
+
+
+/**
+ * @brief One decoded record frame
+ */
+struct ADS1219RecordFrame {
+    uint64_t timestamp_us;  //! micros() of the frame, unwrapped to 64 bit
+    bool     keyframe;      //! the frame carried the layout and an absolute timestamp
+    uint8_t  rate;          //! data rate, one of the ADS1219_DATARATE_* values
+    uint8_t  size;          //! number of samples
+    uint8_t  mux[ADS1219_RECORD_MAX_SAMPLES];    //! multiplexer setting per sample
+    uint8_t  gain[ADS1219_RECORD_MAX_SAMPLES];   //! ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR per sample
+    int32_t  value[ADS1219_RECORD_MAX_SAMPLES];  //! raw counts, 0x80000000 for an invalid sample
+};
+
+
+/**
+ * @brief Packs scans into compact binary frames for logging and uplink
+ *
+ * A frame holds up to 15 samples (e.g. one scan) :
+ *
+ * - header byte : sample count in bits 0-3, ADS1219_RECORD_LAYOUT, ADS1219_RECORD_DELTA, ADS1219_RECORD_MASK
+ * - timestamp : varint, micros() on a keyframe, else the µs since the previous frame
+ * - keyframes only, the layout : the data rate byte, then per sample mux id (mux >> 5) in bits 5-7 and the
+ *   gain in bit 4 (set for gain 4)
+ * - with ADS1219_RECORD_MASK : invalid samples as a bit mask, one byte per 8 samples, those aren't stored
+ * - the samples : 24 bit big endian two's complement as read from the device, or in delta mode the zigzag
+ *   varint of the difference with the previous value in the same position (0 on a keyframe)
+ *
+ * The layout is only sent when it changes and every keyframe interval, so a decoder given the frame
+ * boundaries can start on any keyframe or pick up again there after a lost frame. Frames don't carry their
+ * length : to send them over a byte stream, frame them, e.g. with ADS1219PacketWriter. A 5 channel scan
+ * takes 19 bytes in the plain 24 bit mode and 10 to 14 in delta mode on a slowly varying signal with a
+ * little noise, against ~85 bytes as a line of text.
+ */
+class ADS1219RecordEncoder {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param delta true for delta+zigzag+varint samples
+     * @param keyframe_interval send a keyframe at least every this many frames, 0 only when the layout changes
+     */
+    explicit ADS1219RecordEncoder( bool delta = false, uint16_t keyframe_interval = 32 );
+
+    void setDelta( bool delta ) { _delta = delta; }
+    void setKeyframeInterval( uint16_t frames ) { _keyframe_interval = frames; }
+
+    /**
+     * @brief Start afresh, the next frame is a keyframe
+     */
+    void reset( void );
+
+    /**
+     * @brief Start a frame
+     *
+     * @param timestamp_us micros() of the frame, e.g. the start of the scan
+     * @param rate data rate of the samples
+     */
+    void beginFrame( unsigned long timestamp_us, uint8_t rate );
+
+    /**
+     * @brief Add a sample to the frame
+     *
+     * @param mux multiplexer setting
+     * @param gain ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+     * @param value raw count, 0x80000000 for a missing sample (e.g. a bus error)
+     *
+     * @return error code, ADS1219_RECORD_FULL if the frame has 15 samples, ADS1219_RECORD_INVALID if the
+     * value doesn't fit in 24 bits
+     */
+    uint8_t add( uint8_t mux, uint8_t gain, int32_t value );
+
+    /**
+     * @brief Encode the frame
+     *
+     * @param buf room for ADS1219_RECORD_MAX_FRAME bytes
+     *
+     * @return number of bytes written, 0 if buf is smaller than ADS1219_RECORD_MAX_FRAME or the frame is empty
+     */
+    size_t endFrame( uint8_t* buf, size_t size );
+
+    /**
+     * @brief Encode the results of ADS1219::scan() as one frame
+     *
+     * @param gain gain of the entries with ADS1219_GAIN_KEEP, auto-ranged entries take the gain of the plan's 
+     * last scan (ADS1219ScanPlan::gain())
+     *
+     * @return number of bytes written, 0 on error
+     */
+    size_t encodeScan( const ADS1219ScanPlan& plan, const int32_t* results, unsigned long timestamp_us,
+                       uint8_t rate, uint8_t gain, uint8_t* buf, size_t size );
+
+private:
+    bool     _delta;                //! delta+zigzag+varint samples
+    uint16_t _keyframe_interval;    //! maximum number of frames between keyframes, 0 for no limit
+    uint16_t _since_keyframe;       //! frames since the last keyframe
+    bool     _have_layout;          //! a keyframe was sent since reset()
+    unsigned long _last_us;         //! timestamp of the previous frame
+
+    // the frame being built
+    unsigned long _frame_us;
+    uint8_t  _rate;
+    uint8_t  _size;
+    uint8_t  _layout[ADS1219_RECORD_MAX_SAMPLES];
+    int32_t  _value[ADS1219_RECORD_MAX_SAMPLES];
+
+    // the layout of the last keyframe and the previous value per position
+    uint8_t  _last_rate;
+    uint8_t  _last_size;
+    uint8_t  _last_layout[ADS1219_RECORD_MAX_SAMPLES];
+    int32_t  _prev[ADS1219_RECORD_MAX_SAMPLES];
+};
+
+
+/**
+ * @brief Decodes frames written by ADS1219RecordEncoder, on the device or on a host
+ */
+class ADS1219RecordDecoder {
+public:
+    ADS1219RecordDecoder();
+
+    /**
+     * @brief Forget the layout, the next frame must be a keyframe
+     */
+    void reset( void );
+
+    /**
+     * @brief Decode one frame from the start of data
+     *
+     * @param err ADS1219_OK, ADS1219_RECORD_TRUNCATED if data holds less than a frame, ADS1219_RECORD_INVALID
+     * for a malformed frame, ADS1219_RECORD_NO_LAYOUT for a frame before the first keyframe (skipped)
+     *
+     * @return number of bytes used, also for a skipped frame, 0 on the other errors
+     */
+    size_t decode( const uint8_t* data, size_t len, ADS1219RecordFrame* frame, uint8_t* err );
+
+private:
+    bool     _have_layout;
+    uint64_t _time_us;
+    uint8_t  _rate;
+    uint8_t  _size;
+    uint8_t  _layout[ADS1219_RECORD_MAX_SAMPLES];
+    int32_t  _prev[ADS1219_RECORD_MAX_SAMPLES];
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Fixed capacity single producer, single consumer ring buffer for conversion results
+ * 
+ * No allocation and no locking : the producer only writes the head index and the consumer only writes the
+ * tail index. The indices are single bytes, so they are updated atomically on 8 bit architectures as well,
+ * which makes it safe to push from an interrupt routine while popping from the main loop. 
+ * 
+ * @tparam N capacity, must be a power of two and at most 128
+ */
+template <uint8_t N>
+class ADS1219RingBuffer {
+    static_assert( N > 0 && N <= 128 && ( N & ( N - 1 ) ) == 0, "ADS1219RingBuffer capacity must be a power of two <= 128" );
+
+public:
+    ADS1219RingBuffer() : _head(0), _tail(0) {}
+
+    /**
+     * @brief Add a value, producer side
+     * 
+     * @return false if the buffer is full, the value is dropped in that case
+     */
+    bool push( int32_t value )
+    {
+        uint8_t head = _head;
+        if ( static_cast<uint8_t>( head - _tail ) >= N ) return false;
+        _data[head & ( N - 1 )] = value;
+        _head = head + 1;  // publish only after the value is stored
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest value, consumer side
+     * 
+     * @return false if the buffer is empty
+     */
+    bool pop( int32_t* value )
+    {
+        uint8_t tail = _tail;
+        if ( tail == _head ) return false;
+        *value = _data[tail & ( N - 1 )];
+        _tail = tail + 1;
+        return true;
+    }
+
+    /**
+     * @brief Number of values in the buffer
+     */
+    uint8_t size( void ) const { return static_cast<uint8_t>( _head - _tail ); }
+
+    /**
+     * @brief Capacity of the buffer
+     */
+    uint8_t capacity( void ) const { return N; }
+
+    /**
+     * @brief Drop all values, only call when neither side is active
+     */
+    void clear( void ) { _head = 0; _tail = 0; }
+
+private:
+    int32_t          _data[N];
+    volatile uint8_t _head;   //! next write position, free running
+    volatile uint8_t _tail;   //! next read position, free running
+};
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "ADS1219.h"
+#include "ADS1219Filter.h"
+
+// Maximum number of entries in a scan plan
+#ifndef ADS1219_SCAN_MAX_ENTRIES
+#define ADS1219_SCAN_MAX_ENTRIES 8
+#endif
+
+// Gain setting for a scan entry which keeps whatever gain the device has
+#define ADS1219_GAIN_KEEP        0
+
+// Gain setting for a scan entry which picks gain 1 or 4 from its last result, see ads1219_autorange()
+#define ADS1219_GAIN_AUTO        2
+
+// Auto-ranging thresholds in percent of full scale : up to gain 4 below the first one at gain 1, back down 
+// to gain 1 above the second one at gain 4. The band in between is the hysteresis.
+#ifndef ADS1219_AUTORANGE_UP
+#define ADS1219_AUTORANGE_UP     20
+#endif
+#ifndef ADS1219_AUTORANGE_DOWN
+#define ADS1219_AUTORANGE_DOWN   90
+#endif
+
+
+/**
+ * @brief Gain for the next conversion of an auto-ranged channel
+ * 
+ * @param gain the gain of the last result, ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+ * @param value the last result, a clipped value switches down as well
+ */
+constexpr uint8_t ads1219_autorange( uint8_t gain, int32_t value ) {
+    return gain == ADS1219_GAIN_ONE 
+         ? ( ( value < 0 ? -static_cast<int64_t>(value) : value ) < 0x7FFFFFLL * ADS1219_AUTORANGE_UP / 100 ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE )
+         : ( ( value < 0 ? -static_cast<int64_t>(value) : value ) > 0x7FFFFFLL * ADS1219_AUTORANGE_DOWN / 100 ? ADS1219_GAIN_ONE : ADS1219_GAIN_FOUR );
+}
+
+
+/**
+ * @brief One measurement in a scan plan
+ */
+struct ADS1219ScanEntry {
+    uint8_t  mux;       //! multiplexer setting, one of the ADS1219_MUX_* values
+    uint8_t  gain;      //! gain for this entry, ADS1219_GAIN_ONE, ADS1219_GAIN_FOUR, ADS1219_GAIN_KEEP or ADS1219_GAIN_AUTO
+    uint16_t samples;   //! number of conversions averaged for this entry
+    ADS1219Filter* filter; //! filter chain for the results of this entry, nullptr if none
+};
+
+
+/**
+ * @brief Ordered list of measurements to be run by ADS1219::scan()
+ * 
+ * The plan is a plain value object with a fixed number of entries (ADS1219_SCAN_MAX_ENTRIES), so it can be 
+ * declared globally without allocation. Besides the entries, it keeps the scan interval for periodic 
+ * scanning and the timing of the last scan.
+ * 
+ * An entry with ADS1219_GAIN_AUTO picks its gain from its previous result : gain 4 for small signals, gain 1
+ * for large ones, with hysteresis (see ads1219_autorange()). The gain goes out in the same register write as 
+ * the multiplexer setting, so a steady signal costs no extra bus traffic. Only a clipped result at gain 4 is 
+ * converted again, at gain 1, within the same scan. Use gain(i) to convert the result, e.g. with 
+ * ADS1219::milliVolts().
+ */
+class ADS1219ScanPlan {
+public:
+    ADS1219ScanPlan();
+
+    /**
+     * @brief Add a measurement to the end of the plan
+     * 
+     * @param mux the multiplexer setting, one of the ADS1219_MUX_* values
+     * @param gain gain for this measurement, ADS1219_GAIN_KEEP (default) leaves the gain as it is, 
+     * ADS1219_GAIN_AUTO switches between gain 1 and 4 (starting at gain 1)
+     * @param samples number of conversions to average, default 1
+     * @param filter optional filter chain for the results of this entry. The scan result is the output of the 
+     * chain, while a decimating filter holds it back the result is the previous output and the error code is 
+     * ADS1219_FILTER_PENDING. Each entry needs its own chain, as the filters keep state. 
+     * 
+     * @return error code, ADS1219_PLAN_FULL if there is no room left 
+     */
+    uint8_t add( uint8_t mux, uint8_t gain = ADS1219_GAIN_KEEP, uint16_t samples = 1, ADS1219Filter* filter = nullptr );
+
+    /**
+     * @brief Add a single ended measurement on channel 0-3
+     * 
+     * @return error code
+     */
+    uint8_t addSingleEnded( uint8_t channel, uint8_t gain = ADS1219_GAIN_KEEP, uint16_t samples = 1, ADS1219Filter* filter = nullptr );
+
+    /**
+     * @brief Remove all entries
+     */
+    void clear( void ) { _size = 0; }
+
+    /**
+     * @brief Number of entries in the plan
+     */
+    uint8_t size( void ) const { return _size; }
+
+    /**
+     * @brief Entry at position i
+     */
+    const ADS1219ScanEntry& entry( uint8_t i ) const { return _entries[i]; }
+
+    /**
+     * @brief Change the number of conversions averaged for entry i
+     */
+    void setSamples( uint8_t i, uint16_t samples ) { if ( i < _size ) _entries[i].samples = samples > 0 ? samples : 1; }
+
+    /**
+     * @brief Change the gain setting of entry i, as for add()
+     *
+     * @return error code, ADS1219_INVALID_GAIN for an unknown gain setting or entry
+     */
+    uint8_t setGain( uint8_t i, uint8_t gain );
+
+    /**
+     * @brief Gain of the result of entry i in the last scan, ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+     */
+    uint8_t gain( uint8_t i ) const { return _gain[i]; }
+
+    /**
+     * @brief Number of gain switches of the auto-ranged entries
+     */
+    uint32_t gainSwitches( void ) const { return _switches; }
+
+    /**
+     * @brief Number of conversions done again at gain 1 after clipping at gain 4
+     */
+    uint32_t rangeRedos( void ) const { return _redos; }
+
+    /**
+     * @brief Set the interval for ADS1219::scanIfDue(), 0 (default) disables periodic scanning
+     * 
+     * @param interval_us time between the start of consecutive scans in µs
+     */
+    void setInterval( unsigned long interval_us );
+
+    /**
+     * @brief Duration of the last scan in µs
+     */
+    unsigned long scanDuration( void ) const { return _duration_us; }
+
+    /**
+     * @brief micros() just after the START of entry i in the last scan, see ADS1219::conversionStart()
+     */
+    unsigned long startTime( uint8_t i ) const { return _entry_start_us[i]; }
+
+    /**
+     * @brief micros() at which the (last) conversion of entry i in the last scan was seen to be done, see 
+     * ADS1219::conversionEnd()
+     */
+    unsigned long endTime( uint8_t i ) const { return _entry_end_us[i]; }
+
+    /**
+     * @brief Achieved scan rate in scans per second
+     * 
+     * For periodic scanning this is based on the time between the start of the last two scans, otherwise on 
+     * the duration of the last scan. Returns 0 if no scan has been done yet.
+     */
+    float scanRate( void ) const;
+
+private:
+    friend class ADS1219;
+
+    ADS1219ScanEntry _entries[ADS1219_SCAN_MAX_ENTRIES];
+    uint8_t          _size;
+
+    unsigned long    _interval_us;  //! interval between scans, 0 if not periodic
+    unsigned long    _next_us;      //! micros() at which the next periodic scan is due
+    unsigned long    _start_us;     //! micros() at the start of the last scan
+    unsigned long    _period_us;    //! time between the start of the last two scans
+    unsigned long    _duration_us;  //! duration of the last scan
+    uint32_t         _scans;        //! number of scans done
+
+    unsigned long    _entry_start_us[ADS1219_SCAN_MAX_ENTRIES];  //! start of the conversions per entry
+    unsigned long    _entry_end_us[ADS1219_SCAN_MAX_ENTRIES];    //! end of the conversions per entry
+
+    uint8_t          _gain[ADS1219_SCAN_MAX_ENTRIES];     //! gain of the last result per entry
+    uint8_t          _next_gain[ADS1219_SCAN_MAX_ENTRIES]; //! gain for the next conversion of auto-ranged entries
+    uint32_t         _switches;     //! auto-range gain switches
+    uint32_t         _redos;        //! conversions redone after clipping
+};
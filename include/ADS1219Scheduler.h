@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+
+// What to do with ticks that went by while a scan or the application was late
+#define ADS1219_SCHEDULE_SKIP      0  // drop them, the next scan is for the current tick and the grid is kept
+#define ADS1219_SCHEDULE_CATCH_UP  1  // run a scan for every one of them, back to back, until back on time
+
+// Where the scan sits relative to its tick
+#define ADS1219_ALIGN_RESULT       0  // start early enough for the result to be there just before the tick
+#define ADS1219_ALIGN_START        1  // start the scan at the tick
+
+
+/**
+ * @brief Timing statistics of an ADS1219Scheduler, see ADS1219Scheduler::stats()
+ *
+ * The start error is the time between the planned and the actual start of a scan.
+ */
+struct ADS1219ScheduleStats {
+    uint32_t      scans;           //! scans run
+    uint32_t      missed;          //! ticks dropped (ADS1219_SCHEDULE_SKIP)
+    uint32_t      overruns;        //! scans with the result after their deadline : the tick (ADS1219_ALIGN_RESULT) or the next one
+    unsigned long jitter_max_us;   //! largest start error
+    unsigned long jitter_mean_us;  //! mean start error
+    unsigned long jitter_rms_us;   //! RMS of the start error
+    long          slack_min_us;    //! shortest time from a result to its deadline, negative after an overrun
+    unsigned long lead_us;         //! how long before the tick scans start (ADS1219_ALIGN_RESULT)
+};
+
+
+/**
+ * @brief Runs a scan plan on a fixed period, on an absolute micros() timeline
+ *
+ * Tick n is at first_tick + n * period, so the timing never drifts, whatever the time the scans and the
+ * rest of the main loop take. Call run() from the main loop as often as possible : it returns straight
+ * away until the next scan is close, then waits for its exact start time (at most the spin time, default
+ * 2 ms) and runs it.
+ *
+ * With ADS1219_ALIGN_RESULT (default) a scan starts early by its expected duration plus a guard time, so
+ * its result is ready just before the tick. The expected duration starts from the conversion times of the
+ * plan at the configured data rate and then follows the measured scan durations : up at once when a scan
+ * takes longer, down slowly when it's quicker.
+ *
+ * Every scan records the start (START command) and end of each entry's conversion in the plan, see
+ * ADS1219ScanPlan::startTime() and endTime().
+ */
+class ADS1219Scheduler {
+public:
+    ADS1219Scheduler( ADS1219& adc, ADS1219ScanPlan& plan );
+
+    /**
+     * @param policy ADS1219_SCHEDULE_SKIP (default) or ADS1219_SCHEDULE_CATCH_UP
+     */
+    void setPolicy( uint8_t policy ) { _policy = policy; }
+
+    /**
+     * @param align ADS1219_ALIGN_RESULT (default) or ADS1219_ALIGN_START
+     */
+    void setAlignment( uint8_t align ) { _align = align; }
+
+    /**
+     * @brief Time between the result and the tick with ADS1219_ALIGN_RESULT, default 200 µs
+     */
+    void setGuard( unsigned long guard_us ) { _guard_us = guard_us; }
+
+    /**
+     * @brief Longest busy wait for the start of a scan in run(), default 2000 µs
+     */
+    void setSpin( unsigned long spin_us ) { _spin_us = spin_us; }
+
+    /**
+     * @brief Start the schedule, also clears the statistics
+     *
+     * @param period_us time between ticks
+     * @param first_tick_us micros() of the first tick, 0 (default) for one period from now
+     */
+    void begin( unsigned long period_us, unsigned long first_tick_us = 0 );
+
+    /**
+     * @brief Run the scan for the next tick when it's due
+     *
+     * @param results receives the results of the plan, see ADS1219::scan()
+     * @param err_codes optionally receives the error code per entry
+     *
+     * @return true if a scan was run, results and tick() are then those of that scan. false while a 
+     * conversion or stream started by the application keeps the driver busy (lastError() is ADS1219_BUSY), 
+     * the tick is then scanned on a later call
+     */
+    bool run( int32_t* results, uint8_t* err_codes = nullptr );
+
+    /**
+     * @brief Tick of the last scan run
+     */
+    unsigned long tick( void ) const { return _tick_us; }
+
+    /**
+     * @brief Next tick to be scanned
+     */
+    unsigned long nextTick( void ) const { return _next_us; }
+
+    /**
+     * @brief micros() at which the scan for the next tick starts
+     */
+    unsigned long nextStart( void ) const;
+
+    /**
+     * @brief Error code of the last scan, see ADS1219::scan()
+     */
+    uint8_t lastError( void ) const { return _error; }
+
+    void stats( ADS1219ScheduleStats* s ) const;
+    void resetStats( void );
+
+private:
+    unsigned long _estimate_us( void );
+
+    ADS1219&         _adc;
+    ADS1219ScanPlan& _plan;
+    uint8_t          _policy;
+    uint8_t          _align;
+    unsigned long    _guard_us;
+    unsigned long    _spin_us;
+    unsigned long    _period_us;
+    unsigned long    _next_us;   //! next tick
+    unsigned long    _tick_us;   //! tick of the last scan
+    unsigned long    _lead_us;   //! expected scan duration
+    uint8_t          _error;
+
+    uint32_t         _scans, _missed, _overruns;
+    unsigned long    _jitter_max_us;
+    uint64_t         _jitter_sum, _jitter_sum2;
+    long             _slack_min_us;
+};
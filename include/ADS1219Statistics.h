@@ -0,0 +1,237 @@
+#pragma once
+
+#include <stdint.h>
+#include <math.h>
+
+
+// Effective resolution in bits for an RMS noise in counts : log2( full scale range / RMS noise ), the
+// full scale range being 2^24 counts at either gain. Capped at 24 bits for a noise below one count.
+inline float ads1219_effective_bits( float rms_counts )
+{
+    return rms_counts <= 1.f ? 24.f : 24.f - log2f( rms_counts );
+}
+
+// Noise free resolution in bits : the same with the peak to peak noise, taken as 6.6 times the RMS noise
+inline float ads1219_noise_free_bits( float rms_counts )
+{
+    return ads1219_effective_bits( 6.6f * rms_counts );
+}
+
+
+/**
+ * @brief Streaming count, mean, variance, minimum and maximum of raw ADC counts
+ *
+ * The samples are summed in 64 bit integers relative to the first one, so the sums are exact and there is
+ * no floating point per sample. The mean and variance are only worked out when asked for, and as the
+ * reference sample sits within the noise of the mean, the variance doesn't lose precision to cancellation,
+ * even with single precision doubles (AVR).
+ *
+ * The sum of the squares holds n * ( max - min )^2 < 2^64 : 65536 samples swinging over the full scale,
+ * billions of samples of a noisy but steady input.
+ */
+class ADS1219RunningStats {
+public:
+    ADS1219RunningStats() { reset(); }
+
+    void reset( void );
+
+    void push( int32_t value );
+
+    uint32_t count( void ) const { return _n; }
+    int32_t  min( void ) const { return _min; }
+    int32_t  max( void ) const { return _max; }
+    int32_t  peakToPeak( void ) const { return _n > 0 ? _max - _min : 0; }
+
+    /**
+     * @brief Mean of the samples, 0 without samples
+     */
+    double mean( void ) const;
+
+    /**
+     * @brief Sample variance (divided by n - 1), 0 below 2 samples
+     */
+    double variance( void ) const;
+
+    /**
+     * @brief Sample standard deviation, i.e. the RMS noise for a steady input
+     */
+    double stddev( void ) const { return sqrt( variance() ); }
+
+private:
+    uint32_t _n;
+    int32_t  _ref;   //! first sample
+    int64_t  _sum;   //! sum of value - _ref
+    uint64_t _sum2;  //! sum of ( value - _ref )^2
+    int32_t  _min;
+    int32_t  _max;
+};
+
+
+/**
+ * @brief Histogram of raw ADC counts in Bins equal bins
+ *
+ * Bin i holds the counts from low + i * width up to low + ( i + 1 ) * width. Samples outside the bins are
+ * counted by below() and above().
+ *
+ * @tparam Bins number of bins
+ */
+template <uint16_t Bins>
+class ADS1219Histogram {
+    static_assert( Bins > 0, "ADS1219Histogram needs at least one bin" );
+
+public:
+    /**
+     * @param low lower edge of the first bin
+     * @param width bin width in counts
+     */
+    ADS1219Histogram( int32_t low = -static_cast<int32_t>( Bins / 2 ), uint32_t width = 1 ) { setRange( low, width ); }
+
+    /**
+     * @brief Move the bins, also clears the histogram
+     */
+    void setRange( int32_t low, uint32_t width )
+    {
+        _low   = low;
+        _width = width > 0 ? width : 1;
+        clear();
+    }
+
+    /**
+     * @brief Bins centred on a value, e.g. the first sample or the mean, also clears the histogram
+     */
+    void center( int32_t value, uint32_t width )
+    {
+        setRange( value - static_cast<int32_t>( width * Bins / 2 ), width );
+    }
+
+    void clear( void )
+    {
+        for ( uint16_t i = 0; i < Bins; i++ ) _bin[i] = 0;
+        _below = 0;
+        _above = 0;
+    }
+
+    void push( int32_t value )
+    {
+        if ( value < _low ) {
+            _below++;
+            return;
+        }
+        uint32_t i = static_cast<uint32_t>( static_cast<int64_t>( value ) - _low ) / _width;
+        if ( i >= Bins ) _above++;
+        else _bin[i]++;
+    }
+
+    uint16_t bins( void ) const { return Bins; }
+    uint32_t count( uint16_t i ) const { return _bin[i]; }
+    uint32_t below( void ) const { return _below; }
+    uint32_t above( void ) const { return _above; }
+
+    /**
+     * @brief Lower edge of bin i
+     */
+    int32_t binLow( uint16_t i ) const { return _low + static_cast<int32_t>( i * _width ); }
+
+private:
+    int32_t  _low;
+    uint32_t _width;
+    uint32_t _bin[Bins];
+    uint32_t _below, _above;
+};
+
+
+/**
+ * @brief Streaming Allan deviation of raw ADC counts at octave spaced averaging times
+ *
+ * Octave k averages blocks of 2^k samples, its Allan variance is half the mean square difference of
+ * consecutive (non overlapping) block averages. Where the standard deviation only tells the white noise,
+ * the Allan deviation shows how far averaging helps : it falls with 1 / sqrt(2^k) as long as the noise is
+ * white, and flattens out or rises where flicker noise and drift take over.
+ *
+ * The blocks of octave k + 1 are made from two blocks of octave k, so a sample costs one integer add per
+ * completed block, on average two for all octaves. The block sums are exact in 64 bits, the squared
+ * differences are summed in floating point once per block.
+ *
+ * @tparam Octaves number of averaging times, 1 to 2^(Octaves - 1) samples
+ */
+template <uint8_t Octaves>
+class ADS1219AllanDeviation {
+    static_assert( Octaves > 0 && Octaves <= 24, "ADS1219AllanDeviation takes 1 to 24 octaves" );
+
+public:
+    ADS1219AllanDeviation() { reset(); }
+
+    void reset( void )
+    {
+        for ( uint8_t k = 0; k < Octaves; k++ ) {
+            _sq[k]       = 0.;
+            _n[k]        = 0;
+            _has_prev[k] = false;
+            _has_half[k] = false;
+        }
+        _samples = 0;
+    }
+
+    void push( int32_t value )
+    {
+        // relative to the first sample, so the block sums stay small
+        if ( _samples++ == 0 ) _ref = value;
+        int64_t s = static_cast<int64_t>( value ) - _ref;
+
+        // s is a completed block of octave k
+        for ( uint8_t k = 0; k < Octaves; k++ ) {
+            if ( _has_prev[k] ) {
+                double d = static_cast<double>( s - _prev[k] );
+                _sq[k] += d * d;
+                _n[k]++;
+            }
+            _prev[k]     = s;
+            _has_prev[k] = true;
+
+            // the second block of a pair completes a block of the next octave
+            if ( ! _has_half[k] ) {
+                _half[k]     = s;
+                _has_half[k] = true;
+                return;
+            }
+            s += _half[k];
+            _has_half[k] = false;
+        }
+    }
+
+    /**
+     * @brief Number of samples pushed
+     */
+    uint32_t samples( void ) const { return _samples; }
+
+    uint8_t octaves( void ) const { return Octaves; }
+
+    /**
+     * @brief Averaging time of octave k in samples
+     */
+    uint32_t tau( uint8_t k ) const { return static_cast<uint32_t>( 1 ) << k; }
+
+    /**
+     * @brief Number of block differences in octave k
+     */
+    uint32_t count( uint8_t k ) const { return _n[k]; }
+
+    /**
+     * @brief Allan deviation of octave k in counts, 0 until it has two blocks
+     */
+    double deviation( uint8_t k ) const
+    {
+        if ( _n[k] == 0 ) return 0.;
+        return sqrt( _sq[k] / ( 2. * _n[k] ) ) / tau( k );
+    }
+
+private:
+    int64_t  _half[Octaves];      //! first block of the pair being completed
+    int64_t  _prev[Octaves];      //! previous block sum
+    double   _sq[Octaves];        //! sum of squared differences of consecutive block sums
+    uint32_t _n[Octaves];         //! number of differences
+    bool     _has_prev[Octaves];
+    bool     _has_half[Octaves];
+    uint32_t _samples;
+    int32_t  _ref;                //! first sample
+};
@@ -0,0 +1,250 @@
+#pragma once
+
+#include "ADS1219.h"
+
+/**
+ * Compile time specialised ADS1219 driver
+ * 
+ * For applications with a fixed configuration, ADS1219T takes the address, DRDY pin, bus and configuration as
+ * template arguments. The configuration is validated with static_assert, the config register image, the 
+ * conversion time and the count to µV scale are computed by the compiler, and the class has no virtual 
+ * functions. The only state is the last multiplexer setting, to skip unchanged register writes, and whether
+ * conversions are running. 
+ * 
+ * Example :
+ * 
+ *     typedef ADS1219StaticConfig<ADS1219_GAIN_ONE, ADS1219_VREF_INTERNAL, ADS1219_DATARATE_90SPS> Config;
+ *     ADS1219T<0x40, 0, ADS1219Wire, Config> adc;
+ * 
+ *     adc.begin();
+ *     int32_t v = adc.read<ADS1219_MUX_SINGLE_0>(&err);
+ *     int32_t uv = adc.microVolts(v);
+ * 
+ * The runtime ADS1219 class is the one to use when the configuration changes at runtime, both share the 
+ * register encodings from ADS1219.h.
+ */
+
+
+/**
+ * @brief Default bus for ADS1219T : the global Wire object
+ */
+struct ADS1219Wire {
+    static TwoWire& bus( void ) { return Wire; }
+};
+
+
+/**
+ * @brief Fixed device configuration for ADS1219T
+ * 
+ * @tparam Gain ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+ * @tparam VRef ADS1219_VREF_INTERNAL or ADS1219_VREF_EXTERNAL
+ * @tparam Rate one of the ADS1219_DATARATE_* values
+ * @tparam Mode ADS1219_CM_SINGLE_SHOT or ADS1219_CM_CONTINUOUS
+ * @tparam ArefN_uV negative reference in µV, must be 0 for the internal reference
+ * @tparam ArefP_uV positive reference in µV, must be 2048000 for the internal reference
+ */
+template <uint8_t Gain = ADS1219_GAIN_ONE, uint8_t VRef = ADS1219_VREF_INTERNAL, uint8_t Rate = ADS1219_DATARATE_20SPS,
+          uint8_t Mode = ADS1219_CM_SINGLE_SHOT, int32_t ArefN_uV = 0, int32_t ArefP_uV = 2048000L>
+struct ADS1219StaticConfig {
+    static_assert( Gain == ADS1219_GAIN_ONE || Gain == ADS1219_GAIN_FOUR, "ADS1219: invalid gain" );
+    static_assert( VRef == ADS1219_VREF_INTERNAL || VRef == ADS1219_VREF_EXTERNAL, "ADS1219: invalid vref" );
+    static_assert( Rate <= ADS1219_DATARATE_1000SPS, "ADS1219: invalid datarate" );
+    static_assert( Mode == ADS1219_CM_SINGLE_SHOT || Mode == ADS1219_CM_CONTINUOUS, "ADS1219: invalid conversion mode" );
+    static_assert( VRef == ADS1219_VREF_EXTERNAL || ( ArefN_uV == 0 && ArefP_uV == 2048000L ), "ADS1219: internal reference is 0 - 2048 mV" );
+    static_assert( ArefP_uV > ArefN_uV, "ADS1219: positive reference must be above the negative one" );
+
+    static constexpr uint8_t  gain = Gain;
+    static constexpr uint8_t  rate = Rate;
+    static constexpr uint8_t  mode = Mode;
+
+    //! config register image without the multiplexer bits
+    static constexpr uint8_t  reg = ads1219_config( 0, Gain, Rate, Mode, VRef );
+
+    //! single-shot conversion time in µs, table 4 in the specs
+    static constexpr uint32_t conversion_us = ads1219_conversion_us( Rate );
+
+    //! time after the start of the first status check, allowing for the oscillator tolerance
+    static constexpr uint32_t ready_us = conversion_us + conversion_us * ADS1219_OSC_TOLERANCE / 100;
+
+    //! µV per count with 32 fractional bits : span [µV] / gain / 2^23 * 2^32
+    static constexpr int64_t  uv_scale = ( static_cast<int64_t>( ArefP_uV - ArefN_uV ) * 512 + Gain / 2 ) / Gain;
+};
+
+
+/**
+ * @brief ADS1219 driver with a compile time configuration
+ * 
+ * @tparam Addr I2C address
+ * @tparam DrdyPin pin connected to DRDY, read with digitalRead, 0 to poll the status register instead
+ * @tparam Bus type with a static bus() method returning the TwoWire to use, see ADS1219Wire
+ * @tparam Config an ADS1219StaticConfig
+ */
+template <uint8_t Addr = ADS1219_I2C_ADDRESS, uint8_t DrdyPin = 0, class Bus = ADS1219Wire, class Config = ADS1219StaticConfig<> >
+class ADS1219T {
+    static_assert( Addr >= 0x40 && Addr <= 0x4F, "ADS1219: address must be in the 0x40 - 0x4F range" );
+
+public:
+    typedef Config config_type;
+
+    ADS1219T() : _mux(0xFF), _mux_changed(false), _started(false) {}
+
+    /**
+     * @brief Start the bus and write the configuration
+     * 
+     * @return error code
+     */
+    uint8_t begin( void )
+    {
+        Bus::bus().begin();
+        if ( DrdyPin != 0 ) pinMode( DrdyPin, INPUT_PULLUP );
+        return reset();
+    }
+
+    /**
+     * @brief Reset the device and write the configuration
+     * 
+     * @return error code
+     */
+    uint8_t reset( void )
+    {
+        uint8_t code = _command( ADS1219_CMD_RESET );
+        if ( code != ADS1219_OK ) return code;
+
+        // the device is back at its defaults whatever was cached, so the configuration always goes out
+        _mux     = 0xFF;
+        _started = false;
+        return _mux_write( ADS1219_MUX_DIFF_0_1 );
+    }
+
+    uint8_t start( void )
+    {
+        uint8_t code = _command( ADS1219_CMD_START_SYNC );
+        if ( code == ADS1219_OK ) _started = true;
+        return code;
+    }
+
+    uint8_t powerDown( void )
+    {
+        uint8_t code = _command( ADS1219_CMD_POWERDOWN );
+        if ( code == ADS1219_OK ) _started = false;
+        return code;
+    }
+
+    /**
+     * @brief Single conversion on a fixed multiplexer setting, the setting is checked at compile time
+     * 
+     * @tparam Mux one of the ADS1219_MUX_* values
+     * @param err_code returns an error code, 0 if all was well
+     * 
+     * @return the raw ADC count, 0x80000000 on error
+     */
+    template <uint8_t Mux>
+    int32_t read( uint8_t* err_code )
+    {
+        static_assert( ads1219_valid_mux( Mux ), "ADS1219: invalid mux" );
+
+        if ( ( *err_code = _mux_write( Mux ) ) != ADS1219_OK ) return 0x80000000;
+        // continuous conversions run from the first START after a reset or power down, and restart on a new
+        // multiplexer setting
+        if ( Config::mode == ADS1219_CM_SINGLE_SHOT || _mux_changed || ! _started ) {
+            if ( ( *err_code = start() ) != ADS1219_OK ) return 0x80000000;
+        }
+        if ( ( *err_code = _wait() ) != ADS1219_OK ) return 0x80000000;
+
+        return readData( err_code );
+    }
+
+    /**
+     * @brief Read the last conversion result (RDATA)
+     * 
+     * @param err_code returns an error code, ADS1219_ADC_OVERFLOW/UNDERFLOW for clipped results
+     * 
+     * @return the raw ADC count, 0x80000000 on a bus error
+     */
+    int32_t readData( uint8_t* err_code )
+    {
+        uint8_t b[3];
+        if ( ( *err_code = _command( ADS1219_CMD_RDATA ) ) != ADS1219_OK ) return 0x80000000;
+        if ( ( *err_code = _read( b, 3 ) ) != ADS1219_OK ) return 0x80000000;
+
+        int32_t value = ( ( static_cast<int32_t>(b[0]) << 24 ) | ( static_cast<int32_t>(b[1]) << 16 ) | 
+                          ( static_cast<int32_t>(b[2]) << 8 ) ) >> 8;
+        if ( value >= 0x7FFFFF ) *err_code = ADS1219_ADC_OVERFLOW;
+        if ( value <= -0x800000 ) *err_code = ADS1219_ADC_UNDERFLOW;
+
+        return value;
+    }
+
+    /**
+     * @brief Convert raw counts to µV with the compile time scale, rounded to the nearest µV (halves up)
+     */
+    static constexpr int32_t microVolts( int32_t counts )
+    {
+        return static_cast<int32_t>( ( counts * Config::uv_scale + ( static_cast<int64_t>(1) << 31 ) ) >> 32 );
+    }
+
+    /**
+     * @brief Conversion time in µs
+     */
+    static constexpr uint32_t conversionTime( void ) { return Config::conversion_us; }
+
+private:
+    uint8_t _command( uint8_t cmd )
+    {
+        Bus::bus().beginTransmission( Addr );
+        Bus::bus().write( cmd );
+        return Bus::bus().endTransmission() == 0 ? ADS1219_OK : ADS1219_FAILED_TO_END;
+    }
+
+    uint8_t _read( uint8_t* buffer, uint8_t len )
+    {
+        if ( Bus::bus().requestFrom( static_cast<uint8_t>(Addr), len ) != len ) return ADS1219_FAILED_TO_RECEIVE;
+        for ( uint8_t i = 0; i < len; i++ ) buffer[i] = Bus::bus().read();
+        return ADS1219_OK;
+    }
+
+    uint8_t _mux_write( uint8_t mux )
+    {
+        _mux_changed = ( mux != _mux );
+        if ( ! _mux_changed ) return ADS1219_OK;
+
+        Bus::bus().beginTransmission( Addr );
+        Bus::bus().write( static_cast<uint8_t>( ADS1219_CMD_WREG ) );
+        Bus::bus().write( static_cast<uint8_t>( Config::reg | mux ) );
+        if ( Bus::bus().endTransmission() != 0 ) {
+            _mux = 0xFF;
+            return ADS1219_FAILED_TO_END;
+        }
+        _mux = mux;
+
+        return ADS1219_OK;
+    }
+
+    uint8_t _wait( void )
+    {
+        unsigned long tstart = micros();
+
+        if ( DrdyPin != 0 ) {
+            while ( digitalRead( DrdyPin ) != LOW ) {
+                if ( micros() - tstart > Config::conversion_us + 100000UL ) return ADS1219_TIMEOUT;
+                yield();
+            }
+            return ADS1219_OK;
+        }
+
+        // stay off the bus during the conversion, then poll the status register
+        while ( micros() - tstart < Config::ready_us ) yield();
+        while ( true ) {
+            uint8_t status, code;
+            if ( ( code = _command( ADS1219_CMD_RREG_STATUS ) ) != ADS1219_OK ) return code;
+            if ( ( code = _read( &status, 1 ) ) != ADS1219_OK ) return code;
+            if ( status & 0x80 ) return ADS1219_OK;
+            if ( micros() - tstart > Config::conversion_us + 100000UL ) return ADS1219_TIMEOUT;
+            delayMicroseconds( Config::conversion_us / 32 > 100 ? Config::conversion_us / 32 : 100 );
+        }
+    }
+
+    uint8_t _mux;          //! multiplexer bits in the device, 0xFF if unknown
+    bool    _mux_changed;  //! the last _mux_write changed the multiplexer
+    bool    _started;      //! a START since the last reset or power down
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ADS1219.h"
+
+// States of a window comparator, see ADS1219Window
+#define ADS1219_WINDOW_INSIDE  0  // between the thresholds
+#define ADS1219_WINDOW_ABOVE   1  // above the upper threshold
+#define ADS1219_WINDOW_BELOW   2  // below the lower threshold
+
+
+/**
+ * @brief Window comparator on the raw counts of one multiplexer setting
+ *
+ * Attach it to the driver with ADS1219::setWindow(mux, &window) and every conversion of that multiplexer
+ * setting goes through check(), whichever way it was read : single reads, scans, polls, oversampling and
+ * streaming. The comparator tracks whether the input is inside the window, above or below it, and only
+ * reports the crossings : it sets the event flag and calls the event function.
+ *
+ * The thresholds are given in mV and converted to counts for both gains once, when they are set and when
+ * the reference of the driver changes, so check() is only integer compares. Leaving the window takes a
+ * sample beyond a threshold, going back in takes a sample at least the hysteresis past the threshold.
+ * With a debounce of n, a new state only counts after n samples in a row agree on it.
+ *
+ * With setSuppress(true), a stream (ADS1219::startStream) only buffers the samples which complete a
+ * crossing, so the application only sees the events. Reads and scans still return every value.
+ *
+ * The comparator sees the raw counts, before offset correction and filters. The initial state is
+ * ADS1219_WINDOW_INSIDE, so an input which starts outside the window gives an event.
+ */
+class ADS1219Window {
+public:
+    /**
+     * @param mux multiplexer setting of the sample
+     * @param state new state, one of the ADS1219_WINDOW_* values
+     * @param value raw count of the sample which completed the crossing
+     * @param context as passed to onEvent()
+     */
+    typedef void (*EventFunction)( uint8_t mux, uint8_t state, int32_t value, void* context );
+
+    ADS1219Window();
+
+    /**
+     * @brief Set the window
+     *
+     * @param low_mV lower threshold
+     * @param high_mV upper threshold
+     * @param hysteresis_mV distance past a threshold to go back inside, at least 0 and less than the window
+     *
+     * @return false for an empty window or a hysteresis out of range, the window is left as it was
+     */
+    bool setThresholds( float low_mV, float high_mV, float hysteresis_mV = 0.f );
+
+    /**
+     * @brief Number of samples in a row it takes to change state, default 1
+     */
+    void setDebounce( uint8_t samples ) { _debounce = samples > 0 ? samples : 1; }
+
+    /**
+     * @brief Function to call on every crossing, nullptr for none
+     */
+    void onEvent( EventFunction fn, void* context = nullptr ) { _fn = fn; _context = context; }
+
+    /**
+     * @brief Leave the samples which don't complete a crossing out of the stream
+     */
+    void setSuppress( bool suppress ) { _suppress = suppress; }
+    bool suppress( void ) const { return _suppress; }
+
+    /**
+     * @brief Reference span of the driver in mV, converts the thresholds to counts, see ADS1219::setWindow()
+     */
+    void setReference( float vref_mV );
+
+    /**
+     * @brief Compare a sample, the hot path
+     *
+     * @param mux multiplexer setting, passed on to the event function
+     * @param value raw count
+     * @param gain_four the sample was taken at gain 4
+     *
+     * @return true if the sample is to be delivered : always without suppression, else only for a crossing
+     */
+    bool check( uint8_t mux, int32_t value, bool gain_four );
+
+    /**
+     * @brief Back to ADS1219_WINDOW_INSIDE, clears the event flag and counter
+     */
+    void reset( void );
+
+    /**
+     * @brief Current state, one of the ADS1219_WINDOW_* values
+     */
+    uint8_t state( void ) const { return _state; }
+
+    /**
+     * @brief Event flag : true if there was a crossing since the last call, clears the flag
+     */
+    bool event( void ) { bool e = _event; _event = false; return e; }
+
+    /**
+     * @brief Number of crossings since reset()
+     */
+    uint32_t events( void ) const { return _events; }
+
+    /**
+     * @brief Thresholds in counts, for ADS1219_GAIN_ONE or ADS1219_GAIN_FOUR
+     */
+    int32_t low( uint8_t gain ) const { return _low[gain == ADS1219_GAIN_FOUR ? 1 : 0]; }
+    int32_t high( uint8_t gain ) const { return _high[gain == ADS1219_GAIN_FOUR ? 1 : 0]; }
+
+private:
+    void _convert( void );
+
+    float    _low_mV, _high_mV, _hysteresis_mV;
+    float    _vref_mV;
+    int32_t  _low[2];         //! lower threshold in counts, gain 1 and gain 4
+    int32_t  _high[2];        //! upper threshold in counts
+    int32_t  _hysteresis[2];  //! hysteresis in counts
+    uint8_t  _debounce;       //! samples in a row to change state
+    uint8_t  _count;          //! samples in a row agreeing on _candidate
+    uint8_t  _state;
+    uint8_t  _candidate;      //! state the last samples agree on
+    bool     _suppress;
+    volatile bool _event;     //! a crossing since the last event()
+    uint32_t _events;
+    EventFunction _fn;
+    void*    _context;
+};
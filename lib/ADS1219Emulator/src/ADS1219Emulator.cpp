@@ -0,0 +1,367 @@
+#include "ADS1219Emulator.h"
+
+
+ADS1219Emulator ADS1219Device;
+
+
+// what the next read from the device returns
+#define EMU_READ_NONE    0
+#define EMU_READ_CONFIG  1
+#define EMU_READ_STATUS  2
+#define EMU_READ_DATA    3
+
+
+ADS1219Emulator::ADS1219Emulator( TwoWire& wire, uint8_t address, uint8_t drdy_pin )
+    : _wire(&wire)
+    , _address(address)
+    , _drdy_pin(drdy_pin)
+    , _sda_pin(0)
+    , _scl_pin(0)
+    , _stuck(0)
+{
+    powerCycle();
+    _wire->attach( _address, this );
+    ArduinoNative::addListener( this );
+    ArduinoNative::addPinListener( this );
+}
+
+
+ADS1219Emulator::~ADS1219Emulator()
+{
+    ArduinoNative::removePinListener( this );
+    ArduinoNative::removeListener( this );
+    _wire->attach( _address, nullptr );
+}
+
+
+void ADS1219Emulator::powerCycle( void )
+{
+    _config        = 0x00;
+    _status        = 0x00;
+    _data          = 0;
+    _pending       = EMU_READ_NONE;
+    _converting    = false;
+    _powerdown_req = false;
+    _powered_down  = false;
+    _conv_end      = UINT64_MAX;
+
+    for ( float& v : _ain ) v = 0.f;
+    _refn      = 0.f;
+    _refp      = 2048.f;
+    _offset    = 0;
+    _sigma     = 0.f;
+    _rng       = 1;
+    _osc_error = 0.f;
+    _fail      = 0;
+    _fail_wreg = 0;
+    _fault_level = 0;
+    _fault_rng   = 1;
+    if ( _stuck > 0 && _sda_pin != 0 ) ArduinoNative::setPin( _sda_pin, HIGH );
+    _stuck       = 0;
+
+    resetCounters();
+    _drdy( HIGH );
+}
+
+
+void ADS1219Emulator::resetCounters( void )
+{
+    _n_conversions = _n_starts = _n_rdata = _n_rreg = _n_wreg = 0;
+    for ( uint64_t& t : _state_us ) t = 0;
+    _state_since = ArduinoNative::now();
+}
+
+
+uint64_t ADS1219Emulator::powerStateTime( uint8_t state )
+{
+    _account();
+    return state < 3 ? _state_us[state] : 0;
+}
+
+
+void ADS1219Emulator::_account( void )
+{
+    // time since the last state change goes to the current state
+    uint64_t now = ArduinoNative::now();
+    uint8_t state = _powered_down ? ADS1219_EMU_POWERDOWN : _converting ? ADS1219_EMU_CONVERTING : ADS1219_EMU_IDLE;
+    _state_us[state] += now - _state_since;
+    _state_since = now;
+}
+
+
+void ADS1219Emulator::setInput( uint8_t ain, float mV )
+{
+    if ( ain < 4 ) _ain[ain] = mV;
+}
+
+
+void ADS1219Emulator::setExternalReference( float refn_mV, float refp_mV )
+{
+    _refn = refn_mV;
+    _refp = refp_mV;
+}
+
+
+void ADS1219Emulator::setNoise( float sigma, uint32_t seed )
+{
+    _sigma = sigma;
+    _rng   = seed ? seed : 1;
+}
+
+
+void ADS1219Emulator::setDrdyPin( uint8_t pin )
+{
+    _drdy_pin = pin;
+    _drdy( ( _status & 0x80 ) ? LOW : HIGH );
+}
+
+
+float ADS1219Emulator::conversionTime( uint8_t rate, bool continuous )
+{
+    // periods of the 1.024 MHz oscillator, see table 4 in the specs
+    static const uint32_t single_shot[4] = { 51213, 11557, 3141, 1061 };
+    static const uint32_t repeated[4]    = { 51192, 11532, 3116, 1036 };
+    return ( continuous ? repeated : single_shot )[rate & 0x03] / 1.024f;
+}
+
+
+void ADS1219Emulator::setFaultRate( float probability, uint32_t seed )
+{
+    _fault_level = probability <= 0.f ? 0 : probability >= 1.f ? UINT32_MAX : static_cast<uint32_t>( probability * 4294967296.f );
+    _fault_rng   = seed ? seed : 1;
+}
+
+
+void ADS1219Emulator::stickSda( uint8_t clocks )
+{
+    _stuck = clocks;
+    if ( _stuck > 0 && _sda_pin != 0 ) ArduinoNative::setPin( _sda_pin, LOW );
+}
+
+
+void ADS1219Emulator::pinChanged( uint8_t pin, uint8_t level )
+{
+    if ( _stuck == 0 || _sda_pin == 0 ) return;
+
+    // the device pulling SDA low wins over the pull-up
+    if ( pin == _sda_pin && level == HIGH ) ArduinoNative::setPin( _sda_pin, LOW );
+
+    // every SCL clock moves the device on by a bit, at the end of the byte it lets go of SDA
+    if ( pin == _scl_pin && level == LOW && --_stuck == 0 ) ArduinoNative::setPin( _sda_pin, HIGH );
+}
+
+
+bool ADS1219Emulator::i2cAck( void )
+{
+    if ( _stuck > 0 ) return false;
+
+    if ( _fault_level > 0 ) {
+        _fault_rng ^= _fault_rng << 13;
+        _fault_rng ^= _fault_rng >> 17;
+        _fault_rng ^= _fault_rng << 5;
+        if ( _fault_rng < _fault_level ) return false;
+    }
+
+    if ( _fail == 0 ) return true;
+    _fail--;
+    return false;
+}
+
+
+bool ADS1219Emulator::i2cWrite( const uint8_t* data, size_t len )
+{
+    if ( len == 0 ) return true;  // address probe
+
+    uint8_t cmd = data[0];
+
+    _account();
+
+    if ( cmd == 0x06 )   // RESET
+    {
+        _config        = 0x00;
+        _status        = 0x00;
+        _pending       = EMU_READ_NONE;
+        _converting    = false;
+        _powerdown_req = false;
+        _powered_down  = false;
+        _conv_end      = UINT64_MAX;
+        _drdy( HIGH );
+        return len == 1;
+    }
+    if ( cmd == 0x08 )   // START/SYNC
+    {
+        _n_starts++;
+        _powered_down  = false;
+        _powerdown_req = false;
+        _start();
+        return len == 1;
+    }
+    if ( cmd == 0x02 )   // POWERDOWN, completes the running conversion first
+    {
+        if ( _converting ) _powerdown_req = true;
+        else _powered_down = true;
+        return len == 1;
+    }
+    if ( cmd == 0x10 )   // RDATA
+    {
+        _pending = EMU_READ_DATA;
+        return len == 1;
+    }
+    if ( ( cmd & 0xF8 ) == 0x20 )   // RREG, register address in bit 2
+    {
+        _n_rreg++;
+        _pending = ( cmd & 0x04 ) ? EMU_READ_STATUS : EMU_READ_CONFIG;
+        return len == 1;
+    }
+    if ( ( cmd & 0xF8 ) == 0x40 )   // WREG, only the config register is writeable
+    {
+        if ( len != 2 || ( cmd & 0x04 ) != 0 ) return false;
+        if ( _fail_wreg > 0 ) {
+            _fail_wreg--;
+            return false;
+        }
+        _n_wreg++;
+        _config = data[1];
+        return true;
+    }
+
+    return false;
+}
+
+
+size_t ADS1219Emulator::i2cRead( uint8_t* data, size_t len )
+{
+    uint8_t out[3] = { 0xFF, 0xFF, 0xFF };
+    size_t  n = 0;
+
+    switch ( _pending ) 
+    {
+        case EMU_READ_CONFIG:
+            out[0] = _config;
+            n = 1;
+            break;
+        case EMU_READ_STATUS:
+            out[0] = _status;
+            n = 1;
+            break;
+        case EMU_READ_DATA:
+            out[0] = ( _data >> 16 ) & 0xFF;
+            out[1] = ( _data >> 8 ) & 0xFF;
+            out[2] = _data & 0xFF;
+            n = 3;
+            _n_rdata++;
+            // reading the data clears DRDY
+            _status &= ~0x80;
+            _drdy( HIGH );
+            break;
+        default:
+            break;
+    }
+    _pending = EMU_READ_NONE;
+
+    // the bus reads 0xFF for whatever the device doesn't drive
+    for ( size_t i = 0; i < len; i++ ) data[i] = i < n ? out[i] : 0xFF;
+
+    return len;
+}
+
+
+uint64_t ADS1219Emulator::nextEvent( void )
+{
+    return _converting ? _conv_end : UINT64_MAX;
+}
+
+
+void ADS1219Emulator::tick( uint64_t now )
+{
+    (void) now;
+    if ( _converting && _conv_end <= ArduinoNative::now() ) _complete();
+}
+
+
+void ADS1219Emulator::_start( void )
+{
+    float t = conversionTime( ( _config >> 2 ) & 0x03 ) * ( 1.f + _osc_error );
+
+    _converting = true;
+    _conv_end   = ArduinoNative::now() + static_cast<uint64_t>( t + 0.5f );
+    _status    &= ~0x80;
+    _drdy( HIGH );
+}
+
+
+void ADS1219Emulator::_complete( void )
+{
+    _account();
+    _data = _sample();
+    _n_conversions++;
+
+    // new data, if the old data was not read, DRDY pulses high first so there is a falling edge for each conversion
+    _status |= 0x80;
+    _drdy( HIGH );
+    _drdy( LOW );
+
+    if ( _powerdown_req ) {
+        _powerdown_req = false;
+        _powered_down  = true;
+        _converting    = false;
+        _conv_end      = UINT64_MAX;
+    } else if ( _config & 0x02 ) {
+        // continuous mode, next conversion right away
+        float t = conversionTime( ( _config >> 2 ) & 0x03, true ) * ( 1.f + _osc_error );
+        _conv_end += static_cast<uint64_t>( t + 0.5f );
+    } else {
+        _converting = false;
+        _conv_end   = UINT64_MAX;
+    }
+}
+
+
+int32_t ADS1219Emulator::_sample( void )
+{
+    float vp = 0.f, vn = 0.f;
+
+    switch ( _config >> 5 ) 
+    {
+        case 0: vp = _ain[0]; vn = _ain[1]; break;
+        case 1: vp = _ain[2]; vn = _ain[3]; break;
+        case 2: vp = _ain[1]; vn = _ain[2]; break;
+        case 3: vp = _ain[0]; break;
+        case 4: vp = _ain[1]; break;
+        case 5: vp = _ain[2]; break;
+        case 6: vp = _ain[3]; break;
+        default: break;  // shorted to AVDD/2
+    }
+
+    float vref = ( _config & 0x01 ) ? ( _refp - _refn ) : 2048.f;
+    float gain = ( _config & 0x10 ) ? 4.f : 1.f;
+
+    double counts = static_cast<double>( vp - vn ) * gain / vref * 8388608.0 + _offset;
+    if ( _sigma > 0.f ) counts += _sigma * _gauss();
+
+    if ( counts >= 8388607.0 ) return 8388607;
+    if ( counts <= -8388608.0 ) return -8388608;
+
+    return static_cast<int32_t>( lround( counts ) );
+}
+
+
+float ADS1219Emulator::_gauss( void )
+{
+    // xorshift32 + Box-Muller, reproducible across hosts
+    float u[2];
+    for ( float& x : u ) {
+        _rng ^= _rng << 13;
+        _rng ^= _rng >> 17;
+        _rng ^= _rng << 5;
+        x = ( ( _rng >> 8 ) + 0.5f ) / 16777216.f;
+    }
+
+    return sqrtf( -2.f * logf( u[0] ) ) * cosf( 6.2831853f * u[1] );
+}
+
+
+void ADS1219Emulator::_drdy( uint8_t level )
+{
+    if ( _drdy_pin != 0 ) ArduinoNative::setPin( _drdy_pin, level );
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Arduino.h"
+#include "Wire.h"
+
+
+// Power states, see ADS1219Emulator::powerStateTime()
+#define ADS1219_EMU_POWERDOWN   0  // power-down mode
+#define ADS1219_EMU_IDLE        1  // powered up, not converting
+#define ADS1219_EMU_CONVERTING  2  // conversion in progress
+
+
+/**
+ * @brief Register level model of an ADS1219 on the emulated TwoWire bus
+ * 
+ * Implements the configuration and status registers, the RESET, START/SYNC, POWERDOWN, RDATA, RREG and WREG 
+ * commands, single shot and continuous conversions with the conversion time of the selected data rate, and 
+ * the DRDY output pin. The conversion result is computed from the voltages set on the analog inputs, the 
+ * multiplexer, gain and reference, with an optional offset and gaussian noise. 
+ */
+class ADS1219Emulator : public TwoWireDevice, public ArduinoNative::ClockListener, public ArduinoNative::PinListener {
+public:
+    /**
+     * @brief Constructor, attaches the device to the bus
+     * 
+     * @param wire the emulated bus
+     * @param address 7 bit I2C address
+     * @param drdy_pin pin driven by the DRDY output, 0 if not connected
+     */
+    ADS1219Emulator( TwoWire& wire = Wire, uint8_t address = 0x40, uint8_t drdy_pin = 0 );
+    ~ADS1219Emulator();
+
+    /**
+     * @brief Back to the power-on state, also clears the inputs, noise model and counters
+     */
+    void powerCycle( void );
+
+    /**
+     * @brief Set the voltage (mV) on analog input 0-3
+     */
+    void setInput( uint8_t ain, float mV );
+
+    /**
+     * @brief Set the external reference voltages (mV), used when VREF is set to external
+     */
+    void setExternalReference( float refn_mV, float refp_mV );
+
+    /**
+     * @brief Offset (in counts) added to every conversion
+     */
+    void setOffset( int32_t counts ) { _offset = counts; }
+
+    /**
+     * @brief Gaussian noise (standard deviation in counts) added to every conversion
+     * 
+     * @param sigma noise level in counts, 0 disables the noise
+     * @param seed seed of the pseudo random generator, results are reproducible for a given seed
+     */
+    void setNoise( float sigma, uint32_t seed = 1 );
+
+    /**
+     * @brief Deviation of the internal oscillator, e.g. 0.02 makes every conversion 2 % slower
+     */
+    void setOscillatorError( float fraction ) { _osc_error = fraction; }
+
+    /**
+     * @brief Connect the DRDY output to a pin, 0 to disconnect
+     */
+    void setDrdyPin( uint8_t pin );
+
+    /**
+     * @brief NACK the next n transactions, to inject bus errors
+     */
+    void failNext( uint16_t n ) { _fail = n; }
+
+    /**
+     * @brief NACK the data of the next n configuration writes (WREG) only, the register keeps its value
+     */
+    void failWrites( uint16_t n ) { _fail_wreg = n; }
+
+    /**
+     * @brief NACK every transaction with the given probability, to inject random bus errors
+     * 
+     * @param probability 0 (default) to 1
+     * @param seed seed of the pseudo random generator, faults are reproducible for a given seed
+     */
+    void setFaultRate( float probability, uint32_t seed = 1 );
+
+    /**
+     * @brief Pins of the bus lines, for stickSda()
+     */
+    void setBusPins( uint8_t sda_pin, uint8_t scl_pin ) { _sda_pin = sda_pin; _scl_pin = scl_pin; }
+
+    /**
+     * @brief Hold SDA low, as a device which lost track in the middle of a read, until SCL is clocked
+     * 
+     * While SDA is held low no transaction gets through. Needs setBusPins().
+     * 
+     * @param clocks number of SCL clocks after which SDA is released
+     */
+    void stickSda( uint8_t clocks );
+
+    bool     sdaStuck( void ) const { return _stuck > 0; }
+
+    uint8_t  config( void ) const { return _config; }
+    uint8_t  status( void ) const { return _status; }
+    bool     converting( void ) const { return _converting; }
+    bool     poweredDown( void ) const { return _powered_down; }
+
+    // Counters since powerCycle() or resetCounters()
+    uint32_t conversions( void ) const { return _n_conversions; }
+    uint32_t starts( void ) const { return _n_starts; }
+    uint32_t dataReads( void ) const { return _n_rdata; }
+    uint32_t registerReads( void ) const { return _n_rreg; }
+    uint32_t registerWrites( void ) const { return _n_wreg; }
+    void     resetCounters( void );
+
+    /**
+     * @brief Virtual time (µs) spent in a power state (ADS1219_EMU_POWERDOWN, _IDLE or _CONVERTING) since 
+     * powerCycle() or resetCounters()
+     */
+    uint64_t powerStateTime( uint8_t state );
+
+    /**
+     * @brief Conversion time in µs for a data rate (0-3) at the nominal oscillator frequency (table 4 in the specs)
+     * 
+     * The first conversion after START takes the single-shot time, continuous conversions after it are a bit shorter. 
+     */
+    static float conversionTime( uint8_t rate, bool continuous = false );
+
+    // TwoWireDevice
+    bool   i2cWrite( const uint8_t* data, size_t len ) override;
+    size_t i2cRead( uint8_t* data, size_t len ) override;
+    bool   i2cAck( void ) override;
+
+    // ClockListener
+    uint64_t nextEvent( void ) override;
+    void     tick( uint64_t now ) override;
+
+    // PinListener
+    void     pinChanged( uint8_t pin, uint8_t level ) override;
+
+private:
+    void    _start( void );
+    void    _complete( void );
+    int32_t _sample( void );
+    float   _gauss( void );
+    void    _drdy( uint8_t level );
+    void    _account( void );
+
+    TwoWire* _wire;
+    uint8_t  _address;
+    uint8_t  _drdy_pin;
+
+    uint8_t  _config;
+    uint8_t  _status;
+    int32_t  _data;
+
+    uint8_t  _pending;        //! what the next read returns
+    bool     _converting;
+    bool     _powerdown_req;  //! power down after the current conversion
+    bool     _powered_down;
+    uint64_t _conv_end;       //! virtual time at which the running conversion completes
+
+    float    _ain[4];
+    float    _refn, _refp;
+    int32_t  _offset;
+    float    _sigma;
+    uint32_t _rng;
+    float    _osc_error;
+    uint16_t _fail;
+    uint16_t _fail_wreg;
+    uint32_t _fault_level;    //! NACK probability * 2^32
+    uint32_t _fault_rng;
+    uint8_t  _sda_pin, _scl_pin;
+    uint8_t  _stuck;          //! SCL clocks until SDA is released, 0 if not stuck
+
+    uint32_t _n_conversions, _n_starts, _n_rdata, _n_rreg, _n_wreg;
+    uint64_t _state_us[3];     //! time per power state
+    uint64_t _state_since;     //! virtual time up to which _state_us is accounted
+};
+
+
+/**
+ * @brief Default device, on Wire at address 0x40, so the hardware tests run unchanged on the host
+ */
+extern ADS1219Emulator ADS1219Device;
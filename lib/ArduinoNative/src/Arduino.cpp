@@ -0,0 +1,325 @@
+#include "Arduino.h"
+
+#include <stdio.h>
+
+#include <chrono>
+#include <thread>
+
+
+HardwareSerial Serial;
+
+namespace {
+
+uint64_t      s_now            = 0;
+uint32_t      s_yield_us       = 10;
+bool          s_irq_available  = true;
+unsigned long s_loops          = 0;
+bool          s_real_time      = false;
+
+ArduinoNative::ClockListener* s_listeners[8] = { nullptr };
+ArduinoNative::PinListener*   s_pin_listeners[8] = { nullptr };
+
+uint8_t s_pin_level[ARDUINO_NATIVE_MAX_PINS];
+uint8_t s_pin_mode[ARDUINO_NATIVE_MAX_PINS];
+uint8_t s_pin_latch[ARDUINO_NATIVE_MAX_PINS];      // output level, or the pull-up of an input as on AVR
+bool    s_pin_pull_up[ARDUINO_NATIVE_MAX_PINS];    // external pull-up on the line
+uint32_t s_pin_driven_high[ARDUINO_NATIVE_MAX_PINS];
+void  (*s_isr[ARDUINO_NATIVE_MAX_PINS])(void);
+int     s_isr_mode[ARDUINO_NATIVE_MAX_PINS];
+bool    s_irq_enabled = true;
+
+uint64_t host_now( void )
+{
+    static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - t0 ).count();
+}
+
+}
+
+
+namespace ArduinoNative {
+
+uint64_t now( void )
+{
+    if ( s_real_time ) s_now = host_now();
+    return s_now;
+}
+
+
+void advance( uint64_t us )
+{
+    if ( s_real_time ) {
+        std::this_thread::sleep_for( std::chrono::microseconds( us ) );
+        us = 0;
+    }
+
+    uint64_t target = now() + us;
+
+    // step from event to event, so listeners act at the exact virtual time
+    while ( true ) 
+    {
+        uint64_t next = target;
+        for ( ClockListener* l : s_listeners ) {
+            if ( l == nullptr ) continue;
+            uint64_t t = l->nextEvent();
+            if ( t < next ) next = t;
+        }
+
+        if ( next > s_now ) s_now = next;
+
+        bool fired = false;
+        for ( ClockListener* l : s_listeners ) {
+            if ( l != nullptr && l->nextEvent() <= s_now ) {
+                l->tick( s_now );
+                fired = true;
+            }
+        }
+
+        if ( ! fired && s_now >= target ) break;
+    }
+}
+
+
+void resetClock( void )
+{
+    s_now = 0;
+}
+
+
+void addListener( ClockListener* listener )
+{
+    for ( ClockListener*& l : s_listeners ) {
+        if ( l == nullptr ) {
+            l = listener;
+            return;
+        }
+    }
+}
+
+
+void removeListener( ClockListener* listener )
+{
+    for ( ClockListener*& l : s_listeners ) {
+        if ( l == listener ) l = nullptr;
+    }
+}
+
+
+void addPinListener( PinListener* listener )
+{
+    for ( PinListener*& l : s_pin_listeners ) {
+        if ( l == nullptr ) {
+            l = listener;
+            return;
+        }
+    }
+}
+
+
+void removePinListener( PinListener* listener )
+{
+    for ( PinListener*& l : s_pin_listeners ) {
+        if ( l == listener ) l = nullptr;
+    }
+}
+
+
+void setYieldTime( uint32_t us )
+{
+    s_yield_us = us;
+}
+
+
+void setPin( uint8_t pin, uint8_t level )
+{
+    if ( pin >= ARDUINO_NATIVE_MAX_PINS ) return;
+
+    uint8_t old = s_pin_level[pin];
+    s_pin_level[pin] = level ? HIGH : LOW;
+
+    if ( old != s_pin_level[pin] ) {
+        for ( PinListener* l : s_pin_listeners ) {
+            if ( l != nullptr ) l->pinChanged( pin, s_pin_level[pin] );
+        }
+    }
+
+    // a listener may have driven the pin back
+    level = s_pin_level[pin];
+    if ( s_isr[pin] == nullptr || ! s_irq_enabled || old == s_pin_level[pin] ) return;
+
+    int mode = s_isr_mode[pin];
+    if ( mode == CHANGE || ( mode == FALLING && level == LOW ) || ( mode == RISING && level == HIGH ) ) 
+        s_isr[pin]();
+}
+
+
+uint8_t pinLevel( uint8_t pin )
+{
+    return pin < ARDUINO_NATIVE_MAX_PINS ? s_pin_level[pin] : LOW;
+}
+
+
+uint8_t pinModeOf( uint8_t pin )
+{
+    return pin < ARDUINO_NATIVE_MAX_PINS ? s_pin_mode[pin] : INPUT;
+}
+
+
+void setPullUp( uint8_t pin, bool pull_up )
+{
+    if ( pin >= ARDUINO_NATIVE_MAX_PINS ) return;
+    s_pin_pull_up[pin]     = pull_up;
+    s_pin_driven_high[pin] = 0;
+}
+
+
+uint32_t pinDrivenHigh( uint8_t pin )
+{
+    return pin < ARDUINO_NATIVE_MAX_PINS ? s_pin_driven_high[pin] : 0;
+}
+
+
+void setInterruptsAvailable( bool available )
+{
+    s_irq_available = available;
+}
+
+
+void setLoopCount( unsigned long count )
+{
+    s_loops = count;
+}
+
+
+void setRealTime( bool real_time )
+{
+    s_real_time = real_time;
+    if ( s_real_time ) s_now = host_now();
+}
+
+} // namespace ArduinoNative
+
+
+unsigned long millis( void )
+{
+    return static_cast<unsigned long>( ArduinoNative::now() / 1000 );
+}
+
+
+unsigned long micros( void )
+{
+    return static_cast<unsigned long>( ArduinoNative::now() );
+}
+
+
+void delay( unsigned long ms )
+{
+    ArduinoNative::advance( static_cast<uint64_t>(ms) * 1000 );
+}
+
+
+void delayMicroseconds( unsigned int us )
+{
+    ArduinoNative::advance( us );
+}
+
+
+void yield( void )
+{
+    ArduinoNative::advance( s_yield_us );
+}
+
+
+void pinMode( uint8_t pin, uint8_t mode )
+{
+    if ( pin >= ARDUINO_NATIVE_MAX_PINS ) return;
+    s_pin_mode[pin] = mode;
+
+    // as on AVR : an output drives the latched level, INPUT_PULLUP sets the latch and INPUT clears it
+    if ( mode == OUTPUT ) {
+        if ( s_pin_latch[pin] == HIGH ) s_pin_driven_high[pin]++;
+        ArduinoNative::setPin( pin, s_pin_latch[pin] );
+    } else if ( mode == INPUT_PULLUP ) {
+        s_pin_latch[pin] = HIGH;
+        ArduinoNative::setPin( pin, HIGH );
+    } else {
+        s_pin_latch[pin] = LOW;
+        if ( s_pin_pull_up[pin] ) ArduinoNative::setPin( pin, HIGH );
+    }
+}
+
+
+int digitalRead( uint8_t pin )
+{
+    return ArduinoNative::pinLevel( pin );
+}
+
+
+void digitalWrite( uint8_t pin, uint8_t value )
+{
+    if ( pin >= ARDUINO_NATIVE_MAX_PINS ) return;
+    s_pin_latch[pin] = value ? HIGH : LOW;
+
+    // on an input, writing only turns the pull-up on or off
+    if ( s_pin_mode[pin] == OUTPUT ) {
+        if ( value ) s_pin_driven_high[pin]++;
+        ArduinoNative::setPin( pin, value );
+    } else if ( value ) {
+        ArduinoNative::setPin( pin, HIGH );
+    }
+}
+
+
+int digitalPinToInterrupt( uint8_t pin )
+{
+    if ( ! s_irq_available || pin >= ARDUINO_NATIVE_MAX_PINS ) return NOT_AN_INTERRUPT;
+    return pin;
+}
+
+
+void attachInterrupt( int irq, void (*isr)(void), int mode )
+{
+    if ( irq < 0 || irq >= ARDUINO_NATIVE_MAX_PINS ) return;
+    s_isr[irq]      = isr;
+    s_isr_mode[irq] = mode;
+}
+
+
+void detachInterrupt( int irq )
+{
+    if ( irq < 0 || irq >= ARDUINO_NATIVE_MAX_PINS ) return;
+    s_isr[irq] = nullptr;
+}
+
+
+void noInterrupts( void )
+{
+    s_irq_enabled = false;
+}
+
+
+void interrupts( void )
+{
+    s_irq_enabled = true;
+}
+
+
+size_t HardwareSerial::write( uint8_t c )
+{
+    return fwrite( &c, 1, 1, stdout );
+}
+
+
+size_t HardwareSerial::write( const uint8_t* buffer, size_t size )
+{
+    return fwrite( buffer, 1, size, stdout );
+}
+
+
+int __attribute__((weak)) main( void )
+{
+    setup();
+    for ( unsigned long i = 0; i < s_loops; i++ ) loop();
+    fflush( stdout );
+    return 0;
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+/**
+ * Minimal Arduino core for host (native) builds.
+ * 
+ * Time is simulated : millis() and micros() follow a virtual clock which only moves forward when the code
+ * waits (delay, delayMicroseconds, yield) or when a transaction goes over the emulated I2C bus. Emulated
+ * devices register as clock listeners so their events (e.g. the end of a conversion) happen at the exact 
+ * virtual time, which makes the tests deterministic and independent of the host speed. 
+ * 
+ * With ArduinoNative::setRealTime(true) the clock follows the host's monotonic clock and waits really sleep, 
+ * so the library can run against real hardware on a Linux host (e.g. with ADS1219LinuxI2C). 
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "Print.h"
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define LOW              0
+#define HIGH             1
+
+#define INPUT            0
+#define OUTPUT           1
+#define INPUT_PULLUP     2
+
+#define CHANGE           1
+#define FALLING          2
+#define RISING           3
+
+#define NOT_AN_INTERRUPT -1
+
+#define ARDUINO_NATIVE_MAX_PINS 64
+
+unsigned long millis( void );
+unsigned long micros( void );
+void delay( unsigned long ms );
+void delayMicroseconds( unsigned int us );
+void yield( void );
+
+void pinMode( uint8_t pin, uint8_t mode );
+int  digitalRead( uint8_t pin );
+void digitalWrite( uint8_t pin, uint8_t value );
+
+int  digitalPinToInterrupt( uint8_t pin );
+void attachInterrupt( int irq, void (*isr)(void), int mode );
+void detachInterrupt( int irq );
+void noInterrupts( void );
+void interrupts( void );
+
+void setup( void );
+void loop( void );
+
+
+namespace ArduinoNative {
+
+/**
+ * @brief Something which has to act at a given virtual time
+ */
+class ClockListener {
+public:
+    virtual ~ClockListener() {}
+
+    /**
+     * @brief Virtual time (µs) of the next event, UINT64_MAX if none
+     */
+    virtual uint64_t nextEvent( void ) = 0;
+
+    /**
+     * @brief Called when the clock reaches or passes nextEvent()
+     */
+    virtual void tick( uint64_t now ) = 0;
+};
+
+/**
+ * @brief Something which watches pins, e.g. an emulated device on bit banged bus lines
+ */
+class PinListener {
+public:
+    virtual ~PinListener() {}
+
+    /**
+     * @brief Called when the level of a pin changes, from setPin() or digitalWrite()
+     */
+    virtual void pinChanged( uint8_t pin, uint8_t level ) = 0;
+};
+
+/**
+ * @brief Current virtual time in µs
+ */
+uint64_t now( void );
+
+/**
+ * @brief Move the virtual clock forward, firing the listener events on the way
+ */
+void advance( uint64_t us );
+
+/**
+ * @brief Put the clock back to 0, e.g. between tests
+ */
+void resetClock( void );
+
+void addListener( ClockListener* listener );
+void removeListener( ClockListener* listener );
+
+void addPinListener( PinListener* listener );
+void removePinListener( PinListener* listener );
+
+/**
+ * @brief Time spent in every call to yield(), default 10 µs
+ */
+void setYieldTime( uint32_t us );
+
+/**
+ * @brief Drive an input pin from the outside (e.g. an emulated device), fires attached interrupts
+ */
+void setPin( uint8_t pin, uint8_t level );
+
+/**
+ * @brief Level written to a pin by the code under test with digitalWrite, or set with setPin
+ */
+uint8_t pinLevel( uint8_t pin );
+
+/**
+ * @brief Mode set on the pin with pinMode
+ */
+uint8_t pinModeOf( uint8_t pin );
+
+/**
+ * @brief External pull-up on a line, e.g. the bus lines : the pin reads high as an input (without its own
+ * pull-up) unless something drives it low. Also clears the pinDrivenHigh() count.
+ */
+void setPullUp( uint8_t pin, bool pull_up );
+
+/**
+ * @brief Number of times the code under test drove the pin high as an output, which must never happen on
+ * an open drain line
+ */
+uint32_t pinDrivenHigh( uint8_t pin );
+
+/**
+ * @brief Make digitalPinToInterrupt() return NOT_AN_INTERRUPT, to test polling fallbacks
+ */
+void setInterruptsAvailable( bool available );
+
+/**
+ * @brief Number of times loop() is called by main() after setup(), default 0
+ */
+void setLoopCount( unsigned long count );
+
+/**
+ * @brief Follow the host clock instead of the virtual one, waits sleep for real
+ */
+void setRealTime( bool real_time );
+
+} // namespace ArduinoNative
+
+
+class HardwareSerial : public Print {
+public:
+    void begin( unsigned long baud ) { (void) baud; }
+    size_t write( uint8_t c ) override;
+    size_t write( const uint8_t* buffer, size_t size ) override;
+    using Print::write;
+    operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
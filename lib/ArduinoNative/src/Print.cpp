@@ -0,0 +1,37 @@
+#include "Print.h"
+
+#include <stdio.h>
+
+
+size_t Print::write( const uint8_t* buffer, size_t size )
+{
+    size_t n = 0;
+    while ( size-- ) n += write( *buffer++ );
+    return n;
+}
+
+
+size_t Print::print( long value, int base )
+{
+    char buf[24];
+    if ( base == HEX ) snprintf( buf, sizeof(buf), "%lX", value );
+    else snprintf( buf, sizeof(buf), "%ld", value );
+    return write( buf );
+}
+
+
+size_t Print::print( unsigned long value, int base )
+{
+    char buf[24];
+    if ( base == HEX ) snprintf( buf, sizeof(buf), "%lX", value );
+    else snprintf( buf, sizeof(buf), "%lu", value );
+    return write( buf );
+}
+
+
+size_t Print::print( double value, int digits )
+{
+    char buf[48];
+    snprintf( buf, sizeof(buf), "%.*f", digits, value );
+    return write( buf );
+}
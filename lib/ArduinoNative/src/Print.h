@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define DEC 10
+#define HEX 16
+
+/**
+ * @brief Subset of the Arduino Print class
+ */
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write( uint8_t c ) = 0;
+    virtual size_t write( const uint8_t* buffer, size_t size );
+
+    size_t write( const char* str ) { return write( reinterpret_cast<const uint8_t*>(str), strlen(str) ); }
+
+    size_t print( const char* str ) { return write( str ); }
+    size_t print( char c ) { return write( static_cast<uint8_t>(c) ); }
+    size_t print( int value, int base = DEC ) { return print( static_cast<long>(value), base ); }
+    size_t print( unsigned int value, int base = DEC ) { return print( static_cast<unsigned long>(value), base ); }
+    size_t print( long value, int base = DEC );
+    size_t print( unsigned long value, int base = DEC );
+    size_t print( double value, int digits = 2 );
+
+    size_t println( void ) { return write( "\r\n" ); }
+    template <typename T> size_t println( T value ) { size_t n = print( value ); return n + println(); }
+    template <typename T> size_t println( T value, int format ) { size_t n = print( value, format ); return n + println(); }
+};
@@ -0,0 +1,87 @@
+#include "Wire.h"
+
+
+TwoWire Wire;
+
+
+void TwoWire::beginTransmission( uint8_t address )
+{
+    _tx_address  = address;
+    _tx_len      = 0;
+    _tx_overflow = false;
+}
+
+
+size_t TwoWire::write( uint8_t data )
+{
+    if ( _tx_len >= BUFFER_LENGTH ) {
+        _tx_overflow = true;
+        return 0;
+    }
+    _tx[_tx_len++] = data;
+    return 1;
+}
+
+
+size_t TwoWire::write( const uint8_t* data, size_t len )
+{
+    size_t n = 0;
+    while ( n < len && write( data[n] ) ) n++;
+    return n;
+}
+
+
+uint8_t TwoWire::endTransmission( bool stop )
+{
+    TwoWireDevice* dev = _tx_address < 128 ? _devices[_tx_address] : nullptr;
+
+    if ( _tx_overflow ) return 1;
+
+    if ( dev == nullptr || ! dev->i2cAck() ) {
+        // address NACK, only the address byte went over the bus
+        _account( 0, true );
+        return 2;
+    }
+
+    _account( _tx_len, stop );
+    if ( ! dev->i2cWrite( _tx, _tx_len ) ) return 3;
+
+    return 0;
+}
+
+
+uint8_t TwoWire::requestFrom( uint8_t address, uint8_t quantity, uint8_t stop )
+{
+    TwoWireDevice* dev = address < 128 ? _devices[address] : nullptr;
+
+    _rx_len = 0;
+    _rx_pos = 0;
+
+    if ( quantity > BUFFER_LENGTH ) quantity = BUFFER_LENGTH;
+
+    if ( dev == nullptr || ! dev->i2cAck() ) {
+        _account( 0, true );
+        return 0;
+    }
+
+    _account( quantity, stop );
+    _rx_len = static_cast<uint8_t>( dev->i2cRead( _rx, quantity ) );
+
+    return _rx_len;
+}
+
+
+void TwoWire::_account( size_t bytes, bool stop )
+{
+    // START (or repeated START) + address byte + data bytes, 9 clocks each, + STOP
+    // a STOP is followed by a bus free time of roughly one clock period
+    uint32_t clocks = 1 + 9 * ( 1 + bytes ) + ( stop ? 2 : 0 );
+
+    uint64_t us = ( static_cast<uint64_t>(clocks) * 1000000ULL + _frequency - 1 ) / _frequency;
+
+    _transactions++;
+    _bytes       += bytes;
+    _bus_time_us += us;
+
+    ArduinoNative::advance( us );
+}
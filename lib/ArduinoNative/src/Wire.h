@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Same transmit/receive buffer size as the AVR Wire library
+#define BUFFER_LENGTH 32
+
+
+/**
+ * @brief Emulated device on the TwoWire bus
+ */
+class TwoWireDevice {
+public:
+    virtual ~TwoWireDevice() {}
+
+    /**
+     * @brief A master write addressed to this device
+     * 
+     * @return false to NACK the data
+     */
+    virtual bool i2cWrite( const uint8_t* data, size_t len ) = 0;
+
+    /**
+     * @brief A master read addressed to this device
+     * 
+     * @return number of bytes provided
+     */
+    virtual size_t i2cRead( uint8_t* data, size_t len ) = 0;
+
+    /**
+     * @brief Whether the device acknowledges its address, e.g. to inject bus faults
+     */
+    virtual bool i2cAck( void ) { return true; }
+};
+
+
+/**
+ * @brief Host stand-in for the Arduino TwoWire class
+ * 
+ * Transactions are routed to the TwoWireDevice attached at the address, the bus time of every transaction 
+ * is added to the virtual clock based on the bus clock (default 100 kHz), 9 clocks per byte plus the 
+ * START and STOP conditions. A repeated start saves the STOP and the bus idle time.
+ */
+class TwoWire {
+public:
+    constexpr TwoWire() {}
+
+    void begin( void ) {}
+    void end( void ) {}
+    void setClock( uint32_t frequency ) { _frequency = frequency; }
+
+    void    beginTransmission( uint8_t address );
+    size_t  write( uint8_t data );
+    size_t  write( const uint8_t* data, size_t len );
+    uint8_t endTransmission( bool stop = true );
+
+    uint8_t requestFrom( uint8_t address, uint8_t quantity, uint8_t stop = true );
+    int     available( void ) { return _rx_len - _rx_pos; }
+    int     read( void ) { return _rx_pos < _rx_len ? _rx[_rx_pos++] : -1; }
+
+    /**
+     * @brief Attach an emulated device at the given 7 bit address, nullptr to remove
+     */
+    void attach( uint8_t address, TwoWireDevice* device ) { if ( address < 128 ) _devices[address] = device; }
+
+    /**
+     * @brief Number of transactions (address phases) since the last resetCounters()
+     */
+    uint32_t transactions( void ) const { return _transactions; }
+
+    /**
+     * @brief Bytes moved, excluding address bytes, since the last resetCounters()
+     */
+    uint32_t bytes( void ) const { return _bytes; }
+
+    /**
+     * @brief Time the bus was busy since the last resetCounters(), in µs
+     */
+    uint64_t busTime( void ) const { return _bus_time_us; }
+
+    void resetCounters( void ) { _transactions = 0; _bytes = 0; _bus_time_us = 0; }
+
+private:
+    void _account( size_t bytes, bool stop );
+
+    TwoWireDevice* _devices[128] = {};
+
+    uint8_t  _tx[BUFFER_LENGTH] = {};
+    uint8_t  _tx_len        = 0;
+    uint8_t  _tx_address    = 0;
+    bool     _tx_overflow   = false;
+
+    uint8_t  _rx[BUFFER_LENGTH] = {};
+    uint8_t  _rx_len        = 0;
+    uint8_t  _rx_pos        = 0;
+
+    uint32_t _frequency     = 100000;
+
+    uint32_t _transactions  = 0;
+    uint32_t _bytes         = 0;
+    uint64_t _bus_time_us   = 0;
+};
+
+extern TwoWire Wire;
@@ -1,32 +1,94 @@
 #include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Filter.h"
+#include "ADS1219Window.h"
 
 
+ADS1219* ADS1219::_drdy_devices[ADS1219_MAX_DRDY_IRQ] = { nullptr, nullptr, nullptr, nullptr };
+
 ADS1219::ADS1219(uint8_t i2c_addr, uint8_t drdy_pin, TwoWire* wire)
+    : ADS1219(nullptr, wire, i2c_addr, drdy_pin)
+{
+}
+
+
+ADS1219::ADS1219(ADS1219Bus& bus, uint8_t i2c_addr, uint8_t drdy_pin)
+    : ADS1219(&bus, nullptr, i2c_addr, drdy_pin)
+{
+}
+
+
+ADS1219::ADS1219(ADS1219Bus* bus, TwoWire* wire, uint8_t i2c_addr, uint8_t drdy_pin)
     : _i2c_addr(i2c_addr)
     , _drdy_pin(drdy_pin)
-    , _wire(wire)
+    , _ready_mode(ADS1219_READY_STATUS)
+    , _drdy_slot(-1)
+    , _drdy_count(0)
+    , _wire_bus(wire)
+    , _bus(bus != nullptr ? bus : &_wire_bus)
+    , _begun(false)
     , _timeout_ms(100UL)
     , _aref_n(0.f)
     , _aref_p(2048.f)
+    , _conv_state(ADS1219_STATE_IDLE)
+    , _conv_mux(0)
+    , _conv_start_us(0)
+    , _conv_end_us(0)
+    , _conv_time_us(0)
+    , _conv_poll_us(0)
+    , _conv_miss_us(0)
+    , _conv_rate(ADS1219_DATARATE_20SPS)
+    , _adaptive(false)
+    , _streaming(false)
+    , _stream_filter(nullptr)
+    , _overruns(0)
+    , _window_pass(true)
+    , _config(0x00)
+    , _config_valid(false)
+    , _config_written(0x00)
+    , _replay_pending(false)
+    , _verify(false)
+    , _repeated_start(ADS1219_REPEATED_START)
+    , _retries(0)
+    , _deadline_us(0)
+    , _auto_recover(false)
+    , _offset_correction(false)
+    , _offset_valid(0)
+    , _offset_every(0)
+    , _offset_scans(0)
+    , _offset_every_us(0)
+    , _offset_last_us(0)
+    , _offset_shift(3)
+    , _offset_turn(0)
+    , _offset_due(false)
+    , _offset_refreshes(0)
 {
+    for ( uint8_t i = 0; i < 4; i++ ) _learned[i] = 0;
+    for ( uint8_t i = 0; i < 8; i++ ) _windows[i] = nullptr;
+    resetStats();
+    resetRecovery();
+    _update_scale();
 }
 
 
 ADS1219::~ADS1219()
 {
+    _detach_drdy();
 }
 
 
 void ADS1219::begin( void )
 {
-    _wire->begin();
+    _bus->begin();
     _begun = true;
 
-#ifdef ARDUINO_ARCH_SAMD
-    _maxBufferSize = 256; // and not 250 as in Adafruit_I2CDevice.cpp ?
-#else
-    _maxBufferSize = 32;  // see buffer size in Wire.h for other architectures
-#endif
+    // set up the DRDY pin, if any, or else use the DRDY line of the bus backend, if it has one
+    if ( _drdy_pin != 0 && _ready_mode == ADS1219_READY_STATUS ) _attach_drdy();
+    else if ( _drdy_pin == 0 && _bus->hasDrdy() ) _ready_mode = ADS1219_READY_BUS;
+
+    // load the shadow copy of the config register, if this fails (no device), the
+    // copy stays invalid and is reloaded on the next access
+    syncConfig();
 
     return;
 }
@@ -36,21 +98,85 @@ bool ADS1219::detect( void )
 {
     if (!_begun) return false;
 
-    _wire->beginTransmission(_i2c_addr);
-    if (_wire->endTransmission() == 0) return true;
-
-    return false;   
+    // an empty write only checks for the address acknowledge
+    return _bus->write(_i2c_addr, nullptr, 0) == ADS1219_OK;
 }
 
 
 uint8_t ADS1219::reset(void)
 {
-    return send_cmd(ADS1219_CMD_RESET);
+    uint8_t code = send_cmd(ADS1219_CMD_RESET);
+    if ( code != ADS1219_OK ) {
+        _config_valid = false;
+        return code;
+    }
+
+    // the reset puts all registers back to their default (0x00), which also means internal reference
+    _aref_n       = 0.;
+    _aref_p       = 2048.;
+    _set_config( 0x00 );
+    _config_written = 0x00;
+    _replay_pending = false;
+    _update_scale();
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219::recover(void)
+{
+    unsigned long tstart = micros();
+
+    // the last configuration written successfully, not the shadow copy : a failed write or a previous
+    // recovery which didn't get to the replay leave the shadow copy out of date
+    uint8_t config = _config_written;
+    float   aref_n = _aref_n;
+    float   aref_p = _aref_p;
+
+    if ( _bus->clear() ) _recovery.bus_clears++;
+    _conv_state = ADS1219_STATE_IDLE;
+
+    // reset() puts the defaults in the shadow copy, the replay target stays until it is written
+    uint8_t code = reset();
+    _config_written = config;
+    if ( code == ADS1219_OK ) 
+    {
+        _aref_n = aref_n;
+        _aref_p = aref_p;
+        if ( config != _config ) code = _write_register( config );
+        _update_scale();
+
+        // continuous conversions only start with a START
+        if ( code == ADS1219_OK && _streaming ) code = start();
+    }
+    if ( code == ADS1219_OK ) _recovery.resets++;
+
+    // until the configuration is back, register changes build on it and not on the defaults in the device
+    _replay_pending = code != ADS1219_OK;
+
+    unsigned long us = micros() - tstart;
+    if ( us > _recovery.recover_max_us ) _recovery.recover_max_us = us;
+
+    return code;
+}
+
+
+void ADS1219::resetRecovery( void )
+{
+    memset( &_recovery, 0, sizeof(ADS1219Recovery) );
+}
+
+
+bool ADS1219::_try_recover( uint8_t code )
+{
+    return _auto_recover && ads1219_bus_error( code ) && recover() == ADS1219_OK;
 }
 
 
 uint8_t ADS1219::start(void)
 {
+    // forget about earlier DRDY edges, we want the ones from this conversion
+    _drdy_count = 0;
     return send_cmd(ADS1219_CMD_START_SYNC);
 }
 
@@ -61,10 +187,81 @@ uint8_t ADS1219::powerDown(void)
 }
 
 
+uint8_t ADS1219::syncConfig(void)
+{
+    uint8_t code, data;
+    code = _read_register( ADS1219_CMD_RREG_CONFIG, &data );
+    if ( code != ADS1219_OK ) {
+        _config_valid = false;
+        return code;
+    }
+
+    _set_config( data );
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219::getConfig( uint8_t* config )
+{
+    return _get_config(config);
+}
+
+
+uint8_t ADS1219::applyConfig( const ADS1219Config& config )
+{
+    uint8_t code;
+
+    // validate everything before touching the bus
+    if ( ! ads1219_valid_mux( config.mux ) ) return ADS1219_INVALID_MUX;
+    if ( config.gain != ADS1219_GAIN_ONE && config.gain != ADS1219_GAIN_FOUR ) return ADS1219_INVALID_GAIN;
+    if ( config.rate > ADS1219_DATARATE_1000SPS ) return ADS1219_INVALID_DATARATE;
+    if ( config.mode > ADS1219_CM_CONTINUOUS ) return ADS1219_INVALID_CM;
+    if ( config.vref > ADS1219_VREF_EXTERNAL ) return ADS1219_INVALID_VREF;
+    if ( config.vref == ADS1219_VREF_EXTERNAL && ! ( config.aref_p > config.aref_n ) ) return ADS1219_INVALID_VREF;
+
+    uint8_t reg = config.reg();
+
+    // one WREG, unless the device already has this configuration
+    if ( ! _config_valid || _replay_pending || reg != _config ) {
+        code = _write_register( reg );
+        if ( code != ADS1219_OK ) return code;
+    }
+
+    if ( config.vref == ADS1219_VREF_EXTERNAL ) {
+        _aref_n = config.aref_n;
+        _aref_p = config.aref_p;
+    } else {
+        _aref_n = 0.;
+        _aref_p = 2048.;
+    }
+    _update_scale();
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219::readConfig( ADS1219Config* config )
+{
+    uint8_t code = syncConfig();
+    if ( code != ADS1219_OK ) return code;
+
+    config->mux    = _config & ~ADS1219_CONFIG_MASK_MUX;
+    config->gain   = ( _config & ~ADS1219_CONFIG_MASK_GAIN ) ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE;
+    config->rate   = ( _config & ~ADS1219_CONFIG_MASK_DR ) >> 2;
+    config->mode   = ( _config & ~ADS1219_CONFIG_MASK_CM ) >> 1;
+    config->vref   = _config & ~ADS1219_CONFIG_MASK_VREF;
+    config->aref_n = _aref_n;
+    config->aref_p = _aref_p;
+
+    return ADS1219_OK;
+}
+
+
 uint8_t ADS1219::getGain(uint8_t* gain )
 {
     uint8_t code, r;
-    code = _read_register( ADS1219_CMD_RREG_CONFIG, &r );
+    code = _get_config( &r );
     if ( code != ADS1219_OK ) return code;
 
     // mask the gain bit (place 4)
@@ -79,19 +276,16 @@ uint8_t ADS1219::getGain(uint8_t* gain )
 
 uint8_t ADS1219::setGain( uint8_t gain )
 {
-    uint8_t value;
-    if ( gain == ADS1219_GAIN_ONE ) value = 0;
-    else if ( gain == ADS1219_GAIN_FOUR ) value = (1 << 4);
-    else return ADS1219_INVALID_GAIN;
+    if ( gain != ADS1219_GAIN_ONE && gain != ADS1219_GAIN_FOUR ) return ADS1219_INVALID_GAIN;
 
-    return _modify_register(value, ADS1219_CONFIG_MASK_GAIN);
+    return _modify_register(ads1219_gain_bits(gain), ADS1219_CONFIG_MASK_GAIN);
 }
 
 
 uint8_t ADS1219::getVREF( uint8_t* type )
 {    
     uint8_t code, r;
-    code = _read_register( ADS1219_CMD_RREG_CONFIG, &r );
+    code = _get_config( &r );
     if ( code != ADS1219_OK ) return code;
 
     if ( r & ~ADS1219_CONFIG_MASK_VREF )
@@ -123,6 +317,7 @@ uint8_t ADS1219::setVREF( uint8_t type, float aref_n, float aref_p )
             _aref_n = 0.;
             _aref_p = 2048.;
         }
+        _update_scale();
     }
 
     return err_code;
@@ -132,7 +327,7 @@ uint8_t ADS1219::setVREF( uint8_t type, float aref_n, float aref_p )
 uint8_t ADS1219::getDataRate( uint8_t* rate)
 {
     uint8_t code, r;
-    code = _read_register( ADS1219_CMD_RREG_CONFIG, &r );
+    code = _get_config( &r );
     if ( code != ADS1219_OK ) return code;
 
     *rate = ( r & ~ADS1219_CONFIG_MASK_DR ) >> 2;
@@ -158,7 +353,7 @@ uint8_t ADS1219::setConversionMode( uint8_t mode )
 uint8_t ADS1219::getConversionMode( uint8_t* mode )
 {
     uint8_t code, r;
-    code = _read_register( ADS1219_CMD_RREG_CONFIG, &r );
+    code = _get_config( &r );
     if ( code != ADS1219_OK ) return code;
 
     *mode = ( r & ~ADS1219_CONFIG_MASK_CM ) >> 1;
@@ -169,28 +364,63 @@ uint8_t ADS1219::getConversionMode( uint8_t* mode )
 
 uint16_t ADS1219::getConversionTime( void )
 {
-    // we will round the conversion times to the next integer ms in the readout code below !
-    // see specs table 4. 
+    // single-shot time of table 4 in the specs, rounded up to the next ms
     uint8_t rate;
-    if ( getDataRate(&rate) ) return 50; // return largest value if error is encountered 
-    switch( rate ) 
-    {
-        case ADS1219_DATARATE_20SPS:
-            return 50;
-        case ADS1219_DATARATE_90SPS:
-            return 1;
-        case ADS1219_DATARATE_330SPS:
-            return 3;
-        case ADS1219_DATARATE_1000SPS:
-            return 1;
-        default:
-            return 50;
+    if ( getDataRate(&rate) ) rate = ADS1219_DATARATE_20SPS; // return largest value if error is encountered 
+    return ( ads1219_conversion_us( rate ) + 999UL ) / 1000UL;
+}
+
+
+unsigned long ADS1219::getConversionTimeMicros( void )
+{
+    uint8_t config;
+    if ( _get_config( &config ) ) config = 0x00; // 20 SPS if error is encountered
+    return _expected_us( config );
+}
+
+
+unsigned long ADS1219::_expected_us( uint8_t config )
+{
+    uint8_t rate = ( config & ~ADS1219_CONFIG_MASK_DR ) >> 2;
+    uint8_t mode = ( config & ~ADS1219_CONFIG_MASK_CM ) >> 1;
+
+    unsigned long us = ads1219_conversion_us( rate, mode );
+    if ( ! _adaptive || _learned[rate] == 0 ) return us;
+
+    // only single-shot conversions are learned, continuous ones lack the START latency
+    us = learnedConversionTime( rate );
+    if ( mode == ADS1219_CM_CONTINUOUS ) us -= ads1219_conversion_us( rate ) - ads1219_conversion_us( rate, mode );
+    return us;
+}
+
+
+void ADS1219::_learn( uint8_t rate, unsigned long miss_us, unsigned long ready_us )
+{
+    // all in 1/16 µs, the estimate starts from the specs
+    int32_t est    = _learned[rate] ? _learned[rate] : ads1219_conversion_us( rate ) << 4;
+    int32_t margin = est >> 7;
+    int32_t miss   = static_cast<int32_t>( miss_us ) << 4;
+    int32_t ready  = static_cast<int32_t>( ready_us ) << 4;
+
+    if ( miss_us != 0 && ready - miss <= est >> 4 ) {
+        // tight bracket (DRDY pin or a fast bus), move towards the middle of it
+        est += ( ( miss + ready ) / 2 - est ) >> 3;
+    } else if ( miss_us != 0 ) {
+        // checked too early, the conversion takes at least until the miss
+        if ( miss + margin > est ) est += ( miss + margin - est ) >> 2;
+    } else if ( ready <= est + 2 * margin ) {
+        // ready at the first check, which was on time : try a little earlier next time
+        est -= est >> 12;
     }
+
+    _learned[rate] = est;
 }
 
+
 bool ADS1219::conversionReady( uint8_t* err_code )
 {
     uint8_t stat;
+    ADS1219_STAT( _stats.ready_polls++; )
     *err_code = _read_register( ADS1219_CMD_RREG_STATUS, &stat );
     if ( *err_code != ADS1219_OK ) return false;
 
@@ -198,6 +428,22 @@ bool ADS1219::conversionReady( uint8_t* err_code )
 }
 
 
+bool ADS1219::drdyReady( void )
+{
+    switch( _ready_mode )
+    {
+        case ADS1219_READY_DRDY_IRQ:
+            return _drdy_count > 0;
+        case ADS1219_READY_DRDY_POLL:
+            return digitalRead(_drdy_pin) == LOW; // DRDY is active low
+        case ADS1219_READY_BUS:
+            return _bus->drdyReady();
+        default:
+            return false;
+    }
+}
+
+
 
 int32_t ADS1219::readSingleEnded( uint8_t channel, uint8_t* err_code, uint16_t offset_samples )
 {
@@ -226,19 +472,326 @@ int32_t ADS1219::readSingleEnded( uint8_t channel, uint8_t* err_code, uint16_t o
             return 0x80000000;
     }
 
+    if ( offset_samples == 0 ) return _offset_correct( _readout( mux, err_code ) );
+
     return _readout(mux, err_code ) - offset; // subtract offset, is 0 in case we don't want
 }
 
 int32_t ADS1219::readShorted(uint8_t* err_code, uint16_t samples )
 {
-    int32_t offset = 0;
+    if ( samples <= 1 ) return _readout( ADS1219_MUX_SHORTED, err_code );
+
+    // read offset and calculate the average over the samples
+    ADS1219Oversample r;
+    *err_code = oversample( ADS1219_MUX_SHORTED, samples, &r );
+    if ( r.valid == 0 ) return 0x80000000;
+
+    return r.mean;
+}
+
+
+uint8_t ADS1219::calibrateOffset( uint16_t samples )
+{
+    uint8_t code;
+    int32_t value = readShorted( &code, samples );
+
+    // a clipped shorted input is no offset
+    if ( code != ADS1219_OK ) return code;
+
+    _offset_update( value, true );
+    return ADS1219_OK;
+}
+
+
+bool ADS1219::cachedOffset( uint8_t rate, uint8_t gain, int32_t* offset ) const
+{
+    uint8_t slot = ( ( ads1219_gain_bits( gain ) | ( ( rate & 0x03 ) << 2 ) ) >> 2 ) & 0x07;
+    if ( ! ( _offset_valid & ( 1 << slot ) ) ) return false;
+
+    *offset = static_cast<int32_t>( ( static_cast<int64_t>( _offset_q8[slot] ) + 128 ) >> 8 );
+    return true;
+}
+
+
+void ADS1219::setOffsetRefresh( uint16_t every_scans, unsigned long every_us, uint8_t shift )
+{
+    _offset_every    = every_scans;
+    _offset_every_us = every_us;
+    _offset_shift    = shift > 15 ? 15 : shift;
+    _offset_scans    = 0;
+    _offset_last_us  = micros();
+}
+
+
+void ADS1219::_offset_update( int32_t value, bool replace )
+{
+    // the slot of the gain and data rate the conversion ran at, which are still in the register
+    uint8_t slot = ( _config >> 2 ) & 0x07;
+    int64_t q8   = static_cast<int64_t>( value ) << 8;
+
+    if ( replace || ! ( _offset_valid & ( 1 << slot ) ) ) {
+        _offset_q8[slot] = static_cast<int32_t>( q8 );
+        _offset_valid   |= 1 << slot;
+    } else {
+        _offset_q8[slot] += static_cast<int32_t>( ( q8 - _offset_q8[slot] ) / ( 1 << _offset_shift ) );
+    }
+}
+
+
+int32_t ADS1219::_offset_correct( int32_t value )
+{
+    if ( ! _offset_correction || value == static_cast<int32_t>(0x80000000) ) return value;
+
+    uint8_t slot = ( _config >> 2 ) & 0x07;
+    if ( ! ( _offset_valid & ( 1 << slot ) ) ) return value;
+
+    return value - static_cast<int32_t>( ( static_cast<int64_t>( _offset_q8[slot] ) + 128 ) >> 8 );
+}
+
+
+void ADS1219::_offset_refresh( ADS1219ScanPlan& plan )
+{
+    uint8_t used = 0, code;
+
+    // the gains of this scan, and whether any of them has no offset yet
+    uint8_t rate_bits = _config & ~ADS1219_CONFIG_MASK_DR;
+    bool missing = false;
+    for ( uint8_t i = 0; i < plan.size(); i++ ) {
+        uint8_t g = plan._gain[i] == ADS1219_GAIN_FOUR ? 1 : 0;
+        used |= 1 << g;
+        if ( ! ( _offset_valid & ( 1 << ( ( ( rate_bits | ads1219_gain_bits( plan._gain[i] ) ) >> 2 ) & 0x07 ) ) ) ) missing = true;
+    }
+    if ( used == 0 ) return;
+
+    _offset_scans++;
+    bool due = missing || _offset_due 
+            || ( _offset_every > 0 && _offset_scans >= _offset_every )
+            || ( _offset_every_us > 0 && micros() - _offset_last_us >= _offset_every_us );
+    if ( ! due ) return;
+
+    // one gain per refresh, in turns when the scan uses both
+    uint8_t gain = used == 0x03 ? ( ( _offset_turn++ & 1 ) ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE ) 
+                                : ( used == 0x02 ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE );
+
+    uint8_t gain_bits = _config & ~ADS1219_CONFIG_MASK_GAIN;
+    code = _modify_register( ads1219_gain_bits( gain ), ADS1219_CONFIG_MASK_GAIN );
+    if ( code != ADS1219_OK ) return;
+
+    int32_t value = _readout( ADS1219_MUX_SHORTED, &code );
+    _offset_refreshes++;
+
+    // the slot is that of the refresh gain, then the gain goes back to what the scan left
+    if ( code == ADS1219_OK ) _offset_update( value, false );
+    _modify_register( gain_bits, ADS1219_CONFIG_MASK_GAIN );
+    if ( code != ADS1219_OK ) return;
+
+    _offset_scans   = 0;
+    _offset_last_us = micros();
+    _offset_due     = false;
+}
+
+
+void ADS1219::toMicroVolts(const int32_t* counts, int32_t* out, size_t n)
+{
+    const int64_t scale = _uv_scale;
+    for ( size_t i = 0; i < n; i++ ) {
+        // add a half and floor (arithmetic shift), i.e. round half up
+        out[i] = static_cast<int32_t>( ( counts[i] * scale + ( static_cast<int64_t>(1) << 31 ) ) >> 32 );
+    }
+}
+
+
+void ADS1219::toMilliVolts(const int32_t* counts, float* out, size_t n)
+{
+    const float scale = _mv_scale;
+    for ( size_t i = 0; i < n; i++ ) out[i] = counts[i] * scale;
+}
+
+
+uint8_t ADS1219::startStream( uint8_t mux, uint8_t rate, ADS1219Filter* filter )
+{
+    uint8_t code;
+
+    if ( _conv_state != ADS1219_STATE_IDLE ) return ADS1219_BUSY;
+    if ( ! ads1219_valid_mux( mux ) ) return ADS1219_INVALID_MUX;
+    if ( rate > 3 ) return ADS1219_INVALID_DATARATE;
+
+    // mux, rate and continuous mode in one go
+    code = _modify_register( mux | ( rate << 2 ) | ( ADS1219_CM_CONTINUOUS << 1 ), 
+        ADS1219_CONFIG_MASK_MUX & ADS1219_CONFIG_MASK_DR & ADS1219_CONFIG_MASK_CM );
+    if ( code != ADS1219_OK ) return code;
+
+    _streaming = false;
+    _stream.clear();
+    _overruns  = 0;
+    _stream_filter = filter;
+    if ( _stream_filter != nullptr ) _stream_filter->reset();
+
+    code = start();
+    if ( code != ADS1219_OK ) return code;
+
+    _streaming = true;
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219::stopStream( void )
+{
+    _streaming = false;
+    return setConversionMode( ADS1219_CM_SINGLE_SHOT );
+}
+
+
+uint8_t ADS1219::serviceStream( void )
+{
+    uint8_t code = ADS1219_OK;
+
+    if ( ! _streaming ) return ADS1219_OK;
+
+    if ( _ready_mode == ADS1219_READY_DRDY_IRQ ) 
+    {
+        // read and clear together, an edge in between would be neither read nor counted
+        noInterrupts();
+        uint8_t pending = _drdy_count;
+        _drdy_count = 0;
+        interrupts();
+        if ( pending == 0 ) return ADS1219_OK;
+
+        // every edge is a conversion, we only get the last one
+        _overruns += pending - 1;
+    } 
+    else if ( _ready_mode == ADS1219_READY_DRDY_POLL || _ready_mode == ADS1219_READY_BUS ) 
+    {
+        if ( ! drdyReady() ) return ADS1219_OK;
+    }
+    else 
+    {
+        if ( ! conversionReady( &code ) ) return code;
+    }
+
+    // bus errors return a value outside the 24 bit range
+    int32_t value = _read_value( &code );
+    if ( value == static_cast<int32_t>(0x80000000) ) return code;
+
+    // over/underflows are valid (clipped) samples, keep them but pass on the code
+    if ( _stream_filter != nullptr && ! _stream_filter->filter( value, &value ) ) return code;
+    if ( ! _window_pass ) return code;
+    if ( ! _stream.push( value ) ) _overruns++;
+
+    return code;
+}
+
+
+uint8_t ADS1219::setWindow( uint8_t mux, ADS1219Window* window )
+{
+    if ( ! ads1219_valid_mux( mux ) ) return ADS1219_INVALID_MUX;
+
+    if ( window != nullptr ) window->setReference( _aref_p - _aref_n );
+    _windows[ mux >> 5 ] = window;
+
+    return ADS1219_OK;
+}
+
+
+size_t ADS1219::readBuffered( int32_t* out, size_t n )
+{
+    size_t i = 0;
+    while ( i < n && _stream.pop( &out[i] ) ) i++;
+    return i;
+}
+
+
+// division rounding to the nearest integer, halves up, also for negative numerators
+static int64_t ads1219_round_div( int64_t num, int64_t den )
+{
+    int64_t n = 2 * num + den;
+    int64_t d = 2 * den;
+    int64_t q = n / d;
+    if ( ( n % d != 0 ) && ( n < 0 ) ) q--;  // floor
+    return q;
+}
+
+
+uint8_t ADS1219::oversample( uint8_t mux, uint16_t samples, ADS1219Oversample* result, uint8_t extra_bits )
+{
+    uint8_t code, config, status = ADS1219_OK;
+
+    result->mean  = result->value = 0;
+    result->min   = result->max = 0;
+    result->valid = 0;
+    result->extra_bits = extra_bits > 7 ? 7 : extra_bits;
+
+    if ( _conv_state != ADS1219_STATE_IDLE || _streaming ) return ADS1219_BUSY;
+    if ( ! ads1219_valid_mux( mux ) ) return ADS1219_INVALID_MUX;
+    if ( samples == 0 ) return ADS1219_OK;
+
+    code = _get_config( &config );
+    if ( code != ADS1219_OK ) return code;
+
+    // mux and continuous mode in one register write, then one START for all samples
+    code = _modify_register( mux | ( ADS1219_CM_CONTINUOUS << 1 ), ADS1219_CONFIG_MASK_MUX & ADS1219_CONFIG_MASK_CM );
+    if ( code != ADS1219_OK ) return code;
+
+    code = start();
+
+    // the first conversion takes the single-shot time, the others follow at the continuous rate
+    unsigned long ct_us    = _expected_us( ( config & ADS1219_CONFIG_MASK_CM ) | ( ADS1219_CM_CONTINUOUS << 1 ) );
+    unsigned long first_us = _expected_us( config & ADS1219_CONFIG_MASK_CM );
+    unsigned long tstart   = micros();
+    _conv_start_us = tstart;
+
+    int64_t  sum = 0;
+    for ( uint16_t i = 0; i < samples && code == ADS1219_OK; i++ ) 
+    {
+        // on an absolute timeline, so the oscillator tolerance doesn't add up from sample to sample
+        unsigned long due = first_us + i * ct_us;
+        code = _wait_conversion( tstart + due + _margin_us( due ), ct_us );
+        if ( code != ADS1219_OK ) break;
+        _conv_end_us = micros();
+
+        int32_t v = _read_value( &code );
+        if ( code == ADS1219_ADC_OVERFLOW || code == ADS1219_ADC_UNDERFLOW ) {
+            status = code;
+            code   = ADS1219_OK;
+        } else if ( code != ADS1219_OK ) {
+            break;
+        }
+
+        sum += v;
+        if ( result->valid == 0 || v < result->min ) result->min = v;
+        if ( result->valid == 0 || v > result->max ) result->max = v;
+        result->valid++;
+    }
+    if ( code != ADS1219_OK ) status = code;
+
+    // back to the original conversion mode, which also stops the continuous conversions
+    if ( ! ( config & ~ADS1219_CONFIG_MASK_CM ) ) {
+        code = _modify_register( 0, ADS1219_CONFIG_MASK_CM );
+        if ( status == ADS1219_OK ) status = code;
+    }
 
-    // read offset and caluclate cumulative average over offset_cycles samples
-    for ( uint16_t i = 0; i < samples; i++ ) {
-        offset = ( _readout(ADS1219_MUX_SHORTED, err_code ) + i * offset ) / ( i + 1 );
+    uint16_t n = result->valid;
+    if ( n == 0 ) return status;
+
+    if ( ( n & ( n - 1 ) ) == 0 ) 
+    {
+        // power of two : decimate with a rounding shift
+        uint8_t shift = 0;
+        while ( ( 1U << shift ) < n ) shift++;
+        result->mean = static_cast<int32_t>( shift ? ( sum + ( static_cast<int64_t>(1) << ( shift - 1 ) ) ) >> shift : sum );
+
+        int8_t s = shift - result->extra_bits;
+        if ( s > 0 ) result->value = static_cast<int32_t>( ( sum + ( static_cast<int64_t>(1) << ( s - 1 ) ) ) >> s );
+        else result->value = static_cast<int32_t>( sum * ( static_cast<int64_t>(1) << -s ) );
+    } 
+    else 
+    {
+        result->mean  = static_cast<int32_t>( ads1219_round_div( sum, n ) );
+        result->value = static_cast<int32_t>( ads1219_round_div( sum * ( static_cast<int64_t>(1) << result->extra_bits ), n ) );
     }
 
-    return offset;
+    return status;
 }
 
 
@@ -255,40 +808,373 @@ float ADS1219::milliVolts(int32_t adc_count, uint8_t gain, uint8_t* err_code)
 
 int32_t ADS1219::_readout( uint8_t mux, uint8_t* err_code )
 {
-    bool ready = false;
+    ADS1219Sample sample;
+    ADS1219_STAT( unsigned long tstart = micros(); )
+
+    for ( uint8_t attempt = 0; ; attempt++ ) 
+    {
+        *err_code = beginConversion( mux );
+        if ( *err_code ) {
+            _conv_start_us = _conv_end_us = micros();
+            sample.value = 0x80000000;
+        } else {
+            // wait for the result, the state machine takes care of not hammering the bus
+            while( ! poll( &sample ) ) {
+                yield();
+            }
+            *err_code = sample.err_code;
+        }
+
+        // a bus error which survived the retries : once more after a recovery
+        if ( attempt > 0 || ! _try_recover( *err_code ) ) break;
+    }
+    ADS1219_STAT( _stats_hist( _stats.readout_us, micros() - tstart ); )
+
+    return sample.value;
+}
+
+
+uint8_t ADS1219::scan( ADS1219ScanPlan& plan, int32_t* results, uint8_t* err_codes )
+{
+    uint8_t status = ADS1219_OK;
+
+    // the entries would rewrite the multiplexer and gain under the conversion in progress
+    if ( _conv_state != ADS1219_STATE_IDLE || _streaming ) return ADS1219_BUSY;
+
+    unsigned long tstart = micros();
+
+    for ( uint8_t i = 0; i < plan.size(); i++ ) 
+    {
+        const ADS1219ScanEntry& e = plan.entry(i);
+        uint8_t code;
+        uint8_t gain = e.gain == ADS1219_GAIN_AUTO ? plan._next_gain[i] : e.gain;
+
+        results[i] = _scan_entry( e, gain, &code );
+
+        if ( e.gain == ADS1219_GAIN_AUTO ) {
+            // clipped at gain 4 : the only case worth a second conversion
+            if ( gain == ADS1219_GAIN_FOUR && ( code == ADS1219_ADC_OVERFLOW || code == ADS1219_ADC_UNDERFLOW ) ) {
+                gain = ADS1219_GAIN_ONE;
+                results[i] = _scan_entry( e, gain, &code );
+                plan._redos++;
+                plan._switches++;
+            }
+            if ( code == ADS1219_OK || code == ADS1219_ADC_OVERFLOW || code == ADS1219_ADC_UNDERFLOW ) {
+                plan._next_gain[i] = ads1219_autorange( gain, results[i] );
+                if ( plan._next_gain[i] != gain ) plan._switches++;
+            }
+        } else if ( gain == ADS1219_GAIN_KEEP ) {
+            gain = ( _config & ~ADS1219_CONFIG_MASK_GAIN ) ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE;
+        }
+        plan._entry_start_us[i] = _conv_start_us;
+        plan._entry_end_us[i]   = _conv_end_us;
+
+        // the register still holds the gain and data rate of the conversion
+        if ( e.mux != ADS1219_MUX_SHORTED ) results[i] = _offset_correct( results[i] );
+
+        // a filter would see a gain switch as a step, so it starts afresh
+        if ( e.filter != nullptr && gain != plan._gain[i] ) e.filter->reset();
+        plan._gain[i] = gain;
+
+        // bus errors don't go through the filter, clipped values do
+        if ( e.filter != nullptr && results[i] != static_cast<int32_t>(0x80000000) ) {
+            if ( ! e.filter->filter( results[i], &results[i] ) ) {
+                results[i] = e.filter->last();
+                if ( code == ADS1219_OK ) code = ADS1219_FILTER_PENDING;
+            }
+        }
+
+        if ( err_codes != nullptr ) err_codes[i] = code;
+        if ( status == ADS1219_OK && code != ADS1219_FILTER_PENDING ) status = code;
+    }
+
+    if ( _offset_every > 0 || _offset_every_us > 0 || _offset_due ) _offset_refresh( plan );
+
+    plan._duration_us = micros() - tstart;
+    ADS1219_STAT( _stats_hist( _stats.scan_us, plan._duration_us ); )
+    plan._period_us   = tstart - plan._start_us;
+    plan._start_us    = tstart;
+    plan._scans++;
+
+    return status;
+}
+
+
+int32_t ADS1219::_scan_entry( const ADS1219ScanEntry& e, uint8_t gain, uint8_t* err_code )
+{
+    uint8_t value, mask;
+    int32_t result;
+
+    // mux and gain in one register write, which is skipped if nothing changes
+    value = e.mux;
+    mask  = ADS1219_CONFIG_MASK_MUX;
+    if ( gain != ADS1219_GAIN_KEEP ) {
+        value |= ads1219_gain_bits( gain );
+        mask  &= ADS1219_CONFIG_MASK_GAIN;
+    }
+
+    *err_code = _modify_register( value, mask );
+    if ( _try_recover( *err_code ) ) *err_code = _modify_register( value, mask );
+
+    if ( *err_code != ADS1219_OK ) {
+        result = 0x80000000;
+        _conv_start_us = _conv_end_us = micros();
+    } else if ( e.samples > 1 ) {
+        ADS1219Oversample r;
+        *err_code = oversample( e.mux, e.samples, &r );
+        result = r.valid > 0 ? r.mean : static_cast<int32_t>(0x80000000);
+    } else {
+        result = _readout( e.mux, err_code );
+    }
+
+    return result;
+}
+
+bool ADS1219::scanIfDue( ADS1219ScanPlan& plan, int32_t* results, uint8_t* err_codes )
+{
+    if ( plan._interval_us == 0 ) return false;
+
+    unsigned long now = micros();
+    if ( static_cast<long>( now - plan._next_us ) < 0 ) return false;
+
+    // keep a fixed cadence, but don't try to catch up when we're more than one interval behind
+    plan._next_us += plan._interval_us;
+    if ( static_cast<long>( now - plan._next_us ) >= 0 ) plan._next_us = now + plan._interval_us;
+
+    scan( plan, results, err_codes );
+
+    return true;
+}
+
+
+uint8_t ADS1219::_wait_conversion( unsigned long deadline_us, unsigned long ct_us )
+{
+    uint8_t code = ADS1219_OK;
+
+    // if we're behind, the timeout counts from now
+    if ( static_cast<long>( micros() - deadline_us ) > 0 ) deadline_us = micros();
+
+    if ( _ready_mode == ADS1219_READY_BUS ) 
+    {
+        // the backend may be able to sleep until DRDY
+        return _bus->waitDrdy( deadline_us + _timeout_ms * 1000UL - micros() );
+    }
+
+    if ( _ready_mode != ADS1219_READY_STATUS ) 
+    {
+        while ( ! drdyReady() ) {
+            if ( static_cast<long>( micros() - deadline_us ) > static_cast<long>( _timeout_ms * 1000UL ) ) return ADS1219_TIMEOUT;
+            yield();
+        }
+        _drdy_count = 0;  // this one is consumed
+        return ADS1219_OK;
+    }
+
+    // stay off the bus until the conversion should be done, then check the status in small steps
+    while ( static_cast<long>( micros() - deadline_us ) < 0 ) yield();
+
+    unsigned long step = ct_us >> 5 > 100 ? ct_us >> 5 : 100;
+    while ( ! conversionReady( &code ) ) {
+        if ( code != ADS1219_OK ) return code;
+        if ( static_cast<long>( micros() - deadline_us ) > static_cast<long>( _timeout_ms * 1000UL ) ) return ADS1219_TIMEOUT;
+        delayMicroseconds( step );
+    }
+
+    return code;
+}
+
+
+uint8_t ADS1219::beginConversion( uint8_t mux )
+{
+    uint8_t code;
+
+    if ( _conv_state != ADS1219_STATE_IDLE || _streaming ) return ADS1219_BUSY;
+    if ( ! ads1219_valid_mux( mux ) ) return ADS1219_INVALID_MUX;
 
     // Set the multiplexer configuration
-    *err_code = _modify_register(mux, ADS1219_CONFIG_MASK_MUX );
-    if ( *err_code ) return 0x80000000;
-    
+    code = _modify_register( mux, ADS1219_CONFIG_MASK_MUX );
+    if ( code ) return code;
+
+    uint8_t config;
+    code = _get_config( &config );
+    if ( code ) return code;
+
     // Start the conversion
-    *err_code = start();
-    if ( *err_code ) return 0x80000000;
+    code = start();
+    if ( code ) return code;
+
+    // the first status check just after the expected end of the conversion, with room for the oscillator tolerance
+    config        &= ADS1219_CONFIG_MASK_CM;  // single-shot timing, also in continuous mode as START restarts the conversion
+    _conv_start_us = micros();
+    _conv_mux      = mux;
+    _conv_rate     = ( config & ~ADS1219_CONFIG_MASK_DR ) >> 2;
+    _conv_time_us  = _expected_us( config );
+    _conv_poll_us  = _conv_time_us + _margin_us( _conv_time_us );
+    _conv_miss_us  = 0;
+    _conv_state    = ADS1219_STATE_WAITING;
+
+    return ADS1219_OK;
+}
+
+
+bool ADS1219::poll( ADS1219Sample* sample )
+{
+    uint8_t code = ADS1219_OK;
+    bool ready;
+
+    sample->value    = 0x80000000;
+    sample->mux      = _conv_mux;
+    sample->err_code = ADS1219_OK;
+
+    if ( _conv_state == ADS1219_STATE_IDLE ) {
+        sample->err_code = ADS1219_NOT_STARTED;
+        return true;
+    }
+
+    unsigned long elapsed = micros() - _conv_start_us;
+
+    if ( _ready_mode != ADS1219_READY_STATUS ) 
+    {
+        // the DRDY pin doesn't cost any bus traffic, read the result as soon as it's there
+        ready = drdyReady();
+    } 
+    else 
+    {
+        // don't touch the bus during the conversion, then check the status at regular intervals
+        if ( elapsed < _conv_poll_us ) return false;
+
+        ready = conversionReady( &code );
+        if ( code ) {
+            _conv_end_us     = micros();
+            _conv_state      = ADS1219_STATE_IDLE;
+            sample->err_code = code;
+            return true;
+        }
+        _conv_poll_us = elapsed + ( _conv_time_us >> 5 > 100UL ? _conv_time_us >> 5 : 100UL );
+    }
+
+    if ( ! ready ) 
+    {
+        _conv_miss_us = elapsed;
+
+        // Add a timeout safety
+        if ( elapsed < _conv_time_us + _timeout_ms * 1000UL ) return false;
+
+        _conv_end_us     = micros();
+        _conv_state      = ADS1219_STATE_IDLE;
+        sample->err_code = ADS1219_TIMEOUT;
+        ADS1219_STAT( _stats.timeouts++; )
+        return true;
+    }
+
+    if ( _adaptive ) _learn( _conv_rate, _conv_miss_us, elapsed );
 
-    // get the conversion time
-    uint16_t ct = getConversionTime();
+    _conv_end_us  = micros();
+    _conv_state   = ADS1219_STATE_IDLE;
+    sample->value = _read_value( &code );
+    sample->err_code = code;
+
+    return true;
+}
 
-    // Wait during the conversion time, add 10 % margin in the loop below and increment in steps 
-    // of 10 % untill timeout, normally after first 10 % extra time, the conversion should
-    // be ready
-    delay(ct);
 
-    // Add a timeout safety  
-    unsigned long tstart = millis();
-    while( ! ready && ( (millis() - tstart) < _timeout_ms ) ) {
-        delay( ct > 20 ? 5 : 1 ); // extra delay of 5 ms for 50 ms conversion time, for the rest delay additional 1 ms
-        ready = conversionReady(err_code);
+
+void ADS1219::_attach_drdy( void )
+{
+    pinMode(_drdy_pin, INPUT_PULLUP);  // DRDY is an open drain output
+    _ready_mode = ADS1219_READY_DRDY_POLL;
+
+#ifdef NOT_AN_INTERRUPT
+    int irq = digitalPinToInterrupt(_drdy_pin);
+    if ( irq == NOT_AN_INTERRUPT ) return;
+
+    // find a free slot for the interrupt routine, if none, stick with reading the pin
+    for ( uint8_t i = 0; i < ADS1219_MAX_DRDY_IRQ; i++ ) 
+    {
+        if ( _drdy_devices[i] != nullptr ) continue;
+
+        static void (* const isrs[ADS1219_MAX_DRDY_IRQ])(void) = { _drdy_isr0, _drdy_isr1, _drdy_isr2, _drdy_isr3 };
+
+        _drdy_devices[i] = this;
+        _drdy_slot       = i;
+        _drdy_count      = 0;
+        _ready_mode      = ADS1219_READY_DRDY_IRQ;
+        attachInterrupt(irq, isrs[i], FALLING);
+        return;
     }
+#endif
+}
+
+
+void ADS1219::_detach_drdy( void )
+{
+    if ( _drdy_slot < 0 ) return;
+
+#ifdef NOT_AN_INTERRUPT
+    detachInterrupt(digitalPinToInterrupt(_drdy_pin));
+#endif
+    _drdy_devices[_drdy_slot] = nullptr;
+    _drdy_slot  = -1;
+    _ready_mode = ADS1219_READY_DRDY_POLL;
+}
 
-    if ( ! ready ) {
-        *err_code = ADS1219_TIMEOUT;
-        return 0x80000000;
+
+// Interrupt trampolines, one per slot, the counter saturates so a slow reader can still tell
+// that more than one conversion went by
+#define ADS1219_DRDY_ISR(n) \
+    void ADS1219::_drdy_isr##n( void ) { \
+        ADS1219* dev = _drdy_devices[n]; \
+        if ( dev != nullptr && dev->_drdy_count < 0xFF ) dev->_drdy_count++; \
     }
 
-    return _read_value(err_code);
+ADS1219_DRDY_ISR(0)
+ADS1219_DRDY_ISR(1)
+ADS1219_DRDY_ISR(2)
+ADS1219_DRDY_ISR(3)
+
+#undef ADS1219_DRDY_ISR
+
+
+void ADS1219::stats( ADS1219Stats* stats )
+{
+#ifdef ADS1219_ENABLE_STATS
+    *stats = _stats;
+#else
+    memset( stats, 0, sizeof(ADS1219Stats) );
+#endif
+}
+
+
+void ADS1219::resetStats( void )
+{
+    ADS1219_STAT( memset( &_stats, 0, sizeof(ADS1219Stats) ); )
 }
 
 
+void ADS1219::_stats_hist( uint16_t* hist, unsigned long us )
+{
+    uint8_t i = ADS1219Stats::bucket( us );
+    if ( hist[i] < 0xFFFF ) hist[i]++;
+}
+
+
+uint8_t ADS1219Stats::bucket( unsigned long us )
+{
+    uint8_t i = 0;
+    us >>= 7;
+    while ( us && i < ADS1219_HIST_BUCKETS - 1 ) {
+        us >>= 1;
+        i++;
+    }
+    return i;
+}
+
+
+unsigned long ADS1219Stats::bucketLimit( uint8_t i )
+{
+    if ( i >= ADS1219_HIST_BUCKETS - 1 ) return 0;
+    return 128UL << i;
+}
 
 
 uint8_t ADS1219::send_cmd(uint8_t cmd)
@@ -297,74 +1183,119 @@ uint8_t ADS1219::send_cmd(uint8_t cmd)
 }
 
 
-uint8_t ADS1219::_write(const uint8_t *buffer, size_t len, bool stop, const uint8_t *prefix_buffer, size_t prefix_len)
+uint8_t ADS1219::_write(const uint8_t *buffer, size_t len, bool stop)
 {
 
-    if ( (len + prefix_len) > this->maxBufferSize() ) 
+    if ( len > this->maxBufferSize() ) 
         return ADS1219_BUFFER_TOO_LARGE;
 
-    _wire->beginTransmission(_i2c_addr);
+    ADS1219_STAT( _stats.writes++; )
+    ADS1219_STAT( _stats.bytes_written += len; )
 
-    // write prefix, usually address
-    if ( (prefix_len != 0) && ( prefix_buffer != nullptr ) )
-    {
-        if ( _wire->write(prefix_buffer, prefix_len) != prefix_len ) 
-            return ADS1219_FAILED_TO_WRITE;
-    }
+    unsigned long tfail;
+    uint8_t code = _bus->write(_i2c_addr, buffer, len, stop);
+    for ( uint8_t n = 0; _retry( code, n, &tfail ); n++ ) code = _bus->write(_i2c_addr, buffer, len, stop);
 
-    // write data itself
-    if ( _wire->write(buffer, len) != len )
-        return ADS1219_FAILED_TO_WRITE;
-    
-    
-    // end
-    if ( _wire->endTransmission(stop) != 0)
-        return ADS1219_FAILED_TO_END;
-
-    return ADS1219_OK;
+    return code;
 }
 
 
 uint8_t ADS1219::_read(uint8_t *buffer, size_t len, bool stop)
 {
-    // different api here, for older architectures (e.g. atmelavr, only uint8_t version)
-#ifdef ARDUINO_ARCH_SAMD
-    size_t recv = _wire->requestFrom(_i2c_addr, len, stop);
-#else
-    size_t recv = _wire->requestFrom(_i2c_addr, static_cast<uint8_t>(len), static_cast<uint8_t>(stop));
-#endif
+    unsigned long tfail;
+    uint8_t code = _bus->read(_i2c_addr, buffer, len, stop);
+    for ( uint8_t n = 0; _retry( code, n, &tfail ); n++ ) code = _bus->read(_i2c_addr, buffer, len, stop);
+
+    ADS1219_STAT( _stats.reads++; )
+    ADS1219_STAT( if ( code == ADS1219_OK ) _stats.bytes_read += len; )
+
+    return code;
+}
+
 
-    if (recv != len )
-        return ADS1219_FAILED_TO_RECEIVE;
+uint8_t ADS1219::_command_read(uint8_t cmd, uint8_t* buffer, size_t len)
+{
+    ADS1219_STAT( _stats.writes++; )
+    ADS1219_STAT( _stats.bytes_written++; )
+    ADS1219_STAT( _stats.reads++; )
 
-    // recieve the bytes from the buffer
-    for (uint16_t i = 0; i < len; i++) {
-        buffer[i] = _wire->read();
+    // one operation for backends which can combine both, without a STOP in between with a repeated START
+    unsigned long tfail;
+    uint8_t code = _bus->writeRead(_i2c_addr, &cmd, 1, buffer, len, _repeated_start);
+    for ( uint8_t n = 0; _retry( code, n, &tfail ); n++ ) code = _bus->writeRead(_i2c_addr, &cmd, 1, buffer, len, _repeated_start);
+
+    ADS1219_STAT( if ( code == ADS1219_OK ) _stats.bytes_read += len; )
+
+    return code;
+}
+
+
+bool ADS1219::_retry( uint8_t code, uint8_t attempt, unsigned long* tfail )
+{
+    if ( code == ADS1219_OK && attempt == 0 ) return false;
+
+    // the deadline and the stall count from the first error
+    if ( attempt == 0 ) *tfail = micros();
+    unsigned long elapsed = micros() - *tfail;
+
+    bool retry = ads1219_bus_error( code ) && attempt < _retries && ( _deadline_us == 0 || elapsed < _deadline_us );
+    if ( ! retry ) {
+        if ( ads1219_bus_error( code ) ) _recovery.failures++;
+        if ( attempt > 0 && elapsed > _recovery.stall_max_us ) _recovery.stall_max_us = elapsed;
+        return false;
     }
 
-    return ADS1219_OK;
+    // a NACK is mostly a one-off, but when it fails again the device may be holding SDA low
+    if ( attempt > 0 && _bus->clear() ) _recovery.bus_clears++;
+    _recovery.retries++;
+
+    return true;
 }
 
 
 uint8_t ADS1219::_read_register(uint8_t reg, uint8_t* data)
 {
     uint8_t code;
+    ADS1219_STAT( unsigned long tstart = micros(); )
     
-    // send the command to read the register
-    code = send_cmd(reg);
-    if ( code != ADS1219_OK ) return code;
+    // send the command to read the register and read the result
+    code = _command_read(reg, data, 1);
+
+    ADS1219_STAT( _stats_hist( _stats.register_us, micros() - tstart ); )
 
-    // read result
-    return _read(data, 1);
+    return code;
 }
 
 
 uint8_t ADS1219::_write_register(uint8_t data)
 {
-    uint8_t reg = ADS1219_CMD_WREG;
+    uint8_t code;
+    uint8_t buffer[2] = { ADS1219_CMD_WREG, data };
+    ADS1219_STAT( unsigned long tstart = micros(); )
+
     // write the data, prefixed by the register
     // the ADS12129 has 2 8 bits registers, so we treat them separately here, 
-    return _write( &data, 1, true, &reg, 1 );
+    code = _write( buffer, 2 );
+    ADS1219_STAT( _stats_hist( _stats.register_us, micros() - tstart ); )
+
+    if ( code != ADS1219_OK ) {
+        // we don't know what ended up in the device, reload on next access
+        _config_valid = false;
+        return code;
+    }
+
+    _set_config( data );
+    _config_written = data;
+    _replay_pending = false;
+
+    if ( _verify ) 
+    {
+        code = syncConfig();
+        if ( code != ADS1219_OK ) return code;
+        if ( _config != data ) return ADS1219_VERIFY_FAILED;
+    }
+
+    return ADS1219_OK;
 }
 
 
@@ -372,26 +1303,70 @@ uint8_t ADS1219::_modify_register(uint8_t value, uint8_t mask )
 {
     uint8_t code, data;
 
-    // read config register
-    code = _read_register(ADS1219_CMD_RREG_CONFIG, &data);
+    // get the config register from the shadow copy
+    code = _get_config(&data);
     if ( code != ADS1219_OK ) return code;
 
+    // after a failed recovery the device is at its defaults, build on the configuration it should have
+    if ( _replay_pending ) data = _config_written;
+
     // modify, also mask the value bits, should be at the right position !
     // mask is 1 everywhere, except for the relevant bits
     data = (data & mask) | (value & ~mask);
 
+    // nothing to do if the register already holds this value
+    if ( data == _config ) return ADS1219_OK;
+
     // write back
     return _write_register(data);
 }
 
-int32_t ADS1219::_read_value( uint8_t* err_code )
+
+void ADS1219::_set_config(uint8_t data)
 {
-    // send the read command, if an error happenend, return max 32 bit integer, outside 24bit range !
-    *err_code = send_cmd(ADS1219_CMD_RDATA);
-    if ( *err_code ) return 0x80000000;
+    bool gain_changed = ( data ^ _config ) & ~ADS1219_CONFIG_MASK_GAIN;
+
+    _config       = data;
+    _config_valid = true;
+
+    // the conversion scale depends on the gain
+    if ( gain_changed ) _update_scale();
+}
+
+
+void ADS1219::_update_scale( void )
+{
+    float span = ( _config & ~ADS1219_CONFIG_MASK_GAIN ) ? ( _aref_p - _aref_n ) / 4. : ( _aref_p - _aref_n );
 
-    // now get 3 bytes back
-    *err_code = _read(_buffer, 3);
+    // µV per count with 32 fractional bits : span [mV] * 1000 / 2^23 * 2^32 = span * 1000 * 2^9
+    _uv_scale = static_cast<int64_t>( span * 512000. + ( span < 0 ? -0.5 : 0.5 ) );
+    _mv_scale = span / 8388608.;
+
+    // the windows only convert their thresholds again when the reference changed
+    for ( uint8_t i = 0; i < 8; i++ ) {
+        if ( _windows[i] != nullptr ) _windows[i]->setReference( _aref_p - _aref_n );
+    }
+}
+
+
+uint8_t ADS1219::_get_config(uint8_t* data)
+{
+    // only go to the device when the shadow copy is not valid
+    if ( ! _config_valid ) 
+    {
+        uint8_t code = syncConfig();
+        if ( code != ADS1219_OK ) return code;
+    }
+
+    *data = _config;
+
+    return ADS1219_OK;
+}
+
+int32_t ADS1219::_read_value( uint8_t* err_code )
+{
+    // send the read command & get 3 bytes back, if an error happenend, return max 32 bit integer, outside 24bit range !
+    *err_code = _command_read(ADS1219_CMD_RDATA, _buffer, 3);
     if ( *err_code ) return 0x80000000;
 
     // now decode the bytes
@@ -404,8 +1379,19 @@ int32_t ADS1219::_read_value( uint8_t* err_code )
          ( static_cast<int32_t>(_buffer[2]) << 8) ) >> 8;
 
     // test for over/underflow !!
-    if ( value >= ( (static_cast<int32_t>(0x7FFFFF) << 8 ) >> 8 ) ) *err_code = ADS1219_ADC_OVERFLOW;
-    if ( value <= ( (static_cast<int32_t>(0x800000) << 8 ) >> 8 ) ) *err_code = ADS1219_ADC_UNDERFLOW;
+    if ( value >= ( (static_cast<int32_t>(0x7FFFFF) << 8 ) >> 8 ) ) {
+        *err_code = ADS1219_ADC_OVERFLOW;
+        ADS1219_STAT( _stats.overflows++; )
+    }
+    if ( value <= ( (static_cast<int32_t>(0x800000) << 8 ) >> 8 ) ) {
+        *err_code = ADS1219_ADC_UNDERFLOW;
+        ADS1219_STAT( _stats.underflows++; )
+    }
+
+    // window comparator of the multiplexer setting, integer compares only
+    ADS1219Window* window = _windows[ _config >> 5 ];
+    _window_pass = window == nullptr || 
+                   window->check( _config & ~ADS1219_CONFIG_MASK_MUX, value, ( _config & ~ADS1219_CONFIG_MASK_GAIN ) != 0 );
 
     return value;
 }
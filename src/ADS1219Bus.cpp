@@ -0,0 +1,119 @@
+#include "ADS1219.h"
+
+
+uint8_t ADS1219Bus::begin( void )
+{
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219Bus::writeRead( uint8_t addr, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len, bool repeated_start )
+{
+    // without a STOP after the command, the read starts with a repeated START
+    uint8_t code = write( addr, tx, tx_len, ! repeated_start );
+    if ( code != ADS1219_OK ) return code;
+
+    return read( addr, rx, rx_len );
+}
+
+
+uint8_t ADS1219Bus::waitDrdy( unsigned long timeout_us )
+{
+    unsigned long tstart = micros();
+    while ( ! drdyReady() ) {
+        if ( micros() - tstart > timeout_us ) return ADS1219_TIMEOUT;
+        yield();
+    }
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219TwoWireBus::begin( void )
+{
+    _wire->begin();
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219TwoWireBus::write( uint8_t addr, const uint8_t* data, size_t len, bool stop )
+{
+    _wire->beginTransmission(addr);
+
+    // write data itself
+    if ( len > 0 && _wire->write(data, len) != len )
+        return ADS1219_FAILED_TO_WRITE;
+
+    // end
+    if ( _wire->endTransmission(stop) != 0)
+        return ADS1219_FAILED_TO_END;
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219TwoWireBus::read( uint8_t addr, uint8_t* data, size_t len, bool stop )
+{
+    // different api here, for older architectures (e.g. atmelavr, only uint8_t version)
+#ifdef ARDUINO_ARCH_SAMD
+    size_t recv = _wire->requestFrom(addr, len, stop);
+#else
+    size_t recv = _wire->requestFrom(addr, static_cast<uint8_t>(len), static_cast<uint8_t>(stop));
+#endif
+
+    if (recv != len )
+        return ADS1219_FAILED_TO_RECEIVE;
+
+    // recieve the bytes from the buffer
+    for (uint16_t i = 0; i < len; i++) {
+        data[i] = _wire->read();
+    }
+
+    return ADS1219_OK;
+}
+
+
+bool ADS1219TwoWireBus::clear( void )
+{
+    _wire->end();
+
+    if ( _sda_pin != 0xFF && _scl_pin != 0xFF ) 
+    {
+        // open drain by hand : an input for high, left to the bus pull-ups, an output low for low, so the
+        // device can still stretch the clock. The output level is set to low while the pin is still an input
+        // (which also turns its own pull-up off), so a line is never driven high.
+        pinMode( _sda_pin, INPUT );
+        pinMode( _scl_pin, INPUT );
+        digitalWrite( _sda_pin, LOW );
+        digitalWrite( _scl_pin, LOW );
+
+        // clock out the rest of whatever byte the device is sending, until it lets go of SDA
+        for ( uint8_t i = 0; i < 9; i++ ) {
+            pinMode( _scl_pin, OUTPUT );
+            delayMicroseconds( 5 );
+            pinMode( _scl_pin, INPUT );
+            delayMicroseconds( 5 );
+            if ( digitalRead( _sda_pin ) == HIGH ) break;
+        }
+
+        // STOP : SDA goes high while SCL is high
+        pinMode( _sda_pin, OUTPUT );
+        delayMicroseconds( 5 );
+        pinMode( _sda_pin, INPUT );
+        delayMicroseconds( 5 );
+    }
+
+    _wire->begin();
+    _wire->setClock( _clock );
+
+    return true;
+}
+
+
+size_t ADS1219TwoWireBus::maxTransfer( void ) const
+{
+#ifdef ARDUINO_ARCH_SAMD
+    return 256; // and not 250 as in Adafruit_I2CDevice.cpp ?
+#else
+    return 32;  // see buffer size in Wire.h for other architectures
+#endif
+}
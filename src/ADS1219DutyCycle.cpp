@@ -0,0 +1,166 @@
+#include <math.h>
+
+#include "ADS1219DutyCycle.h"
+
+
+ADS1219DutyCycle::ADS1219DutyCycle( ADS1219& adc, ADS1219ScanPlan& plan )
+    : _adc(adc)
+    , _plan(plan)
+    , _period_us(0)
+    , _next_us(0)
+    , _down_us(0)
+    , _error(ADS1219_OK)
+{
+    resetStats();
+}
+
+
+unsigned long ADS1219DutyCycle::burstTime( uint8_t rate, uint16_t samples )
+{
+    // the first conversion takes the single-shot time, the others follow at the continuous rate
+    return ads1219_conversion_us( rate ) + ( samples > 1 ? ( samples - 1 ) * ads1219_conversion_us( rate, ADS1219_CM_CONTINUOUS ) : 0 );
+}
+
+
+bool ADS1219DutyCycle::bestRate( float noise_uv, uint8_t gain, uint8_t* rate, uint16_t* samples, uint16_t max_samples ) const
+{
+    unsigned long best_us = 0;
+
+    if ( noise_uv <= 0.f ) return false;
+
+    for ( uint8_t r = ADS1219_DATARATE_20SPS; r <= ADS1219_DATARATE_1000SPS; r++ ) 
+    {
+        // averaging n conversions takes the noise down by sqrt(n)
+        float ratio = _model.noise( r, gain ) / noise_uv;
+        float n = ceilf( ratio * ratio - 1e-4f );
+        if ( n < 1.f ) n = 1.f;
+        if ( n > max_samples ) continue;
+
+        unsigned long us = burstTime( r, static_cast<uint16_t>( n ) );
+        if ( best_us == 0 || us < best_us ) {
+            best_us  = us;
+            *rate    = r;
+            *samples = static_cast<uint16_t>( n );
+        }
+    }
+
+    return best_us > 0;
+}
+
+
+uint8_t ADS1219DutyCycle::setNoise( float noise_uv, uint8_t gain )
+{
+    uint8_t  rate;
+    uint16_t samples;
+
+    if ( gain != ADS1219_GAIN_ONE && gain != ADS1219_GAIN_FOUR ) return ADS1219_INVALID_GAIN;
+    if ( ! bestRate( noise_uv, gain, &rate, &samples ) ) return ADS1219_INVALID_DATARATE;
+
+    // the noise figures are those of this gain
+    for ( uint8_t i = 0; i < _plan.size(); i++ ) {
+        _plan.setSamples( i, samples );
+        _plan.setGain( i, gain );
+    }
+
+    return _adc.setDataRate( rate );
+}
+
+
+uint8_t ADS1219DutyCycle::begin( unsigned long period_us )
+{
+    resetStats();
+
+    _period_us = period_us;
+    _error     = _adc.powerDown();
+    _down_us   = micros();
+    _next_us   = _down_us;
+
+    return _error;
+}
+
+
+bool ADS1219DutyCycle::run( int32_t* results, uint8_t* err_codes )
+{
+    unsigned long wake_us = micros();
+    if ( _period_us == 0 || static_cast<long>( wake_us - _next_us ) < 0 ) return false;
+
+    // the START of the first conversion wakes the device, power down as soon as the last one is read
+    _error = _adc.scan( _plan, results, err_codes );
+
+    // the application has a conversion or stream running : no burst, and the device stays up for it
+    if ( _error == ADS1219_BUSY ) return false;
+
+    _off_us += wake_us - _down_us;
+
+    uint8_t code = _adc.powerDown();
+    if ( _error == ADS1219_OK ) _error = code;
+
+    _down_us = micros();
+    _on_us  += _down_us - wake_us;
+    _converting_us += _converting();
+
+    _bursts++;
+    _samples += _plan.size();
+
+    // fixed cadence, no catching up on missed bursts
+    _next_us += _period_us;
+    if ( static_cast<long>( _down_us - _next_us ) >= 0 ) _next_us = _down_us + _period_us;
+
+    return true;
+}
+
+
+unsigned long ADS1219DutyCycle::_converting( void )
+{
+    uint8_t rate = ADS1219_DATARATE_20SPS;
+    _adc.getDataRate( &rate );
+    unsigned long ct_us = ads1219_conversion_us( rate, ADS1219_CM_CONTINUOUS );
+
+    unsigned long us = 0;
+    for ( uint8_t i = 0; i < _plan.size(); i++ ) 
+    {
+        unsigned long end = _plan.endTime(i) - _plan.startTime(i);
+
+        // an averaged entry runs in continuous mode : the device finishes one more conversion after the last 
+        // one read, unless the START of the next entry comes first (the power down waits for it)
+        if ( _plan.entry(i).samples > 1 ) {
+            end += ct_us;
+            if ( i + 1 < _plan.size() && _plan.startTime(i + 1) - _plan.startTime(i) < end ) end = _plan.startTime(i + 1) - _plan.startTime(i);
+        }
+        us += end;
+    }
+
+    return us;
+}
+
+
+void ADS1219DutyCycle::stats( ADS1219DutyStats* s ) const
+{
+    s->bursts        = _bursts;
+    s->samples       = _samples;
+    s->on_us         = _on_us;
+    s->off_us        = _off_us;
+    s->converting_us = _converting_us;
+
+    // µA * V * s = µJ, the last conversion of a burst may run into the power down
+    double total  = static_cast<double>( _on_us + _off_us );
+    double idle   = _on_us > _converting_us ? static_cast<double>( _on_us - _converting_us ) : 0.;
+    double charge = _model.converting_ua * 1e-6 * _converting_us
+                  + _model.idle_ua * 1e-6 * idle
+                  + _model.powerdown_ua * 1e-6 * _off_us;
+
+    s->duty                 = total > 0 ? static_cast<float>( _on_us / total ) : 0.f;
+    s->energy_uj            = static_cast<float>( charge * _model.supply_v );
+    s->energy_per_sample_uj = _samples ? s->energy_uj / _samples : 0.f;
+    s->average_ua           = total > 0 ? static_cast<float>( charge / total * 1e6 ) : 0.f;
+}
+
+
+void ADS1219DutyCycle::resetStats( void )
+{
+    _bursts        = 0;
+    _samples       = 0;
+    _on_us         = 0;
+    _off_us        = 0;
+    _converting_us = 0;
+}
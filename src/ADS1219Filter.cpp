@@ -0,0 +1,33 @@
+#include "ADS1219Filter.h"
+
+
+bool ADS1219Filter::filter( int32_t in, int32_t* out )
+{
+    for ( ADS1219Filter* f = this; f != nullptr; f = f->_next )
+    {
+        if ( ! f->_process( in, &in ) ) return false;
+    }
+
+    _last = in;
+    *out  = in;
+
+    return true;
+}
+
+
+bool ADS1219Filter::decimating( void ) const
+{
+    for ( const ADS1219Filter* f = this; f != nullptr; f = f->_next )
+    {
+        if ( f->_decimates() ) return true;
+    }
+
+    return false;
+}
+
+
+void ADS1219Filter::reset( void )
+{
+    for ( ADS1219Filter* f = this; f != nullptr; f = f->_next ) f->_reset();
+    _last = static_cast<int32_t>(0x80000000);
+}
@@ -0,0 +1,82 @@
+#include "ADS1219Group.h"
+
+
+ADS1219Group::ADS1219Group()
+    : _size(0)
+    , _duration_us(0)
+    , _samples(0)
+{
+}
+
+
+uint8_t ADS1219Group::add( ADS1219* adc )
+{
+    if ( _size >= ADS1219_GROUP_MAX_DEVICES ) return ADS1219_GROUP_FULL;
+
+    _devices[_size++] = adc;
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219Group::convert( uint8_t mux, int32_t* results, uint8_t* err_codes )
+{
+    uint8_t muxes[ADS1219_GROUP_MAX_DEVICES];
+    for ( uint8_t i = 0; i < _size; i++ ) muxes[i] = mux;
+
+    return convert( muxes, results, err_codes );
+}
+
+
+uint8_t ADS1219Group::convert( const uint8_t* muxes, int32_t* results, uint8_t* err_codes )
+{
+    uint8_t codes[ADS1219_GROUP_MAX_DEVICES];
+    uint8_t pending = 0;
+    uint8_t status  = ADS1219_OK;
+
+    unsigned long tstart = micros();
+
+    // kick off all conversions back to back
+    for ( uint8_t i = 0; i < _size; i++ ) 
+    {
+        codes[i] = _devices[i]->beginConversion( muxes[i] );
+        if ( codes[i] == ADS1219_OK ) pending |= ( 1 << i );
+        results[i] = 0x80000000;
+    }
+
+    // harvest the results in whatever order the devices finish
+    while ( pending ) 
+    {
+        for ( uint8_t i = 0; i < _size; i++ ) 
+        {
+            if ( ! ( pending & ( 1 << i ) ) ) continue;
+
+            ADS1219Sample sample;
+            if ( ! _devices[i]->poll( &sample ) ) continue;
+
+            results[i] = sample.value;
+            codes[i]   = sample.err_code;
+            pending   &= ~( 1 << i );
+        }
+        if ( pending ) yield();
+    }
+
+    _duration_us = micros() - tstart;
+    _samples     = 0;
+
+    for ( uint8_t i = 0; i < _size; i++ ) 
+    {
+        if ( results[i] != static_cast<int32_t>(0x80000000) ) _samples++;
+        if ( err_codes != nullptr ) err_codes[i] = codes[i];
+        if ( status == ADS1219_OK ) status = codes[i];
+    }
+
+    return status;
+}
+
+
+float ADS1219Group::throughput( void ) const
+{
+    if ( _duration_us == 0 ) return 0.f;
+    return _samples * 1.e6f / _duration_us;
+}
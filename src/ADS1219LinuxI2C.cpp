@@ -0,0 +1,122 @@
+#if defined(__linux__)
+
+#include "ADS1219.h"
+#include "ADS1219LinuxI2C.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+
+static int ads1219_sys_ioctl( int fd, unsigned long request, void* arg )
+{
+    return ::ioctl( fd, request, arg );
+}
+
+
+ADS1219LinuxI2C::ADS1219LinuxI2C( const char* device, IoctlFunction ioctl_fn )
+    : _device(device)
+    , _fd(-1)
+    , _ioctl(ioctl_fn != nullptr ? ioctl_fn : ads1219_sys_ioctl)
+    , _transfers(0)
+    , _errno(0)
+{
+}
+
+
+ADS1219LinuxI2C::~ADS1219LinuxI2C()
+{
+    end();
+}
+
+
+uint8_t ADS1219LinuxI2C::begin( void )
+{
+    if ( _fd >= 0 ) return ADS1219_OK;
+
+    _fd = ::open( _device, O_RDWR );
+    if ( _fd < 0 ) {
+        _errno = errno;
+        return ADS1219_FAILED_TO_END;
+    }
+
+    return ADS1219_OK;
+}
+
+
+void ADS1219LinuxI2C::end( void )
+{
+    if ( _fd >= 0 ) ::close( _fd );
+    _fd = -1;
+}
+
+
+uint8_t ADS1219LinuxI2C::write( uint8_t addr, const uint8_t* data, size_t len, bool stop )
+{
+    // every ioctl ends with a STOP, a repeated START needs writeRead()
+    (void) stop;
+
+    struct i2c_msg msg;
+    msg.addr  = addr;
+    msg.flags = 0;
+    msg.len   = static_cast<uint16_t>( len );
+    msg.buf   = const_cast<uint8_t*>( data );
+
+    return _transfer( &msg, 1 ) == ADS1219_OK ? ADS1219_OK : ADS1219_FAILED_TO_END;
+}
+
+
+uint8_t ADS1219LinuxI2C::read( uint8_t addr, uint8_t* data, size_t len, bool stop )
+{
+    (void) stop;
+
+    struct i2c_msg msg;
+    msg.addr  = addr;
+    msg.flags = I2C_M_RD;
+    msg.len   = static_cast<uint16_t>( len );
+    msg.buf   = data;
+
+    return _transfer( &msg, 1 );
+}
+
+
+uint8_t ADS1219LinuxI2C::writeRead( uint8_t addr, const uint8_t* tx, size_t tx_len, uint8_t* rx, size_t rx_len, bool repeated_start )
+{
+    if ( ! repeated_start ) return ADS1219Bus::writeRead( addr, tx, tx_len, rx, rx_len, false );
+
+    // both messages in one ioctl, the kernel puts a repeated START in between
+    struct i2c_msg msgs[2];
+    msgs[0].addr  = addr;
+    msgs[0].flags = 0;
+    msgs[0].len   = static_cast<uint16_t>( tx_len );
+    msgs[0].buf   = const_cast<uint8_t*>( tx );
+    msgs[1].addr  = addr;
+    msgs[1].flags = I2C_M_RD;
+    msgs[1].len   = static_cast<uint16_t>( rx_len );
+    msgs[1].buf   = rx;
+
+    return _transfer( msgs, 2 );
+}
+
+
+uint8_t ADS1219LinuxI2C::_transfer( struct i2c_msg* msgs, uint32_t n )
+{
+    struct i2c_rdwr_ioctl_data data;
+    data.msgs  = msgs;
+    data.nmsgs = n;
+
+    _transfers++;
+
+    // the ioctl returns the number of messages transferred
+    if ( _ioctl( _fd, I2C_RDWR, &data ) != static_cast<int>( n ) ) {
+        _errno = errno;
+        return ADS1219_FAILED_TO_RECEIVE;
+    }
+
+    return ADS1219_OK;
+}
+
+#endif
@@ -0,0 +1,205 @@
+#include "ADS1219Packet.h"
+
+
+uint16_t ads1219_crc16( const uint8_t* data, size_t len, uint16_t crc )
+{
+    // byte wise without a table : x = top byte ^ data, folded with the polynomial terms x^12, x^5 and 1
+    for ( size_t i = 0; i < len; i++ ) {
+        uint8_t x = static_cast<uint8_t>( ( crc >> 8 ) ^ data[i] );
+        x ^= x >> 4;
+        crc = static_cast<uint16_t>( ( crc << 8 ) ^ ( static_cast<uint16_t>( x ) << 12 ) ^ ( static_cast<uint16_t>( x ) << 5 ) ^ x );
+    }
+    return crc;
+}
+
+
+size_t ads1219_cobs_encode( const uint8_t* in, size_t len, uint8_t* out )
+{
+    // every block starts with a code byte : the distance to the next 0x00 (or 0xFF for 254 bytes without one)
+    size_t  code_pos = 0;
+    size_t  n = 1;
+    uint8_t code = 1;
+
+    for ( size_t i = 0; i < len; i++ ) {
+        if ( in[i] == 0 ) {
+            out[code_pos] = code;
+            code_pos = n++;
+            code = 1;
+        } else {
+            out[n++] = in[i];
+            if ( ++code == 0xFF ) {
+                out[code_pos] = code;
+                code_pos = n++;
+                code = 1;
+            }
+        }
+    }
+    out[code_pos] = code;
+
+    return n;
+}
+
+
+size_t ads1219_cobs_decode( const uint8_t* in, size_t len, uint8_t* out )
+{
+    size_t i = 0, n = 0;
+
+    while ( i < len ) {
+        uint8_t code = in[i++];
+        if ( code == 0 || i + code - 1 > len ) return 0;
+
+        for ( uint8_t j = 1; j < code; j++ ) {
+            if ( in[i] == 0 ) return 0;
+            out[n++] = in[i++];
+        }
+
+        // a block shorter than 254 bytes stood for a 0x00, except at the end
+        if ( code < 0xFF && i < len ) out[n++] = 0;
+    }
+
+    return n;
+}
+
+
+size_t ADS1219PacketWriter::send( uint8_t type, const uint8_t* payload, size_t len )
+{
+    uint8_t raw[ADS1219_PACKET_MAX];
+    uint8_t enc[ADS1219_PACKET_MAX_ENCODED];
+
+    if ( len > ADS1219_RECORD_MAX_FRAME ) return 0;
+
+    raw[0] = type;
+    raw[1] = static_cast<uint8_t>( _seq );
+    raw[2] = static_cast<uint8_t>( _seq >> 8 );
+    memcpy( raw + 3, payload, len );
+    uint16_t crc = ads1219_crc16( raw, len + 3 );
+    raw[len + 3] = static_cast<uint8_t>( crc >> 8 );
+    raw[len + 4] = static_cast<uint8_t>( crc );
+
+    size_t n = ads1219_cobs_encode( raw, len + 5, enc );
+    enc[n++] = 0x00;
+    _seq++;
+
+    // one write, so the serial driver can send it as a block
+    return _out.write( enc, n );
+}
+
+
+ADS1219PacketReader::ADS1219PacketReader()
+    : _pos(0)
+    , _overflow(false)
+    , _len(0)
+    , _seq(0)
+    , _have_seq(false)
+    , _gap(false)
+    , _packets(0)
+    , _crc_errors(0)
+    , _framing_errors(0)
+    , _dropped(0)
+{
+}
+
+
+bool ADS1219PacketReader::push( uint8_t c )
+{
+    if ( c != 0x00 ) {
+        if ( _pos < sizeof(_buf) ) _buf[_pos++] = c;
+        else _overflow = true;
+        return false;
+    }
+
+    // a delimiter : decode what came before it, in place
+    size_t len = _pos;
+    bool overflow = _overflow;
+    _pos = 0;
+    _overflow = false;
+
+    if ( len == 0 ) return false;  // back to back delimiters, e.g. to flush the receiver
+
+    size_t n = overflow ? 0 : ads1219_cobs_decode( _buf, len, _buf );
+    if ( n < 5 ) {
+        _framing_errors++;
+        return false;
+    }
+
+    uint16_t crc = ads1219_crc16( _buf, n - 2 );
+    if ( crc != ( ( static_cast<uint16_t>( _buf[n - 2] ) << 8 ) | _buf[n - 1] ) ) {
+        _crc_errors++;
+        return false;
+    }
+
+    uint16_t seq = static_cast<uint16_t>( _buf[1] | ( _buf[2] << 8 ) );
+    uint16_t missing = static_cast<uint16_t>( seq - _seq - 1 );
+    _gap = _have_seq && missing != 0;
+    if ( _gap ) _dropped += missing;
+
+    _seq      = seq;
+    _have_seq = true;
+    _len      = n - 5;
+    _packets++;
+
+    return true;
+}
+
+
+ADS1219PacketDecoder::ADS1219PacketDecoder( SampleFunction fn, void* context )
+    : _fn(fn)
+    , _context(context)
+    , _samples(0)
+    , _frames(0)
+    , _skipped(0)
+    , _bad(0)
+{
+}
+
+
+void ADS1219PacketDecoder::push( const uint8_t* data, size_t len )
+{
+    for ( size_t i = 0; i < len; i++ )
+        if ( _reader.push( data[i] ) ) _frame();
+}
+
+
+void ADS1219PacketDecoder::_frame( void )
+{
+    ADS1219RecordFrame frame;
+    uint8_t err;
+
+    if ( _reader.type() != ADS1219_PACKET_RECORD ) return;
+
+    // deltas and relative timestamps can't be trusted after a lost packet
+    if ( _reader.gap() ) _decoder.reset();
+
+    size_t used = _decoder.decode( _reader.payload(), _reader.length(), &frame, &err );
+    if ( err == ADS1219_RECORD_NO_LAYOUT ) {
+        _skipped++;
+        return;
+    }
+    if ( err != ADS1219_OK || used != _reader.length() ) {
+        _bad++;
+        _decoder.reset();
+        return;
+    }
+    _frames++;
+
+    ADS1219PacketSample s;
+    s.seq  = _reader.sequence();
+    s.rate = frame.rate;
+    uint32_t period_us = ads1219_conversion_us( frame.rate, ADS1219_CM_CONTINUOUS );
+
+    for ( uint8_t i = 0; i < frame.size; i++ )
+    {
+        // conversions of the same input earlier in the frame
+        uint8_t k = 0;
+        for ( uint8_t j = 0; j < i; j++ ) k += frame.mux[j] == frame.mux[i];
+
+        if ( frame.value[i] == static_cast<int32_t>(0x80000000) ) continue;
+
+        s.time_us = frame.timestamp_us + static_cast<uint64_t>( k ) * period_us;
+        s.mux     = frame.mux[i];
+        s.gain    = frame.gain[i];
+        s.value   = frame.value[i];
+        _samples++;
+        _fn( s, _context );
+    }
+}
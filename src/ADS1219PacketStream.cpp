@@ -0,0 +1,76 @@
+#include "ADS1219Packet.h"
+#include "ADS1219Filter.h"
+#include "ADS1219Window.h"
+
+
+ADS1219PacketStream::ADS1219PacketStream( ADS1219& adc, Print& out, bool delta )
+    : _adc(adc)
+    , _writer(out)
+    , _encoder(delta, 16)
+    , _mux(0)
+    , _gain(ADS1219_GAIN_ONE)
+    , _rate(0)
+    , _packets(0)
+    , _bytes(0)
+{
+}
+
+
+uint8_t ADS1219PacketStream::begin( uint8_t mux, uint8_t rate, ADS1219Filter* filter )
+{
+    // the timestamps take a sample per conversion
+    if ( filter != nullptr && filter->decimating() ) return ADS1219_STREAM_IRREGULAR;
+    ADS1219Window* window = _adc.window( mux );
+    if ( window != nullptr && window->suppress() ) return ADS1219_STREAM_IRREGULAR;
+
+    uint8_t code = _adc.startStream( mux, rate, filter );
+    if ( code != ADS1219_OK ) return code;
+
+    _mux  = mux;
+    _rate = rate;
+    _adc.getGain( &_gain );
+    _encoder.reset();
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219PacketStream::service( void )
+{
+    uint8_t code = _adc.serviceStream();
+
+    while ( _adc.available() >= ADS1219_PACKET_SAMPLES ) _send( ADS1219_PACKET_SAMPLES );
+
+    return code;
+}
+
+
+uint8_t ADS1219PacketStream::end( void )
+{
+    if ( _adc.available() > 0 ) _send( _adc.available() );
+
+    return _adc.stopStream();
+}
+
+
+void ADS1219PacketStream::_send( size_t n )
+{
+    int32_t values[ADS1219_RECORD_MAX_SAMPLES];
+    uint8_t frame[ADS1219_RECORD_MAX_FRAME];
+
+    if ( n > ADS1219_RECORD_MAX_SAMPLES ) n = ADS1219_RECORD_MAX_SAMPLES;
+
+    // the newest sample in the buffer is about now, the oldest one a conversion period per sample earlier
+    unsigned long period_us = ads1219_conversion_us( _rate, ADS1219_CM_CONTINUOUS );
+    unsigned long first_us  = micros() - ( _adc.available() - 1 ) * period_us;
+
+    n = _adc.readBuffered( values, n );
+
+    _encoder.beginFrame( first_us, _rate );
+    for ( size_t i = 0; i < n; i++ ) _encoder.add( _mux, _gain, values[i] );
+    size_t len = _encoder.endFrame( frame, sizeof(frame) );
+    if ( len == 0 ) return;
+
+    _bytes += _writer.send( ADS1219_PACKET_RECORD, frame, len );
+    _packets++;
+}
@@ -0,0 +1,284 @@
+#include "ADS1219Record.h"
+#include "ADS1219ScanPlan.h"
+
+
+// Read a varint of at most 5 bytes, returns the number of bytes used, 0 if truncated or too long
+static uint8_t ads1219_get_varint( const uint8_t* data, size_t len, uint32_t* value )
+{
+    uint32_t v = 0;
+    for ( uint8_t n = 0; n < 5 && n < len; n++ ) {
+        v |= static_cast<uint32_t>( data[n] & 0x7F ) << ( 7 * n );
+        if ( ( data[n] & 0x80 ) == 0 ) {
+            *value = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+
+// Layout byte of a sample : mux id in bits 5-7 (the mux bits of the config register), gain in bit 4
+static inline uint8_t ads1219_layout( uint8_t mux, uint8_t gain )
+{
+    return ( mux & 0xE0 ) | ( gain == ADS1219_GAIN_FOUR ? 0x10 : 0x00 );
+}
+
+
+ADS1219RecordEncoder::ADS1219RecordEncoder( bool delta, uint16_t keyframe_interval )
+    : _delta(delta)
+    , _keyframe_interval(keyframe_interval)
+{
+    reset();
+}
+
+
+void ADS1219RecordEncoder::reset( void )
+{
+    _since_keyframe = 0;
+    _have_layout    = false;
+    _last_us        = 0;
+    _frame_us       = 0;
+    _rate           = 0;
+    _size           = 0;
+    _last_rate      = 0;
+    _last_size      = 0;
+}
+
+
+void ADS1219RecordEncoder::beginFrame( unsigned long timestamp_us, uint8_t rate )
+{
+    _frame_us = timestamp_us;
+    _rate     = rate & 0x03;
+    _size     = 0;
+}
+
+
+uint8_t ADS1219RecordEncoder::add( uint8_t mux, uint8_t gain, int32_t value )
+{
+    if ( _size >= ADS1219_RECORD_MAX_SAMPLES ) return ADS1219_RECORD_FULL;
+    if ( value != static_cast<int32_t>(0x80000000) && ( value < -0x800000 || value > 0x7FFFFF ) ) return ADS1219_RECORD_INVALID;
+
+    _layout[_size] = ads1219_layout( mux, gain );
+    _value[_size]  = value;
+    _size++;
+
+    return ADS1219_OK;
+}
+
+
+size_t ADS1219RecordEncoder::endFrame( uint8_t* buf, size_t size )
+{
+    if ( _size == 0 || size < ADS1219_RECORD_MAX_FRAME ) return 0;
+
+    // a keyframe when the layout changes or the interval is up
+    bool keyframe = ! _have_layout || _size != _last_size || _rate != _last_rate
+                 || ( _keyframe_interval > 0 && _since_keyframe + 1 >= _keyframe_interval );
+    for ( uint8_t i = 0; ! keyframe && i < _size; i++ ) keyframe = _layout[i] != _last_layout[i];
+
+    uint8_t mask[2] = { 0, 0 };
+    for ( uint8_t i = 0; i < _size; i++ )
+        if ( _value[i] == static_cast<int32_t>(0x80000000) ) mask[i >> 3] |= 1 << ( i & 7 );
+
+    uint8_t header = _size;
+    if ( keyframe ) header |= ADS1219_RECORD_LAYOUT;
+    if ( _delta ) header |= ADS1219_RECORD_DELTA;
+    if ( mask[0] | mask[1] ) header |= ADS1219_RECORD_MASK;
+
+    size_t n = 0;
+    buf[n++] = header;
+    n += ads1219_put_varint( buf + n, static_cast<uint32_t>( keyframe ? _frame_us : _frame_us - _last_us ) );
+
+    if ( keyframe ) {
+        buf[n++] = _rate;
+        for ( uint8_t i = 0; i < _size; i++ ) buf[n++] = _layout[i];
+
+        _last_rate = _rate;
+        _last_size = _size;
+        for ( uint8_t i = 0; i < _size; i++ ) {
+            _last_layout[i] = _layout[i];
+            _prev[i]        = 0;
+        }
+        _since_keyframe = 0;
+        _have_layout    = true;
+    } else {
+        _since_keyframe++;
+    }
+
+    if ( header & ADS1219_RECORD_MASK ) {
+        buf[n++] = mask[0];
+        if ( _size > 8 ) buf[n++] = mask[1];
+    }
+
+    for ( uint8_t i = 0; i < _size; i++ )
+    {
+        int32_t v = _value[i];
+        if ( v == static_cast<int32_t>(0x80000000) ) continue;
+
+        if ( _delta ) {
+            n += ads1219_put_varint( buf + n, ads1219_zigzag( v - _prev[i] ) );
+        } else {
+            buf[n++] = static_cast<uint8_t>( v >> 16 );
+            buf[n++] = static_cast<uint8_t>( v >> 8 );
+            buf[n++] = static_cast<uint8_t>( v );
+        }
+        _prev[i] = v;
+    }
+
+    _last_us = _frame_us;
+    _size    = 0;
+
+    return n;
+}
+
+
+size_t ADS1219RecordEncoder::encodeScan( const ADS1219ScanPlan& plan, const int32_t* results, unsigned long timestamp_us,
+                                         uint8_t rate, uint8_t gain, uint8_t* buf, size_t size )
+{
+    beginFrame( timestamp_us, rate );
+    for ( uint8_t i = 0; i < plan.size(); i++ ) {
+        const ADS1219ScanEntry& e = plan.entry(i);
+        uint8_t g = e.gain == ADS1219_GAIN_KEEP ? gain : e.gain == ADS1219_GAIN_AUTO ? plan.gain(i) : e.gain;
+        if ( add( e.mux, g, results[i] ) != ADS1219_OK ) {
+            _size = 0;
+            return 0;
+        }
+    }
+    return endFrame( buf, size );
+}
+
+
+ADS1219RecordDecoder::ADS1219RecordDecoder()
+{
+    reset();
+}
+
+
+void ADS1219RecordDecoder::reset( void )
+{
+    _have_layout = false;
+    _time_us     = 0;
+    _rate        = 0;
+    _size        = 0;
+}
+
+
+size_t ADS1219RecordDecoder::decode( const uint8_t* data, size_t len, ADS1219RecordFrame* frame, uint8_t* err )
+{
+    if ( len < 1 ) {
+        *err = ADS1219_RECORD_TRUNCATED;
+        return 0;
+    }
+
+    uint8_t header = data[0];
+    uint8_t count  = header & 0x0F;
+    if ( count == 0 || ( header & ADS1219_RECORD_RESERVED ) ) {
+        *err = ADS1219_RECORD_INVALID;
+        return 0;
+    }
+
+    size_t   n = 1;
+    uint32_t ts;
+    uint8_t  used = ads1219_get_varint( data + n, len - n, &ts );
+    if ( used == 0 ) {
+        *err = len - n >= 5 ? ADS1219_RECORD_INVALID : ADS1219_RECORD_TRUNCATED;
+        return 0;
+    }
+    n += used;
+
+    // the layout goes into the frame first, the decoder state only changes once the whole frame is good
+    bool keyframe = header & ADS1219_RECORD_LAYOUT;
+    const uint8_t* layout = _layout;
+    uint8_t rate = _rate;
+    if ( keyframe ) {
+        if ( len - n < 1u + count ) {
+            *err = ADS1219_RECORD_TRUNCATED;
+            return 0;
+        }
+        rate   = data[n++];
+        layout = data + n;
+        n += count;
+        if ( rate > 3 ) {
+            *err = ADS1219_RECORD_INVALID;
+            return 0;
+        }
+    }
+
+    uint16_t mask = 0;
+    if ( header & ADS1219_RECORD_MASK ) {
+        size_t bytes = count > 8 ? 2 : 1;
+        if ( len - n < bytes ) {
+            *err = ADS1219_RECORD_TRUNCATED;
+            return 0;
+        }
+        mask = data[n++];
+        if ( bytes == 2 ) mask |= static_cast<uint16_t>( data[n++] ) << 8;
+    }
+
+    // before the first keyframe the frame can only be skipped
+    bool known = keyframe || ( _have_layout && count == _size );
+
+    int32_t value[ADS1219_RECORD_MAX_SAMPLES];
+    for ( uint8_t i = 0; i < count; i++ )
+    {
+        if ( mask & ( 1 << i ) ) {
+            value[i] = static_cast<int32_t>(0x80000000);
+            continue;
+        }
+
+        if ( header & ADS1219_RECORD_DELTA ) {
+            uint32_t z;
+            used = ads1219_get_varint( data + n, len - n, &z );
+            if ( used == 0 ) {
+                *err = len - n >= 5 ? ADS1219_RECORD_INVALID : ADS1219_RECORD_TRUNCATED;
+                return 0;
+            }
+            n += used;
+            value[i] = ( keyframe || ! known ? 0 : _prev[i] ) + ads1219_unzigzag( z );
+        } else {
+            if ( len - n < 3 ) {
+                *err = ADS1219_RECORD_TRUNCATED;
+                return 0;
+            }
+            // sign extend the 24 bits
+            uint32_t raw = ( static_cast<uint32_t>( data[n] ) << 16 ) | ( static_cast<uint32_t>( data[n + 1] ) << 8 ) | data[n + 2];
+            value[i] = static_cast<int32_t>( raw << 8 ) >> 8;
+            n += 3;
+        }
+    }
+
+    if ( ! known ) {
+        *err = ADS1219_RECORD_NO_LAYOUT;
+        return n;
+    }
+
+    // keyframes carry the 32 bit micros(), unwrapped against the previous time
+    if ( keyframe ) {
+        uint64_t t = ( _time_us & ~static_cast<uint64_t>(0xFFFFFFFF) ) | ts;
+        if ( _have_layout && t < _time_us ) t += static_cast<uint64_t>(1) << 32;
+        _time_us = t;
+
+        _rate = rate;
+        _size = count;
+        for ( uint8_t i = 0; i < count; i++ ) {
+            _layout[i] = layout[i];
+            _prev[i]   = 0;
+        }
+        _have_layout = true;
+    } else {
+        _time_us += ts;
+    }
+
+    frame->timestamp_us = _time_us;
+    frame->keyframe     = keyframe;
+    frame->rate         = _rate;
+    frame->size         = count;
+    for ( uint8_t i = 0; i < count; i++ ) {
+        frame->mux[i]   = _layout[i] & 0xE0;
+        frame->gain[i]  = _layout[i] & 0x10 ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE;
+        frame->value[i] = value[i];
+        if ( value[i] != static_cast<int32_t>(0x80000000) ) _prev[i] = value[i];
+    }
+
+    *err = ADS1219_OK;
+    return n;
+}
@@ -0,0 +1,72 @@
+#include "ADS1219ScanPlan.h"
+
+
+ADS1219ScanPlan::ADS1219ScanPlan()
+    : _size(0)
+    , _interval_us(0)
+    , _next_us(0)
+    , _start_us(0)
+    , _period_us(0)
+    , _duration_us(0)
+    , _scans(0)
+    , _switches(0)
+    , _redos(0)
+{
+    for ( uint8_t i = 0; i < ADS1219_SCAN_MAX_ENTRIES; i++ ) {
+        _entry_start_us[i] = _entry_end_us[i] = 0;
+        _gain[i] = _next_gain[i] = ADS1219_GAIN_ONE;
+    }
+}
+
+
+uint8_t ADS1219ScanPlan::add( uint8_t mux, uint8_t gain, uint16_t samples, ADS1219Filter* filter )
+{
+    if ( _size >= ADS1219_SCAN_MAX_ENTRIES ) return ADS1219_PLAN_FULL;
+    if ( ! ads1219_valid_mux( mux ) ) return ADS1219_INVALID_MUX;
+    if ( gain != ADS1219_GAIN_KEEP && gain != ADS1219_GAIN_AUTO && gain != ADS1219_GAIN_ONE && gain != ADS1219_GAIN_FOUR ) return ADS1219_INVALID_GAIN;
+
+    _entries[_size].mux     = mux;
+    _entries[_size].gain    = gain;
+    _entries[_size].samples = samples > 0 ? samples : 1;
+    _entries[_size].filter  = filter;
+    _gain[_size] = _next_gain[_size] = gain == ADS1219_GAIN_FOUR ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE;
+    _size++;
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219ScanPlan::setGain( uint8_t i, uint8_t gain )
+{
+    if ( i >= _size ) return ADS1219_INVALID_GAIN;
+    if ( gain != ADS1219_GAIN_KEEP && gain != ADS1219_GAIN_AUTO && gain != ADS1219_GAIN_ONE && gain != ADS1219_GAIN_FOUR ) return ADS1219_INVALID_GAIN;
+
+    _entries[i].gain = gain;
+    _gain[i] = _next_gain[i] = gain == ADS1219_GAIN_FOUR ? ADS1219_GAIN_FOUR : ADS1219_GAIN_ONE;
+
+    return ADS1219_OK;
+}
+
+
+uint8_t ADS1219ScanPlan::addSingleEnded( uint8_t channel, uint8_t gain, uint16_t samples, ADS1219Filter* filter )
+{
+    if ( channel > 3 ) return ADS1219_INVALID_MUX;
+
+    // single ended channels are consecutive mux settings
+    return add( ADS1219_MUX_SINGLE_0 + ( channel << 5 ), gain, samples, filter );
+}
+
+
+void ADS1219ScanPlan::setInterval( unsigned long interval_us )
+{
+    _interval_us = interval_us;
+    _next_us     = micros();
+}
+
+
+float ADS1219ScanPlan::scanRate( void ) const
+{
+    if ( _interval_us > 0 && _scans > 1 && _period_us > 0 ) return 1.e6f / _period_us;
+    if ( _duration_us > 0 ) return 1.e6f / _duration_us;
+    return 0.f;
+}
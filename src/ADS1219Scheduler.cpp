@@ -0,0 +1,131 @@
+#include <math.h>
+
+#include "ADS1219Scheduler.h"
+
+
+ADS1219Scheduler::ADS1219Scheduler( ADS1219& adc, ADS1219ScanPlan& plan )
+    : _adc(adc)
+    , _plan(plan)
+    , _policy(ADS1219_SCHEDULE_SKIP)
+    , _align(ADS1219_ALIGN_RESULT)
+    , _guard_us(200)
+    , _spin_us(2000)
+    , _period_us(0)
+    , _next_us(0)
+    , _tick_us(0)
+    , _lead_us(0)
+    , _error(ADS1219_OK)
+{
+    resetStats();
+}
+
+
+void ADS1219Scheduler::begin( unsigned long period_us, unsigned long first_tick_us )
+{
+    _period_us = period_us;
+    _next_us   = first_tick_us != 0 ? first_tick_us : micros() + period_us;
+    _tick_us   = _next_us - period_us;
+    _lead_us   = _estimate_us();
+    _error     = ADS1219_OK;
+    resetStats();
+}
+
+
+unsigned long ADS1219Scheduler::_estimate_us( void )
+{
+    uint8_t rate = ADS1219_DATARATE_20SPS;
+    _adc.getDataRate( &rate );
+
+    // conversion times with the oscillator tolerance, plus about the bus time of a readout at 100 kHz
+    unsigned long single = ads1219_conversion_us( rate );
+    unsigned long cont   = ads1219_conversion_us( rate, ADS1219_CM_CONTINUOUS );
+    unsigned long us = 0;
+    for ( uint8_t i = 0; i < _plan.size(); i++ ) {
+        uint16_t n = _plan.entry(i).samples;
+        us += single + ( n - 1 ) * cont + 1500UL;
+    }
+
+    return us + us * ADS1219_OSC_TOLERANCE / 100;
+}
+
+
+unsigned long ADS1219Scheduler::nextStart( void ) const
+{
+    return _align == ADS1219_ALIGN_RESULT ? _next_us - _lead_us - _guard_us : _next_us;
+}
+
+
+bool ADS1219Scheduler::run( int32_t* results, uint8_t* err_codes )
+{
+    if ( _period_us == 0 ) return false;
+
+    // not yet : return, or wait for the exact start when it's close
+    unsigned long start_us = nextStart();
+    long wait = static_cast<long>( start_us - micros() );
+    if ( wait > static_cast<long>( _spin_us ) ) return false;
+    while ( static_cast<long>( start_us - micros() ) > 0 ) yield();
+
+    // more than a period late : drop the ticks that went by, on the same grid
+    unsigned long tick_us = _next_us;
+    unsigned long missed  = 0;
+    long late = static_cast<long>( micros() - start_us );
+    if ( _policy == ADS1219_SCHEDULE_SKIP && late >= static_cast<long>( _period_us ) ) {
+        missed    = static_cast<unsigned long>( late ) / _period_us;
+        tick_us  += missed * _period_us;
+        start_us += missed * _period_us;
+    }
+
+    unsigned long t0 = micros();
+    _error = _adc.scan( _plan, results, err_codes );
+    unsigned long t1 = micros();
+
+    // the application has a conversion or stream running : nothing was scanned, keep the tick for later
+    if ( _error == ADS1219_BUSY ) return false;
+
+    _missed  += missed;
+    _tick_us  = tick_us;
+    _next_us  = tick_us + _period_us;
+
+    // follow the scan duration : up at once, down slowly
+    unsigned long d = t1 - t0;
+    if ( d > _lead_us ) _lead_us = d;
+    else _lead_us -= ( _lead_us - d ) >> 3;
+
+    unsigned long jitter = t0 - start_us;
+    _scans++;
+    _jitter_sum  += jitter;
+    _jitter_sum2 += static_cast<uint64_t>( jitter ) * jitter;
+    if ( jitter > _jitter_max_us ) _jitter_max_us = jitter;
+
+    unsigned long deadline = _align == ADS1219_ALIGN_RESULT ? _tick_us : _tick_us + _period_us;
+    long slack = static_cast<long>( deadline - t1 );
+    if ( slack < 0 ) _overruns++;
+    if ( _scans == 1 || slack < _slack_min_us ) _slack_min_us = slack;
+
+    return true;
+}
+
+
+void ADS1219Scheduler::stats( ADS1219ScheduleStats* s ) const
+{
+    s->scans          = _scans;
+    s->missed         = _missed;
+    s->overruns       = _overruns;
+    s->jitter_max_us  = _jitter_max_us;
+    s->jitter_mean_us = _scans ? static_cast<unsigned long>( _jitter_sum / _scans ) : 0;
+    s->jitter_rms_us  = _scans ? static_cast<unsigned long>( sqrt( static_cast<double>( _jitter_sum2 ) / _scans ) + 0.5 ) : 0;
+    s->slack_min_us   = _slack_min_us;
+    s->lead_us        = _lead_us;
+}
+
+
+void ADS1219Scheduler::resetStats( void )
+{
+    _scans         = 0;
+    _missed        = 0;
+    _overruns      = 0;
+    _jitter_max_us = 0;
+    _jitter_sum    = 0;
+    _jitter_sum2   = 0;
+    _slack_min_us  = 0;
+}
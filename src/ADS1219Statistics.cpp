@@ -0,0 +1,44 @@
+#include "ADS1219Statistics.h"
+
+
+void ADS1219RunningStats::reset( void )
+{
+    _n    = 0;
+    _ref  = 0;
+    _sum  = 0;
+    _sum2 = 0;
+    _min  = INT32_MAX;
+    _max  = INT32_MIN;
+}
+
+
+void ADS1219RunningStats::push( int32_t value )
+{
+    if ( _n == 0 ) _ref = value;
+    _n++;
+
+    int64_t d = static_cast<int64_t>( value ) - _ref;
+    _sum  += d;
+    _sum2 += static_cast<uint64_t>( d * d );
+
+    if ( value < _min ) _min = value;
+    if ( value > _max ) _max = value;
+}
+
+
+double ADS1219RunningStats::mean( void ) const
+{
+    if ( _n == 0 ) return 0.;
+    return _ref + static_cast<double>( _sum ) / _n;
+}
+
+
+double ADS1219RunningStats::variance( void ) const
+{
+    if ( _n < 2 ) return 0.;
+
+    // sum of the squared deviations from the mean : sum2 - sum^2 / n
+    double m  = static_cast<double>( _sum ) / _n;
+    double ss = static_cast<double>( _sum2 ) - static_cast<double>( _sum ) * m;
+    return ss > 0. ? ss / ( _n - 1 ) : 0.;
+}
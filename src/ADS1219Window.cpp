@@ -0,0 +1,98 @@
+#include "ADS1219Window.h"
+
+#include <math.h>
+
+
+ADS1219Window::ADS1219Window()
+    : _low_mV(-1e6f), _high_mV(1e6f), _hysteresis_mV(0.f), _vref_mV(2048.f)
+    , _debounce(1), _suppress(false), _fn(nullptr), _context(nullptr)
+{
+    _convert();
+    reset();
+}
+
+
+bool ADS1219Window::setThresholds( float low_mV, float high_mV, float hysteresis_mV )
+{
+    if ( ! ( low_mV < high_mV ) || hysteresis_mV < 0.f || hysteresis_mV >= high_mV - low_mV ) return false;
+
+    _low_mV        = low_mV;
+    _high_mV       = high_mV;
+    _hysteresis_mV = hysteresis_mV;
+    _convert();
+
+    return true;
+}
+
+
+void ADS1219Window::setReference( float vref_mV )
+{
+    if ( vref_mV == _vref_mV ) return;
+
+    _vref_mV = vref_mV;
+    _convert();
+}
+
+
+void ADS1219Window::_convert( void )
+{
+    const float mv[3] = { _low_mV, _high_mV, _hysteresis_mV };
+    int32_t counts[3][2];
+
+    // counts per mV at gain 1, 4 times that at gain 4, clamped well outside the 24 bit range so a threshold
+    // beyond the full scale is never reached
+    for ( uint8_t i = 0; i < 3; i++ ) {
+        for ( uint8_t g = 0; g < 2; g++ ) {
+            float c = mv[i] * 8388608.f / _vref_mV * ( g ? 4.f : 1.f );
+            if ( c > 67108864.f ) c = 67108864.f;
+            if ( c < -67108864.f ) c = -67108864.f;
+            counts[i][g] = static_cast<int32_t>( lroundf( c ) );
+        }
+    }
+
+    for ( uint8_t g = 0; g < 2; g++ ) {
+        _low[g]        = counts[0][g];
+        _high[g]       = counts[1][g];
+        _hysteresis[g] = counts[2][g];
+    }
+}
+
+
+void ADS1219Window::reset( void )
+{
+    _state     = ADS1219_WINDOW_INSIDE;
+    _candidate = ADS1219_WINDOW_INSIDE;
+    _count     = 0;
+    _event     = false;
+    _events    = 0;
+}
+
+
+bool ADS1219Window::check( uint8_t mux, int32_t value, bool gain_four )
+{
+    uint8_t g = gain_four ? 1 : 0;
+
+    // going back in takes the hysteresis on the side the input is out
+    int32_t up   = _state == ADS1219_WINDOW_ABOVE ? _high[g] - _hysteresis[g] : _high[g];
+    int32_t down = _state == ADS1219_WINDOW_BELOW ? _low[g] + _hysteresis[g] : _low[g];
+    uint8_t s    = value > up ? ADS1219_WINDOW_ABOVE : ( value < down ? ADS1219_WINDOW_BELOW : ADS1219_WINDOW_INSIDE );
+
+    if ( s == _state ) {
+        _count = 0;
+        return ! _suppress;
+    }
+
+    if ( s != _candidate || _count == 0 ) {
+        _candidate = s;
+        _count     = 0;
+    }
+    if ( ++_count < _debounce ) return ! _suppress;
+
+    _state  = s;
+    _count  = 0;
+    _event  = true;
+    _events++;
+    if ( _fn != nullptr ) _fn( mux, s, value, _context );
+
+    return true;
+}
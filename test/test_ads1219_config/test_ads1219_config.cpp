@@ -106,6 +106,80 @@ void test_ads1219_set_conversion_mode(void)
     TEST_ASSERT_EQUAL(ADS1219_CM_SINGLE_SHOT, mode);
 }
 
+void test_ads1219_sync_config(void)
+{
+    uint8_t config, synced;
+
+    // change some fields, then reload the register from the device, shadow copy should match
+    TEST_ASSERT_EQUAL(0, adc.setGain(ADS1219_GAIN_FOUR));
+    TEST_ASSERT_EQUAL(0, adc.setDataRate(ADS1219_DATARATE_330SPS));
+    TEST_ASSERT_EQUAL(0, adc.getConfig(&config));
+
+    TEST_ASSERT_EQUAL(0, adc.syncConfig());
+    TEST_ASSERT_EQUAL(0, adc.getConfig(&synced));
+    TEST_ASSERT_EQUAL_HEX8(config, synced);
+
+    // after a reset we should be back at the default
+    TEST_ASSERT_EQUAL(0, adc.reset());
+    TEST_ASSERT_EQUAL(0, adc.getConfig(&config));
+    TEST_ASSERT_EQUAL_HEX8(0x00, config);
+}
+
+void test_ads1219_apply_config(void)
+{
+    ADS1219Config config(ADS1219_MUX_SINGLE_2, ADS1219_GAIN_FOUR, ADS1219_DATARATE_90SPS, 
+                         ADS1219_CM_CONTINUOUS, ADS1219_VREF_EXTERNAL, 500.f, 3000.f);
+    ADS1219Config read;
+    uint8_t value;
+
+    TEST_ASSERT_EQUAL(0, adc.applyConfig(config));
+
+    // the device holds all fields
+    TEST_ASSERT_EQUAL(0, adc.readConfig(&read));
+    TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_2, read.mux);
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, read.gain);
+    TEST_ASSERT_EQUAL(ADS1219_DATARATE_90SPS, read.rate);
+    TEST_ASSERT_EQUAL(ADS1219_CM_CONTINUOUS, read.mode);
+    TEST_ASSERT_EQUAL(ADS1219_VREF_EXTERNAL, read.vref);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 500., read.aref_n);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 3000., read.aref_p);
+    TEST_ASSERT_EQUAL(0, adc.getDataRate(&value));
+    TEST_ASSERT_EQUAL(ADS1219_DATARATE_90SPS, value);
+
+    // invalid fields are rejected before anything changes
+    ADS1219Config invalid;
+    invalid.rate = 4;
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_DATARATE, adc.applyConfig(invalid));
+    invalid = ADS1219Config(ADS1219_MUX_DIFF_0_1, 2);
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_GAIN, adc.applyConfig(invalid));
+    invalid = ADS1219Config(ADS1219_MUX_DIFF_0_1, ADS1219_GAIN_ONE, ADS1219_DATARATE_20SPS, 
+                            ADS1219_CM_SINGLE_SHOT, ADS1219_VREF_EXTERNAL, 1000.f, 1000.f);
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_VREF, adc.applyConfig(invalid));
+    TEST_ASSERT_EQUAL(0, adc.readConfig(&read));
+    TEST_ASSERT_EQUAL_HEX8(config.reg(), read.reg());
+
+    // back to the power-on configuration
+    TEST_ASSERT_EQUAL(0, adc.applyConfig(ADS1219Config()));
+    TEST_ASSERT_EQUAL(0, adc.getConfig(&value));
+    TEST_ASSERT_EQUAL_HEX8(0x00, value);
+}
+
+void test_ads1219_verify_config(void)
+{
+    uint8_t gain, type;
+
+    // with verification enabled, every write is read back from the device
+    adc.setVerify(true);
+    TEST_ASSERT_EQUAL(0, adc.setGain(ADS1219_GAIN_FOUR));
+    TEST_ASSERT_EQUAL(0, adc.setVREF(ADS1219_VREF_EXTERNAL));
+    adc.setVerify(false);
+
+    TEST_ASSERT_EQUAL(0, adc.getGain(&gain));
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, gain);
+    TEST_ASSERT_EQUAL(0, adc.getVREF(&type));
+    TEST_ASSERT_EQUAL(ADS1219_VREF_EXTERNAL, type);
+}
+
 
 void setup()
 {
@@ -123,6 +197,9 @@ void setup()
     RUN_TEST(test_ads1219_set_datarate);
     RUN_TEST(test_ads1219_read_conversion_mode);
     RUN_TEST(test_ads1219_set_conversion_mode);
+    RUN_TEST(test_ads1219_sync_config);
+    RUN_TEST(test_ads1219_verify_config);
+    RUN_TEST(test_ads1219_apply_config);
 
     // Don't forget to make tests for the whole configuration structure and peform different operations in succession
     // to see whether orring of bits is ok
@@ -0,0 +1,260 @@
+#include "unity.h"
+#include "ADS1219.h"
+#include "ADS1219Statistics.h"
+
+// On the host, the emulated device gets the noise of the datasheet figures in ADS1219PowerModel, on
+// hardware the noise is that of the board
+#if defined(__has_include)
+#if __has_include("ADS1219Emulator.h")
+#define TEST_NOISE_EMULATED
+#include "ADS1219Emulator.h"
+#include "ADS1219DutyCycle.h"
+#endif
+#endif
+
+// The streaming statistics against plain references, then the noise sweep over all data rates and gains
+// on the shorted input, printed as a table of ';' separated lines :
+//
+//   noise;rate_sps;gain;samples;mean;stddev;rms_uv;p2p_uv;enob;noise_free_bits;sps;bus_util
+//   allan;rate_sps;gain;tau;adev_uv
+//
+// bus_util is the fraction of the time the bus was busy, from the bus counters (ADS1219_ENABLE_STATS),
+// -1 without them
+
+#define TEST_NOISE_SAMPLES  256
+#define TEST_NOISE_OCTAVES  7
+#define TEST_NOISE_BUS_HZ   400000UL
+
+
+ADS1219 adc;
+
+static const uint8_t rates[] = { ADS1219_DATARATE_20SPS, ADS1219_DATARATE_90SPS, ADS1219_DATARATE_330SPS, ADS1219_DATARATE_1000SPS };
+static const int rate_sps[] = { 20, 90, 330, 1000 };
+static const uint8_t gains[] = { ADS1219_GAIN_ONE, ADS1219_GAIN_FOUR };
+
+
+void setUp(void) {
+    adc.begin();
+    Wire.setClock(TEST_NOISE_BUS_HZ);
+    adc.reset();
+}
+
+void tearDown(void) {
+}
+
+
+// xorshift32 and Box-Muller, the same sequence on every platform
+static uint32_t rng = 1;
+
+static float uniform( void )
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return ( ( rng >> 8 ) + 0.5f ) / 16777216.f;
+}
+
+static float gauss( void )
+{
+    return sqrtf( -2.f * logf( uniform() ) ) * cosf( 6.2831853f * uniform() );
+}
+
+
+void test_ads1219_stats_reference(void)
+{
+    ADS1219RunningStats stats;
+    static int32_t values[1000];
+
+    // near full scale, where a naive float sum of squares would be useless
+    rng = 1;
+    for ( int i = 0; i < 1000; i++ ) {
+        values[i] = 8300000 + static_cast<int32_t>( lroundf( 40.f * gauss() ) );
+        stats.push( values[i] );
+    }
+
+    double sum = 0., ss = 0.;
+    int32_t lo = values[0], hi = values[0];
+    for ( int i = 0; i < 1000; i++ ) {
+        sum += values[i];
+        if ( values[i] < lo ) lo = values[i];
+        if ( values[i] > hi ) hi = values[i];
+    }
+    double mean = sum / 1000.;
+    for ( int i = 0; i < 1000; i++ ) ss += ( values[i] - mean ) * ( values[i] - mean );
+
+    TEST_ASSERT_EQUAL(1000, stats.count());
+    TEST_ASSERT_EQUAL_INT32(lo, stats.min());
+    TEST_ASSERT_EQUAL_INT32(hi, stats.max());
+    TEST_ASSERT_EQUAL_INT32(hi - lo, stats.peakToPeak());
+    TEST_ASSERT_FLOAT_WITHIN(0.01, mean - 8300000., stats.mean() - 8300000.);
+    TEST_ASSERT_FLOAT_WITHIN(0.01, sqrt( ss / 999. ), stats.stddev());
+    TEST_ASSERT_FLOAT_WITHIN(4., 40., stats.stddev());
+
+    stats.reset();
+    TEST_ASSERT_EQUAL(0, stats.count());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0., stats.variance());
+    stats.push( -5 );
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -5., stats.mean());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 0., stats.variance());
+
+    // effective and noise free resolution
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 24., ads1219_effective_bits(0.5f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 20., ads1219_effective_bits(16.f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01, 24. - log2(6.6 * 16.), ads1219_noise_free_bits(16.f));
+}
+
+void test_ads1219_histogram(void)
+{
+    ADS1219Histogram<8> hist;
+    hist.center( 100, 5 );  // 80 to 119
+
+    TEST_ASSERT_EQUAL_INT32(80, hist.binLow(0));
+    TEST_ASSERT_EQUAL_INT32(115, hist.binLow(7));
+
+    int32_t values[] = { 79, 80, 84, 85, 100, 119, 120, -2000000000, 2000000000 };
+    for ( uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++ ) hist.push( values[i] );
+
+    TEST_ASSERT_EQUAL(2, hist.below());
+    TEST_ASSERT_EQUAL(2, hist.above());
+    TEST_ASSERT_EQUAL(2, hist.count(0));
+    TEST_ASSERT_EQUAL(1, hist.count(1));
+    TEST_ASSERT_EQUAL(1, hist.count(4));
+    TEST_ASSERT_EQUAL(1, hist.count(7));
+
+    hist.clear();
+    TEST_ASSERT_EQUAL(0, hist.count(0));
+    TEST_ASSERT_EQUAL(0, hist.below());
+}
+
+void test_ads1219_allan(void)
+{
+    ADS1219AllanDeviation<TEST_NOISE_OCTAVES> allan;
+
+    // a ramp : consecutive block averages differ by tau, the deviation is tau / sqrt(2)
+    for ( int32_t i = 0; i < 1024; i++ ) allan.push( 1000000 + 3 * i );
+    TEST_ASSERT_EQUAL(1024, allan.samples());
+    for ( uint8_t k = 0; k < TEST_NOISE_OCTAVES; k++ ) {
+        TEST_ASSERT_EQUAL(1024 / allan.tau(k) - 1, allan.count(k));
+        TEST_ASSERT_FLOAT_WITHIN(0.0001, 3. * allan.tau(k) / sqrt(2.), allan.deviation(k));
+    }
+
+    // white noise : the deviation falls with sqrt(tau)
+    allan.reset();
+    rng = 7;
+    for ( int i = 0; i < 16384; i++ ) allan.push( static_cast<int32_t>( lroundf( 100.f * gauss() ) ) );
+    for ( uint8_t k = 0; k < TEST_NOISE_OCTAVES; k++ ) {
+        float expected = 100.f / sqrtf( static_cast<float>( allan.tau(k) ) );
+        TEST_ASSERT_FLOAT_WITHIN(0.15f * expected, expected, allan.deviation(k));
+    }
+}
+
+
+// one point of the sweep : streams the shorted input and prints its line of the table
+static void sweep( uint8_t r, uint8_t g )
+{
+    ADS1219RunningStats stats;
+    ADS1219AllanDeviation<TEST_NOISE_OCTAVES> allan;
+    unsigned long period_us = ads1219_conversion_us( rates[r], ADS1219_CM_CONTINUOUS );
+    unsigned long t_first = 0, t_last = 0;
+    uint8_t retcode;
+
+#ifdef TEST_NOISE_EMULATED
+    ADS1219PowerModel model;
+    ADS1219Device.setNoise( model.noise( rates[r], gains[g] ) * gains[g] * 8388608.f / 2048000.f, 11 + r * 2 + g );
+#endif
+
+    adc.setGain( gains[g] );
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.startStream( ADS1219_MUX_SHORTED, rates[r] ));
+#ifdef ADS1219_ENABLE_STATS
+    adc.resetStats();
+#endif
+
+    // sleep through half the conversion after a sample, then check back every 1/16th of the period, so the
+    // status polls don't fill the bus
+    while ( stats.count() < TEST_NOISE_SAMPLES ) {
+        retcode = adc.serviceStream();
+        TEST_ASSERT_EQUAL(ADS1219_OK, retcode);
+
+        int32_t value;
+        if ( adc.readBuffered( &value, 1 ) == 0 ) {
+            delayMicroseconds( period_us / 16 );
+            continue;
+        }
+        t_last = micros();
+        if ( stats.count() == 0 ) t_first = t_last;
+        stats.push( value );
+        allan.push( value );
+        delayMicroseconds( period_us / 2 );
+    }
+    unsigned long elapsed_us = t_last - t_first;
+
+    float bus_util = -1.f;
+#ifdef ADS1219_ENABLE_STATS
+    // 9 clocks per byte with the address byte, and about a clock for the START and STOP
+    ADS1219Stats bus;
+    adc.stats( &bus );
+    uint32_t transactions = bus.writes + bus.reads;
+    float bus_us = ( 9.f * ( bus.bytes_written + bus.bytes_read + transactions ) + 2.f * transactions ) * 1e6f / TEST_NOISE_BUS_HZ;
+    bus_util = bus_us / elapsed_us;
+#endif
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.stopStream());
+    TEST_ASSERT_EQUAL(0, adc.overruns());
+
+    float uv_per_count = 2048000.f / ( gains[g] * 8388608.f );
+    float rms = static_cast<float>( stats.stddev() );
+    float sps = ( stats.count() - 1 ) * 1e6f / elapsed_us;
+
+    Serial.print("noise;"); Serial.print(rate_sps[r]); Serial.print(";"); Serial.print(gains[g]); Serial.print(";");
+    Serial.print(static_cast<unsigned long>(stats.count())); Serial.print(";");
+    Serial.print(stats.mean(), 2); Serial.print(";"); Serial.print(rms, 3); Serial.print(";");
+    Serial.print(rms * uv_per_count, 4); Serial.print(";"); Serial.print(stats.peakToPeak() * uv_per_count, 4); Serial.print(";");
+    Serial.print(ads1219_effective_bits( rms ), 2); Serial.print(";"); Serial.print(ads1219_noise_free_bits( rms ), 2); Serial.print(";");
+    Serial.print(sps, 1); Serial.print(";"); Serial.println(bus_util, 4);
+
+    for ( uint8_t k = 0; k < TEST_NOISE_OCTAVES; k++ ) {
+        if ( allan.count(k) == 0 ) break;
+        Serial.print("allan;"); Serial.print(rate_sps[r]); Serial.print(";"); Serial.print(gains[g]); Serial.print(";");
+        Serial.print(static_cast<unsigned long>(allan.tau(k))); Serial.print(";");
+        Serial.println(allan.deviation(k) * uv_per_count, 4);
+    }
+
+    // the device keeps its data rate : a little faster on the host, within the oscillator tolerance on hardware
+    TEST_ASSERT_FLOAT_WITHIN(0.1f * rate_sps[r], rate_sps[r], sps);
+    TEST_ASSERT_TRUE(ads1219_effective_bits( rms ) > 15.f);
+
+#ifdef TEST_NOISE_EMULATED
+    float expected = model.noise( rates[r], gains[g] ) / uv_per_count;
+    TEST_ASSERT_FLOAT_WITHIN(0.2f * expected, expected, rms);
+    TEST_ASSERT_FLOAT_WITHIN(0.3f * expected, expected, allan.deviation(0));
+    TEST_ASSERT_TRUE(bus_util > 0.f && bus_util < 1.f);
+    ADS1219Device.setNoise( 0.f );
+#endif
+}
+
+void test_ads1219_noise_sweep(void)
+{
+    Serial.println("noise;rate_sps;gain;samples;mean;stddev;rms_uv;p2p_uv;enob;noise_free_bits;sps;bus_util");
+    Serial.println("allan;rate_sps;gain;tau;adev_uv");
+
+    for ( uint8_t r = 0; r < 4; r++ ) {
+        for ( uint8_t g = 0; g < 2; g++ ) sweep( r, g );
+    }
+}
+
+
+void setup()
+{
+    delay(2000);
+
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ads1219_stats_reference);
+    RUN_TEST(test_ads1219_histogram);
+    RUN_TEST(test_ads1219_allan);
+    RUN_TEST(test_ads1219_noise_sweep);
+
+    UNITY_END();
+}
+
+void loop(){}
@@ -1,5 +1,6 @@
 #include "unity.h"
 #include "ADS1219.h"
+#include "ADS1219Statistics.h"
 
 
 #define TEST_ADS1219_VARIANCE_NUM 100
@@ -65,69 +66,53 @@ void test_ads1219_readShorted_offset_mV(void)
 
 void test_ads1219_readShorted_stddev_mV(void)
 {
-    // Apply Welford's method to compute the sample variance for reading each channel
+    // Streaming (Welford style) sample variance of the readings
     // Test whether resulting std is smaller than 0.001 mV
     uint8_t retcode;
-    int32_t value;    
-    float fvalue, var_mV, mean_mV, tmp;
+    int32_t value;
+    ADS1219RunningStats stats;
 
     TEST_ASSERT_EQUAL(0, adc.reset());
 
-    var_mV = 0.;
-    mean_mV = 0.;
-    
     for (uint8_t j=0; j<TEST_ADS1219_VARIANCE_NUM; j++)
     {
         value = adc.readShorted(&retcode);
         TEST_ASSERT_EQUAL(0, retcode);
-
-        fvalue = adc.milliVolts(value, ADS1219_GAIN_ONE, &retcode );
-        TEST_ASSERT_EQUAL(0, retcode);
-
-        tmp = mean_mV;
-        mean_mV += ( fvalue - mean_mV)/(j+1);
-        var_mV += ( fvalue - mean_mV)*(fvalue - tmp);
-        Serial.println(var_mV);
+        stats.push(value);
     }
 
     // compute sample stddev
-    var_mV = sqrt(var_mV/(TEST_ADS1219_VARIANCE_NUM-1));
+    float std_mV = stats.stddev() * adc.milliVolts(1, ADS1219_GAIN_ONE, &retcode );
+    TEST_ASSERT_EQUAL(0, retcode);
+    Serial.println(std_mV, 6);
 
-    TEST_ASSERT_FLOAT_WITHIN( 0.001, 0., var_mV);
+    TEST_ASSERT_FLOAT_WITHIN( 0.001, 0., std_mV);
 }
 
 
 void test_ads1219_readSingleEnded_stddev_mV(uint8_t chan)
 {
-    // Apply Welford's method to compute the sample variance for reading each channel
+    // Streaming (Welford style) sample variance of the readings on each channel
     // Test whether resulting std is smaller than 0.001 mV
     uint8_t retcode;
-    int32_t value;    
-    float fvalue, var_mV, mean_mV, tmp;
+    int32_t value;
+    ADS1219RunningStats stats;
 
     TEST_ASSERT_EQUAL(0, adc.reset());
 
-    var_mV = 0.;
-    mean_mV = 0.;
-    
     for (uint8_t j=0; j<TEST_ADS1219_VARIANCE_NUM; j++)
     {
         value = adc.readSingleEnded(chan, &retcode);
         TEST_ASSERT_EQUAL(0, retcode);
-
-        fvalue = adc.milliVolts(value, ADS1219_GAIN_ONE, &retcode );
-        TEST_ASSERT_EQUAL(0, retcode);
-
-        tmp = mean_mV;
-        mean_mV += ( fvalue - mean_mV)/(j+1);
-        var_mV += ( fvalue - mean_mV)*(fvalue - tmp);
-        Serial.println(var_mV);
+        stats.push(value);
     }
 
     // compute sample stddev
-    var_mV = sqrt(var_mV/(TEST_ADS1219_VARIANCE_NUM-1));
+    float std_mV = stats.stddev() * adc.milliVolts(1, ADS1219_GAIN_ONE, &retcode );
+    TEST_ASSERT_EQUAL(0, retcode);
+    Serial.println(std_mV, 6);
 
-    TEST_ASSERT_FLOAT_WITHIN( 0.001, 0., var_mV);
+    TEST_ASSERT_FLOAT_WITHIN( 0.001, 0., std_mV);
 }
 
 void test_ads1219_readSingleEnded_stddev_mV_ch0(void)
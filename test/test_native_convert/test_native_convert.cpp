@@ -0,0 +1,128 @@
+#include "unity.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219Emulator.h"
+
+// Fixed point batch conversion against the scalar milliVolts(), with a host benchmark of both
+
+#define TEST_CONVERT_NUM 4096
+
+ADS1219 adc;
+
+int32_t counts[TEST_CONVERT_NUM];
+int32_t micro[TEST_CONVERT_NUM];
+float   milli[TEST_CONVERT_NUM];
+
+
+void setUp(void) 
+{
+    ADS1219Device.powerCycle();
+    adc.begin();
+    adc.reset();
+
+    // spread over the full 24 bit range, including both ends
+    for ( int32_t i = 0; i < TEST_CONVERT_NUM; i++ ) 
+        counts[i] = -8388608 + static_cast<int32_t>( ( 16777215LL * i ) / ( TEST_CONVERT_NUM - 1 ) );
+}
+
+void tearDown(void) 
+{
+}
+
+
+static int32_t reference_uV( int32_t count, double span_mV )
+{
+    return static_cast<int32_t>( floor( count * span_mV * 1000. / 8388608. + 0.5 ) );
+}
+
+void test_native_micro_volts_internal(void)
+{
+    adc.toMicroVolts(counts, micro, TEST_CONVERT_NUM);
+    for ( int32_t i = 0; i < TEST_CONVERT_NUM; i++ ) 
+        TEST_ASSERT_EQUAL_INT32(reference_uV(counts[i], 2048.), micro[i]);
+
+    TEST_ASSERT_EQUAL_INT32(-2048000, micro[0]);
+    TEST_ASSERT_EQUAL_INT32(2048000, micro[TEST_CONVERT_NUM-1]); // 2047999.76 rounds up
+}
+
+void test_native_micro_volts_gain_four(void)
+{
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setGain(ADS1219_GAIN_FOUR));
+
+    adc.toMicroVolts(counts, micro, TEST_CONVERT_NUM);
+    for ( int32_t i = 0; i < TEST_CONVERT_NUM; i++ ) 
+        TEST_ASSERT_EQUAL_INT32(reference_uV(counts[i], 512.), micro[i]);
+
+    // halves round up, also for negative values (1 count = 125/2048 µV at gain 4)
+    int32_t c[2] = { -8192, 8192 };  // exactly -/+ 500 µV
+    int32_t h[2] = { -1024, 1024 };  // exactly -/+ 62.5 µV
+    adc.toMicroVolts(c, c, 2);
+    adc.toMicroVolts(h, h, 2);
+    TEST_ASSERT_EQUAL_INT32(-500, c[0]);
+    TEST_ASSERT_EQUAL_INT32(500, c[1]);
+    TEST_ASSERT_EQUAL_INT32(-62, h[0]);
+    TEST_ASSERT_EQUAL_INT32(63, h[1]);
+}
+
+void test_native_micro_volts_external(void)
+{
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setVREF(ADS1219_VREF_EXTERNAL, 500.f, 5000.f));
+
+    adc.toMicroVolts(counts, micro, TEST_CONVERT_NUM);
+    for ( int32_t i = 0; i < TEST_CONVERT_NUM; i++ ) 
+        TEST_ASSERT_INT_WITHIN(1, reference_uV(counts[i], 4500.), micro[i]);
+}
+
+void test_native_milli_volts_batch(void)
+{
+    uint8_t err;
+
+    adc.toMilliVolts(counts, milli, TEST_CONVERT_NUM);
+    for ( int32_t i = 0; i < TEST_CONVERT_NUM; i++ ) 
+        TEST_ASSERT_FLOAT_WITHIN(1e-4, adc.milliVolts(counts[i], ADS1219_GAIN_ONE, &err), milli[i]);
+}
+
+void test_native_convert_benchmark(void)
+{
+    using clock = std::chrono::steady_clock;
+    const int rounds = 200;
+    uint8_t err;
+    volatile float sink = 0.f;
+
+    clock::time_point t0 = clock::now();
+    for ( int r = 0; r < rounds; r++ ) 
+        for ( int32_t i = 0; i < TEST_CONVERT_NUM; i++ ) milli[i] = adc.milliVolts(counts[i], ADS1219_GAIN_ONE, &err);
+    sink = milli[7];
+    clock::time_point t1 = clock::now();
+    for ( int r = 0; r < rounds; r++ ) adc.toMilliVolts(counts, milli, TEST_CONVERT_NUM);
+    sink = milli[7];
+    clock::time_point t2 = clock::now();
+    for ( int r = 0; r < rounds; r++ ) adc.toMicroVolts(counts, micro, TEST_CONVERT_NUM);
+    sink = micro[7];
+    clock::time_point t3 = clock::now();
+    (void) sink;
+
+    double n = static_cast<double>(rounds) * TEST_CONVERT_NUM;
+    printf("milliVolts   : %6.2f ns/sample\n", std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+    printf("toMilliVolts : %6.2f ns/sample\n", std::chrono::duration<double, std::nano>(t2 - t1).count() / n);
+    printf("toMicroVolts : %6.2f ns/sample\n", std::chrono::duration<double, std::nano>(t3 - t2).count() / n);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_micro_volts_internal);
+    RUN_TEST(test_native_micro_volts_gain_four);
+    RUN_TEST(test_native_micro_volts_external);
+    RUN_TEST(test_native_milli_volts_batch);
+    RUN_TEST(test_native_convert_benchmark);
+
+    UNITY_END();
+}
+
+void loop(){}
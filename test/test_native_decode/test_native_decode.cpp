@@ -0,0 +1,337 @@
+#include "unity.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#include "ADS1219.h"
+#include "ADS1219Packet.h"
+#include "ADS1219Emulator.h"
+
+// tools/ads1219_decode, built into this test and run in a child process : the argument checks, a capture
+// file to CSV and binary records, the sample limit, a damaged capture, and a serial port (pseudo terminal)
+// put in raw mode with -t. Linux only.
+
+#if defined(__linux__)
+#define main ads1219_decode_main
+#include "../../tools/ads1219_decode/ads1219_decode.cpp"
+#undef main
+#endif
+
+#define TEST_DRDY_PIN 5
+
+ADS1219Emulator emu_drdy(Wire, 0x41, TEST_DRDY_PIN);
+ADS1219 adc_drdy(0x41, TEST_DRDY_PIN);
+
+
+void setUp(void)
+{
+    emu_drdy.powerCycle();
+    adc_drdy.begin();
+    adc_drdy.reset();
+    emu_drdy.setInput(0, 1000.f);
+    emu_drdy.setNoise(8.f, 9);
+}
+
+void tearDown(void)
+{
+}
+
+
+#if defined(__linux__)
+
+// Print into memory, or into a file descriptor
+class CapturePrint : public Print {
+public:
+    explicit CapturePrint( int fd = -1 ) : _fd(fd) {}
+    size_t write( uint8_t c ) override { return write(&c, 1); }
+    size_t write( const uint8_t* buffer, size_t size ) override {
+        if ( _fd < 0 ) {
+            data.insert(data.end(), buffer, buffer + size);
+            return size;
+        }
+        size_t n = 0;
+        while ( n < size ) {
+            ssize_t w = ::write(_fd, buffer + n, size - n);
+            if ( w <= 0 ) break;
+            n += static_cast<size_t>( w );
+        }
+        return n;
+    }
+    std::vector<uint8_t> data;
+private:
+    int _fd;
+};
+
+static void collect( const ADS1219PacketSample& s, void* context )
+{
+    static_cast<std::vector<ADS1219PacketSample>*>( context )->push_back( s );
+}
+
+// AIN0 at 1000 SPS for duration_us
+static void stream_for( Print& out, unsigned long duration_us )
+{
+    ADS1219PacketStream stream(adc_drdy, out);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+    unsigned long t0 = micros();
+    while ( micros() - t0 < duration_us ) {
+        delayMicroseconds(250);
+        TEST_ASSERT_EQUAL(ADS1219_OK, stream.service());
+    }
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.end());
+}
+
+static char dir[] = "/tmp/ads1219_decode_XXXXXX";
+
+static std::string path( const char* name )
+{
+    return std::string(dir) + "/" + name;
+}
+
+static void write_file( const std::string& name, const std::vector<uint8_t>& data )
+{
+    FILE* f = fopen(name.c_str(), "wb");
+    TEST_ASSERT_NOT_NULL(f);
+    TEST_ASSERT_EQUAL(data.size(), fwrite(data.data(), 1, data.size(), f));
+    fclose(f);
+}
+
+static std::vector<uint8_t> read_file( const std::string& name )
+{
+    std::vector<uint8_t> data;
+    FILE* f = fopen(name.c_str(), "rb");
+    TEST_ASSERT_NOT_NULL(f);
+    int c;
+    while ( ( c = fgetc(f) ) != EOF ) data.push_back(static_cast<uint8_t>( c ));
+    fclose(f);
+    return data;
+}
+
+static std::vector<std::string> read_lines( const std::string& name )
+{
+    std::vector<uint8_t> data = read_file(name);
+    std::vector<std::string> lines;
+    std::string line;
+    for ( size_t i = 0; i < data.size(); i++ ) {
+        if ( data[i] == '\n' ) {
+            lines.push_back(line);
+            line.clear();
+        } else {
+            line += static_cast<char>( data[i] );
+        }
+    }
+    return lines;
+}
+
+// run ads1219_decode with the arguments in a child process, its stderr to decode.err, returns the exit
+// status, -1 if it didn't exit (killed after 10 s)
+static int decode( std::vector<std::string> args )
+{
+    args.insert(args.begin(), "ads1219_decode");
+    std::vector<char*> argv;
+    for ( size_t i = 0; i < args.size(); i++ ) argv.push_back(&args[i][0]);
+    argv.push_back(nullptr);
+
+    fflush(nullptr);
+    pid_t pid = fork();
+    if ( pid == 0 ) {
+        alarm(10);
+        if ( freopen(path("decode.err").c_str(), "w", stderr) == nullptr ) _exit(100);
+        int code = ads1219_decode_main(static_cast<int>( argv.size() ) - 1, argv.data());
+        fflush(nullptr);
+        _exit(code);
+    }
+    TEST_ASSERT_TRUE(pid > 0);
+
+    int status;
+    TEST_ASSERT_EQUAL(pid, waitpid(pid, &status, 0));
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// a CSV line as ads1219_decode writes it
+static std::string csv_line( const ADS1219PacketSample& s )
+{
+    char line[64];
+    snprintf(line, sizeof(line), "%llu,%u,AIN0,%u,%ld", static_cast<unsigned long long>( s.time_us ), s.seq, s.gain,
+             static_cast<long>( s.value ));
+    return line;
+}
+
+
+void test_native_decode_arguments(void)
+{
+    write_file(path("empty.bin"), std::vector<uint8_t>());
+
+    TEST_ASSERT_EQUAL(2, decode({}));
+    TEST_ASSERT_EQUAL(2, decode({ "-t" }));
+    TEST_ASSERT_EQUAL(2, decode({ path("empty.bin"), path("empty.bin") }));
+    TEST_ASSERT_EQUAL(1, decode({ path("missing.bin") }));
+    TEST_ASSERT_EQUAL(1, decode({ "-c", path("missing/out.csv"), path("empty.bin") }));
+    TEST_ASSERT_EQUAL(1, decode({ "-b", path("missing/out.bin"), path("empty.bin") }));
+
+    // -t on a file which isn't a terminal
+    TEST_ASSERT_EQUAL(1, decode({ "-t", path("empty.bin") }));
+
+    // nothing to decode is no error
+    TEST_ASSERT_EQUAL(0, decode({ "-c", path("empty.csv"), path("empty.bin") }));
+    std::vector<std::string> lines = read_lines(path("empty.csv"));
+    TEST_ASSERT_EQUAL(1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("time_us,seq,mux,gain,counts", lines[0].c_str());
+}
+
+void test_native_decode_capture(void)
+{
+    CapturePrint out;
+    std::vector<ADS1219PacketSample> samples;
+    ADS1219PacketDecoder decoder(collect, &samples);
+
+    stream_for(out, 300000UL);
+    decoder.push(out.data.data(), out.data.size());
+    TEST_ASSERT_INT_WITHIN(2, 296, samples.size());
+    write_file(path("capture.bin"), out.data);
+
+    TEST_ASSERT_EQUAL(0, decode({ "-c", path("out.csv"), "-b", path("out.bin"), path("capture.bin") }));
+
+    // CSV : the header and a line per sample, as the library decoder sees them
+    std::vector<std::string> lines = read_lines(path("out.csv"));
+    TEST_ASSERT_EQUAL(samples.size() + 1, lines.size());
+    TEST_ASSERT_EQUAL_STRING("time_us,seq,mux,gain,counts", lines[0].c_str());
+    for ( size_t i = 0; i < samples.size(); i++ ) TEST_ASSERT_EQUAL_STRING(csv_line(samples[i]).c_str(), lines[i + 1].c_str());
+
+    // binary : 16 byte little endian records
+    std::vector<uint8_t> bin = read_file(path("out.bin"));
+    TEST_ASSERT_EQUAL(16 * samples.size(), bin.size());
+    for ( size_t i = 0; i < samples.size(); i++ ) {
+        const uint8_t* r = &bin[16 * i];
+        uint64_t t = 0;
+        uint32_t v = 0;
+        for ( int k = 7; k >= 0; k-- ) t = ( t << 8 ) | r[k];
+        for ( int k = 3; k >= 0; k-- ) v = ( v << 8 ) | r[8 + k];
+        TEST_ASSERT_TRUE(t == samples[i].time_us);
+        TEST_ASSERT_EQUAL_INT32(samples[i].value, static_cast<int32_t>( v ));
+        TEST_ASSERT_EQUAL(ADS1219_MUX_SINGLE_0 >> 5, r[12]);
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, r[13]);
+        TEST_ASSERT_EQUAL(samples[i].seq, r[14] | ( r[15] << 8 ));
+    }
+
+    // exactly the limit
+    TEST_ASSERT_EQUAL(0, decode({ "-n", "100", "-c", path("limit.csv"), path("capture.bin") }));
+    lines = read_lines(path("limit.csv"));
+    TEST_ASSERT_EQUAL(101, lines.size());
+    TEST_ASSERT_EQUAL_STRING(csv_line(samples[99]).c_str(), lines[100].c_str());
+
+    // a damaged packet : the exit status says so, the samples are those the library decoder gets, up to
+    // the next keyframe left out
+    std::vector<uint8_t> damaged = out.data;
+    damaged[damaged.size() / 4] ^= 0x55;
+    write_file(path("damaged.bin"), damaged);
+    std::vector<ADS1219PacketSample> kept;
+    ADS1219PacketDecoder damaged_decoder(collect, &kept);
+    damaged_decoder.push(damaged.data(), damaged.size());
+    TEST_ASSERT_TRUE(kept.size() > 0 && kept.size() < samples.size());
+
+    TEST_ASSERT_EQUAL(3, decode({ "-c", path("damaged.csv"), path("damaged.bin") }));
+    lines = read_lines(path("damaged.csv"));
+    TEST_ASSERT_EQUAL(kept.size() + 1, lines.size());
+    for ( size_t i = 0; i < kept.size(); i++ ) TEST_ASSERT_EQUAL_STRING(csv_line(kept[i]).c_str(), lines[i + 1].c_str());
+}
+
+void test_native_decode_pty(void)
+{
+    int master, slave;
+    char name[64];
+    TEST_ASSERT_EQUAL(0, openpty(&master, &slave, name, nullptr, nullptr));
+
+    // the slave starts in canonical mode, which would hold the bytes back until a newline and translate CR
+    struct termios t;
+    TEST_ASSERT_EQUAL(0, tcgetattr(slave, &t));
+    TEST_ASSERT_TRUE(t.c_lflag & ICANON);
+
+    fflush(nullptr);
+    pid_t pid = fork();
+    if ( pid == 0 ) {
+        close(master);
+        alarm(10);
+        if ( freopen(path("pty.err").c_str(), "w", stderr) == nullptr ) _exit(100);
+        std::string csv = path("pty.csv");
+        char* argv[] = { const_cast<char*>( "ads1219_decode" ), const_cast<char*>( "-t" ), const_cast<char*>( "-n" ),
+                         const_cast<char*>( "300" ), const_cast<char*>( "-c" ), &csv[0], name, nullptr };
+        int code = ads1219_decode_main(7, argv);
+        fflush(nullptr);
+        _exit(code);
+    }
+    TEST_ASSERT_TRUE(pid > 0);
+
+    // wait for the tool to switch the port to raw mode before sending
+    for ( int i = 0; i < 1000; i++ ) {
+        TEST_ASSERT_EQUAL(0, tcgetattr(slave, &t));
+        if ( ! ( t.c_lflag & ICANON ) ) break;
+        usleep(1000);
+    }
+    TEST_ASSERT_FALSE(t.c_lflag & ICANON);
+    TEST_ASSERT_FALSE(t.c_iflag & ICRNL);
+
+    CapturePrint out(master);
+    stream_for(out, 500000UL);
+
+    int status;
+    TEST_ASSERT_EQUAL(pid, waitpid(pid, &status, 0));
+    TEST_ASSERT_TRUE(WIFEXITED(status));
+    TEST_ASSERT_EQUAL(0, WEXITSTATUS(status));
+
+    std::vector<std::string> lines = read_lines(path("pty.csv"));
+    TEST_ASSERT_EQUAL(301, lines.size());
+    for ( size_t i = 1; i < lines.size(); i++ ) {
+        unsigned long long time_us;
+        unsigned seq, gain;
+        char mux[16];
+        long value;
+        TEST_ASSERT_EQUAL(5, sscanf(lines[i].c_str(), "%llu,%u,%15[^,],%u,%ld", &time_us, &seq, mux, &gain, &value));
+        TEST_ASSERT_EQUAL_STRING("AIN0", mux);
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, gain);
+        TEST_ASSERT_INT_WITHIN(60, 4096000, value);
+    }
+
+    close(slave);
+    close(master);
+}
+
+static void remove_files( void )
+{
+    static const char* names[] = { "empty.bin", "empty.csv", "capture.bin", "out.csv", "out.bin", "limit.csv",
+                                   "damaged.bin", "damaged.csv", "pty.csv", "decode.err", "pty.err" };
+    for ( size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++ ) unlink(path(names[i]).c_str());
+    rmdir(dir);
+}
+
+#endif
+
+
+void setup()
+{
+    delay(2000);
+
+    UNITY_BEGIN();
+
+#if defined(__linux__)
+    if ( mkdtemp(dir) == nullptr ) perror(dir);
+    RUN_TEST(test_native_decode_arguments);
+    RUN_TEST(test_native_decode_capture);
+    RUN_TEST(test_native_decode_pty);
+    remove_files();
+#endif
+
+    UNITY_END();
+}
+
+void loop(){}
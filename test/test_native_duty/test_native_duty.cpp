@@ -0,0 +1,198 @@
+#include "unity.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219DutyCycle.h"
+#include "ADS1219Emulator.h"
+
+// Duty cycled bursts : the choice of the data rate, the device powered down between bursts and the energy 
+// estimate against the time the emulated device spends in each power state
+
+ADS1219 adc;
+ADS1219ScanPlan plan;
+int32_t results[4];
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    adc.begin();
+    adc.reset();
+
+    plan.clear();
+    for ( uint8_t i = 0; i < 4; i++ ) {
+        plan.addSingleEnded(i);
+        ADS1219Device.setInput(i, 100.f * ( i + 1 ));
+    }
+}
+
+void tearDown(void)
+{
+}
+
+
+void test_native_duty_best_rate(void)
+{
+    ADS1219DutyCycle duty(adc, plan);
+    uint8_t rate;
+    uint16_t n;
+
+    // a single conversion at the fastest rate is enough
+    TEST_ASSERT_TRUE(duty.bestRate(10.f, ADS1219_GAIN_ONE, &rate, &n));
+    TEST_ASSERT_EQUAL(ADS1219_DATARATE_1000SPS, rate);
+    TEST_ASSERT_EQUAL(1, n);
+
+    // the choice is the shortest burst of all rates which reach the level
+    const float levels[] = { 5.f, 3.f, 2.f, 1.5f, 0.7f, 0.5f, 0.3f };
+    for ( float level : levels ) {
+        TEST_ASSERT_TRUE(duty.bestRate(level, ADS1219_GAIN_ONE, &rate, &n));
+        float noise = duty.model().noise(rate, ADS1219_GAIN_ONE) / sqrtf(n);
+        TEST_ASSERT_TRUE(noise <= level * 1.001f);
+        for ( uint8_t r = 0; r < 4; r++ ) {
+            float ratio = duty.model().noise(r, ADS1219_GAIN_ONE) / level;
+            uint16_t m = static_cast<uint16_t>( ceilf( ratio * ratio - 1e-4f ) );
+            TEST_ASSERT_TRUE(ADS1219DutyCycle::burstTime(rate, n) <= ADS1219DutyCycle::burstTime(r, m > 0 ? m : 1));
+        }
+        printf("%.1f uV : rate %u, %u samples, %lu us per entry\n", level, rate, n, ADS1219DutyCycle::burstTime(rate, n));
+    }
+
+    // out of reach
+    TEST_ASSERT_FALSE(duty.bestRate(0.01f, ADS1219_GAIN_ONE, &rate, &n));
+}
+
+void test_native_duty_bursts(void)
+{
+    ADS1219DutyCycle duty(adc, plan);
+    ADS1219DutyStats st;
+    uint8_t best, rate;
+    uint16_t n;
+
+    TEST_ASSERT_TRUE(duty.bestRate(2.f, ADS1219_GAIN_ONE, &best, &n));
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.setNoise(2.f));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.getDataRate(&rate));
+    TEST_ASSERT_EQUAL(best, rate);
+    TEST_ASSERT_EQUAL(n, plan.entry(0).samples);
+    TEST_ASSERT_GREATER_THAN(1, plan.entry(0).samples);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.begin(1000000UL));
+    ADS1219Device.resetCounters();
+
+    // a burst per second for 20 s, the device is powered down in between
+    for ( int b = 0; b < 20; ) {
+        if ( duty.run(results) ) {
+            TEST_ASSERT_EQUAL(ADS1219_OK, duty.lastError());
+            TEST_ASSERT_TRUE(ADS1219Device.poweredDown() || ADS1219Device.converting());
+            for ( uint8_t i = 0; i < 4; i++ ) TEST_ASSERT_INT_WITHIN(2, 409600 * ( i + 1 ), results[i]);
+            b++;
+        }
+        else delay(10);
+    }
+    // finish the last interval
+    while ( static_cast<long>( micros() - duty.nextBurst() ) < 0 ) delay(10);
+    duty.run(results);
+    duty.stats(&st);
+
+    uint64_t down = ADS1219Device.powerStateTime(ADS1219_EMU_POWERDOWN);
+    uint64_t idle = ADS1219Device.powerStateTime(ADS1219_EMU_IDLE);
+    uint64_t conv = ADS1219Device.powerStateTime(ADS1219_EMU_CONVERTING);
+    printf("rate %u, %u samples : %lu bursts, on %lu us, off %lu us, duty %.4f, %.3f uJ/sample, %.2f uA average\n",
+           rate, plan.entry(0).samples, static_cast<unsigned long>(st.bursts), static_cast<unsigned long>(st.on_us),
+           static_cast<unsigned long>(st.off_us), st.duty, st.energy_per_sample_uj, st.average_ua);
+    printf("emulator : powered down %lu us, idle %lu us, converting %lu us\n", static_cast<unsigned long>(down),
+           static_cast<unsigned long>(idle), static_cast<unsigned long>(conv));
+
+    TEST_ASSERT_EQUAL(21, st.bursts);
+    TEST_ASSERT_EQUAL(84, st.samples);
+    TEST_ASSERT_TRUE(st.duty < 0.1f);
+
+    // the measured times match the power states of the device : it's only up during the bursts
+    uint64_t total = down + idle + conv;
+    TEST_ASSERT_UINT32_WITHIN(total / 100, st.on_us, idle + conv);
+    TEST_ASSERT_UINT32_WITHIN(conv / 20, st.converting_us, conv);
+
+    // energy from the emulator times with the same model
+    const ADS1219PowerModel& m = duty.model();
+    double uj = m.supply_v * 1e-6 * ( m.converting_ua * conv + m.idle_ua * idle + m.powerdown_ua * down );
+    TEST_ASSERT_FLOAT_WITHIN(uj * 0.05f, uj, st.energy_uj);
+
+    // staying powered up in between would cost at least the idle current
+    TEST_ASSERT_TRUE(st.average_ua < m.idle_ua / 5);
+}
+
+void test_native_duty_gain(void)
+{
+    ADS1219DutyCycle duty(adc, plan);
+    uint8_t best, rate;
+    uint16_t n;
+
+    // the noise figures of gain 4, and the plan runs at gain 4, auto-ranged entries included
+    TEST_ASSERT_EQUAL(ADS1219_OK, plan.setGain(1, ADS1219_GAIN_AUTO));
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.setNoise(1.f, ADS1219_GAIN_FOUR));
+    TEST_ASSERT_TRUE(duty.bestRate(1.f, ADS1219_GAIN_FOUR, &best, &n));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.getDataRate(&rate));
+    TEST_ASSERT_EQUAL(best, rate);
+    for ( uint8_t i = 0; i < 4; i++ ) {
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, plan.entry(i).gain);
+        TEST_ASSERT_EQUAL(n, plan.entry(i).samples);
+    }
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.begin(1000000UL));
+    TEST_ASSERT_TRUE(duty.run(results));
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.lastError());
+    TEST_ASSERT_TRUE(ADS1219Device.config() & ~ADS1219_CONFIG_MASK_GAIN);
+    for ( uint8_t i = 0; i < 4; i++ ) {
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, plan.gain(i));
+        TEST_ASSERT_INT_WITHIN(8, 4 * 409600 * ( i + 1 ), results[i]);
+    }
+
+    // only gain 1 or 4
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_GAIN, duty.setNoise(1.f, ADS1219_GAIN_AUTO));
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_GAIN, plan.setGain(4, ADS1219_GAIN_ONE));
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_GAIN, plan.setGain(0, 3));
+}
+
+void test_native_duty_busy(void)
+{
+    ADS1219DutyCycle duty(adc, plan);
+    ADS1219DutyStats st;
+    ADS1219Sample sample;
+
+    // a conversion of the application holds the driver when the first burst is due
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.begin(1000000UL));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.beginConversion(ADS1219_MUX_SINGLE_0));
+    TEST_ASSERT_FALSE(duty.run(results));
+    TEST_ASSERT_EQUAL(ADS1219_BUSY, duty.lastError());
+    TEST_ASSERT_FALSE(ADS1219Device.poweredDown());
+    duty.stats(&st);
+    TEST_ASSERT_EQUAL(0, st.bursts);
+    TEST_ASSERT_EQUAL(0, st.samples);
+
+    // its result is still there, then the burst runs
+    while ( ! adc.poll(&sample) ) delay(1);
+    TEST_ASSERT_EQUAL(ADS1219_OK, sample.err_code);
+    TEST_ASSERT_INT_WITHIN(2, 409600, sample.value);
+    TEST_ASSERT_TRUE(duty.run(results));
+    TEST_ASSERT_EQUAL(ADS1219_OK, duty.lastError());
+    TEST_ASSERT_TRUE(ADS1219Device.poweredDown());
+    duty.stats(&st);
+    TEST_ASSERT_EQUAL(1, st.bursts);
+    TEST_ASSERT_EQUAL(4, st.samples);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_duty_best_rate);
+    RUN_TEST(test_native_duty_bursts);
+    RUN_TEST(test_native_duty_gain);
+    RUN_TEST(test_native_duty_busy);
+
+    UNITY_END();
+}
+
+void loop(){}
@@ -0,0 +1,291 @@
+#include "unity.h"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Filter.h"
+#include "ADS1219Emulator.h"
+
+// Streaming filters against floating point references, on the driver's output and a host benchmark
+
+#define TEST_FILTER_NUM 4096
+
+#define TEST_DRDY_PIN 5
+
+ADS1219Emulator emu_drdy(Wire, 0x41, TEST_DRDY_PIN);
+
+ADS1219 adc;
+ADS1219 adc_drdy(0x41, TEST_DRDY_PIN);
+
+int32_t counts[TEST_FILTER_NUM];
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    emu_drdy.powerCycle();
+    adc.begin();
+    adc.reset();
+    adc_drdy.begin();
+    adc_drdy.reset();
+
+    // noisy full scale sine, including both ends of the 24 bit range
+    uint32_t rng = 12345;
+    for ( int32_t i = 0; i < TEST_FILTER_NUM; i++ ) {
+        rng = rng * 1103515245UL + 12345UL;
+        double v = 8388000. * sin( i * 0.01 ) + static_cast<int32_t>( ( rng >> 16 ) & 0x3FF ) - 512;
+        counts[i] = v > 8388607. ? 8388607 : v < -8388608. ? -8388608 : static_cast<int32_t>( v );
+    }
+    counts[100] = 8388607;
+    counts[101] = -8388608;
+}
+
+void tearDown(void)
+{
+}
+
+
+static int32_t round_half_up( double v )
+{
+    return static_cast<int32_t>( floor( v + 0.5 ) );
+}
+
+void test_native_moving_average(void)
+{
+    ADS1219MovingAverage<16> ma;
+    int32_t out;
+
+    // the window starts filled with the first sample
+    TEST_ASSERT_TRUE(ma.filter(1000, &out));
+    TEST_ASSERT_EQUAL_INT32(1000, out);
+
+    ma.reset();
+    for ( int32_t i = 0; i < TEST_FILTER_NUM; i++ ) {
+        TEST_ASSERT_TRUE(ma.filter(counts[i], &out));
+
+        double sum = 0.;
+        for ( int32_t k = i - 15; k <= i; k++ ) sum += counts[k < 0 ? 0 : k];
+        TEST_ASSERT_EQUAL_INT32(round_half_up( sum / 16. ), out);
+    }
+    TEST_ASSERT_EQUAL_INT32(out, ma.last());
+}
+
+void test_native_iir(void)
+{
+    ADS1219IIR<4> iir;
+    int32_t out = 0;
+
+    // a constant comes out exactly, a step settles to it
+    for ( int i = 0; i < 10; i++ ) iir.filter(-77777, &out);
+    TEST_ASSERT_EQUAL_INT32(-77777, out);
+    for ( int i = 0; i < 400; i++ ) iir.filter(5000000, &out);
+    TEST_ASSERT_EQUAL_INT32(5000000, out);
+
+    // follows the floating point filter within a count, also at full scale
+    double y = counts[0];
+    iir.reset();
+    for ( int32_t i = 0; i < TEST_FILTER_NUM; i++ ) {
+        y += ( counts[i] - y ) / 16.;
+        TEST_ASSERT_TRUE(iir.filter(counts[i], &out));
+        TEST_ASSERT_INT_WITHIN(1, round_half_up( y ), out);
+    }
+}
+
+void test_native_cic(void)
+{
+    ADS1219CIC<1, 8> cic1;
+    ADS1219CIC<2, 8> cic2;
+    int32_t out, n1 = 0, n2 = 0;
+
+    for ( int32_t i = 0; i < TEST_FILTER_NUM; i++ )
+    {
+        // order 1 is the average of each block of 8
+        if ( cic1.filter(counts[i], &out) ) {
+            TEST_ASSERT_EQUAL(7, i % 8);
+            double sum = 0.;
+            for ( int32_t k = i - 7; k <= i; k++ ) sum += counts[k];
+            TEST_ASSERT_EQUAL_INT32(round_half_up( sum / 8. ), out);
+            n1++;
+        }
+
+        // order 2 is a triangle over 15 samples, the first output is held back
+        if ( cic2.filter(counts[i], &out) ) {
+            TEST_ASSERT_GREATER_OR_EQUAL(15, i);
+            double sum = 0.;
+            for ( int32_t k = 0; k < 15; k++ ) sum += ( k < 8 ? k + 1 : 15 - k ) * static_cast<double>( counts[i - k] );
+            TEST_ASSERT_EQUAL_INT32(round_half_up( sum / 64. ), out);
+            n2++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL(TEST_FILTER_NUM / 8, n1);
+    TEST_ASSERT_EQUAL(TEST_FILTER_NUM / 8 - 1, n2);
+
+    // the registers wrap around, the output doesn't
+    ADS1219CIC<4, 4> cic4;
+    for ( int i = 0; i < 1000; i++ )
+        if ( cic4.filter(-8388608, &out) ) TEST_ASSERT_EQUAL_INT32(-8388608, out);
+}
+
+void test_native_filter_chain(void)
+{
+    ADS1219IIR<2> iir;
+    ADS1219CIC<1, 4> cic;
+    ADS1219MovingAverage<2> ma;
+    ADS1219IIR<2> iir_ref;
+    ADS1219CIC<1, 4> cic_ref;
+    ADS1219MovingAverage<2> ma_ref;
+    int32_t out, a, b, c;
+    int n = 0;
+
+    iir.then(cic).then(ma);
+
+    for ( int32_t i = 0; i < TEST_FILTER_NUM; i++ )
+    {
+        bool ready = iir.filter(counts[i], &out);
+
+        // same as running the stages one after the other
+        iir_ref.filter(counts[i], &a);
+        bool ref_ready = cic_ref.filter(a, &b) && ma_ref.filter(b, &c);
+        TEST_ASSERT_EQUAL(ref_ready, ready);
+        if ( ready ) {
+            TEST_ASSERT_EQUAL_INT32(c, out);
+            TEST_ASSERT_EQUAL_INT32(c, iir.last());
+            n++;
+        }
+    }
+    TEST_ASSERT_EQUAL(TEST_FILTER_NUM / 4, n);
+
+    // reset clears the whole chain
+    iir.reset();
+    TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(0x80000000), iir.last());
+    for ( int i = 0; i < 3; i++ ) TEST_ASSERT_FALSE(iir.filter(100, &out));
+    TEST_ASSERT_TRUE(iir.filter(100, &out));
+    TEST_ASSERT_EQUAL_INT32(100, out);
+}
+
+void test_native_filter_scan(void)
+{
+    ADS1219ScanPlan plan;
+    ADS1219MovingAverage<4> ma;
+    ADS1219CIC<1, 2> cic;
+    int32_t results[2];
+    uint8_t err_codes[2];
+
+    ADS1219Device.setInput(0, 1000.f);
+    ADS1219Device.setInput(1, 500.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, plan.addSingleEnded(0, ADS1219_GAIN_KEEP, 1, &ma));
+    TEST_ASSERT_EQUAL(ADS1219_OK, plan.addSingleEnded(1, ADS1219_GAIN_KEEP, 1, &cic));
+
+    // the decimating entry has no result on the first scan, which isn't an error for the scan
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, results, err_codes));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err_codes[0]);
+    TEST_ASSERT_EQUAL_INT32(4096000, results[0]);
+    TEST_ASSERT_EQUAL(ADS1219_FILTER_PENDING, err_codes[1]);
+    TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(0x80000000), results[1]);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, results, err_codes));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err_codes[1]);
+    TEST_ASSERT_EQUAL_INT32(2048000, results[1]);
+
+    // the moving average follows a step on its own channel only
+    ADS1219Device.setInput(0, 1512.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, results, err_codes));
+    TEST_ASSERT_EQUAL_INT32(( 3 * 4096000 + 6193152 ) / 4, results[0]);
+    TEST_ASSERT_EQUAL(ADS1219_FILTER_PENDING, err_codes[1]);
+    TEST_ASSERT_EQUAL_INT32(2048000, results[1]);
+}
+
+void test_native_filter_stream(void)
+{
+    ADS1219CIC<2, 4> cic;
+    int32_t buf[ADS1219_STREAM_BUFFER_SIZE];
+    size_t  total = 0;
+
+    emu_drdy.setInput(0, 1000.f);
+    emu_drdy.setNoise(8.f, 7);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.startStream(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS, &cic));
+
+    // a quarter of the conversions end up in the buffer
+    unsigned long t0 = micros();
+    while ( micros() - t0 < 100000UL ) {
+        delayMicroseconds(250);
+        TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.serviceStream());
+        size_t n = adc_drdy.readBuffered(buf, ADS1219_STREAM_BUFFER_SIZE);
+        for ( size_t j = 0; j < n; j++ ) TEST_ASSERT_INT_WITHIN(40, 4096000, buf[j]);
+        total += n;
+    }
+
+    TEST_ASSERT_INT_WITHIN(2, 24, total);
+    TEST_ASSERT_EQUAL(0, adc_drdy.overruns());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.stopStream());
+}
+
+
+template <typename F>
+static void benchmark( const char* name, F& f, int rounds )
+{
+    using clock = std::chrono::steady_clock;
+    volatile int32_t sink = 0;
+    int32_t out = 0;
+
+    clock::time_point t0 = clock::now();
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t c0 = __rdtsc();
+#endif
+    for ( int r = 0; r < rounds; r++ )
+        for ( int32_t i = 0; i < TEST_FILTER_NUM; i++ )
+            if ( f.filter(counts[i], &out) ) sink = out;
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t c1 = __rdtsc();
+#endif
+    clock::time_point t1 = clock::now();
+    (void) sink;
+
+    double n = static_cast<double>(rounds) * TEST_FILTER_NUM;
+    printf("%-24s : %6.2f ns/sample", name, std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+#if defined(__x86_64__) || defined(__i386__)
+    printf(", %6.2f cycles/sample", ( c1 - c0 ) / n);
+#endif
+    printf("\n");
+}
+
+void test_native_filter_benchmark(void)
+{
+    ADS1219MovingAverage<64> ma;
+    ADS1219IIR<4> iir;
+    ADS1219CIC<3, 4> cic;
+    ADS1219IIR<2> chain;
+    ADS1219CIC<2, 8> chain_cic;
+    ADS1219MovingAverage<4> chain_ma;
+    chain.then(chain_cic).then(chain_ma);
+
+    benchmark("MovingAverage<64>", ma, 200);
+    benchmark("IIR<4>", iir, 200);
+    benchmark("CIC<3, 4>", cic, 200);
+    benchmark("IIR<2> > CIC<2, 8> > MA<4>", chain, 200);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_moving_average);
+    RUN_TEST(test_native_iir);
+    RUN_TEST(test_native_cic);
+    RUN_TEST(test_native_filter_chain);
+    RUN_TEST(test_native_filter_scan);
+    RUN_TEST(test_native_filter_stream);
+    RUN_TEST(test_native_filter_benchmark);
+
+    UNITY_END();
+}
+
+void loop(){}
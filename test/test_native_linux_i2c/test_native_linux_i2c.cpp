@@ -0,0 +1,256 @@
+#include "unity.h"
+
+#if defined(__linux__)
+
+#include <chrono>
+#include <errno.h>
+#include <stdio.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "ADS1219.h"
+#include "ADS1219LinuxI2C.h"
+#include "ADS1219Emulator.h"
+
+// The Linux i2c-dev backend against a fake adapter : the ioctl is replaced by one that hands the messages
+// to the emulated devices, with the same bus timing as the TwoWire stand-in (100 kHz)
+
+#define TEST_DRDY_PIN 5
+#define TEST_BENCH_NUM 2000
+
+ADS1219Emulator emu_drdy(Wire, 0x41, TEST_DRDY_PIN);
+
+uint64_t fake_bus_time_us;
+
+
+static int fake_ioctl( int fd, unsigned long request, void* arg )
+{
+    if ( fd < 0 || request != I2C_RDWR ) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct i2c_rdwr_ioctl_data* data = static_cast<struct i2c_rdwr_ioctl_data*>( arg );
+
+    for ( uint32_t i = 0; i < data->nmsgs; i++ )
+    {
+        struct i2c_msg& msg = data->msgs[i];
+        ADS1219Emulator* dev = msg.addr == 0x40 ? &ADS1219Device : msg.addr == 0x41 ? &emu_drdy : nullptr;
+        bool last = i + 1 == data->nmsgs;
+        bool ack = dev != nullptr && dev->i2cAck();
+
+        // (repeated) START + address + data, 9 clocks each, STOP and bus free time after the last message
+        uint32_t clocks = 1 + 9 * ( 1 + ( ack ? msg.len : 0 ) ) + ( last || ! ack ? 2 : 0 );
+        fake_bus_time_us += clocks * 10;
+        ArduinoNative::advance( clocks * 10 );
+
+        if ( ! ack ) {
+            errno = EREMOTEIO;
+            return -1;
+        }
+
+        if ( msg.flags & I2C_M_RD ) {
+            if ( dev->i2cRead( msg.buf, msg.len ) != msg.len ) {
+                errno = EREMOTEIO;
+                return -1;
+            }
+        }
+        else if ( ! dev->i2cWrite( msg.buf, msg.len ) ) {
+            errno = EREMOTEIO;
+            return -1;
+        }
+    }
+
+    return static_cast<int>( data->nmsgs );
+}
+
+
+// DRDY of the device at 0x41 provided by the backend, as a GPIO line next to the adapter would be
+class DrdyLinuxI2C : public ADS1219LinuxI2C {
+public:
+    DrdyLinuxI2C() : ADS1219LinuxI2C("/dev/null", fake_ioctl) {}
+    bool hasDrdy( void ) const override { return true; }
+    bool drdyReady( void ) override { return digitalRead(TEST_DRDY_PIN) == LOW; }
+};
+
+ADS1219LinuxI2C bus("/dev/null", fake_ioctl);
+DrdyLinuxI2C bus_drdy;
+
+ADS1219 adc(bus);
+ADS1219 adc_drdy(bus_drdy, 0x41);
+ADS1219 adc_wire;
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    emu_drdy.powerCycle();
+
+    adc.begin();
+    adc.reset();
+    adc_drdy.begin();
+    adc_drdy.reset();
+    adc_wire.begin();
+    adc_wire.reset();
+
+    ADS1219Device.setInput(0, 1000.f);
+    emu_drdy.setInput(0, 1000.f);
+}
+
+void tearDown(void)
+{
+}
+
+
+void test_native_linux_i2c_readout(void)
+{
+    uint8_t err;
+
+    // nothing goes over Wire
+    Wire.resetCounters();
+    TEST_ASSERT_EQUAL(ADS1219_OK, bus.begin());
+    TEST_ASSERT_TRUE(adc.detect());
+    TEST_ASSERT_EQUAL(8192, adc.maxBufferSize());
+
+    TEST_ASSERT_EQUAL_INT32(4096000, adc.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(0, Wire.transactions());
+
+    // backends can be owned through the base class
+    ADS1219Bus* owned = new ADS1219LinuxI2C("/dev/null", fake_ioctl);
+    delete owned;
+
+    ADS1219Config config;
+    config.mux  = ADS1219_MUX_SINGLE_1;
+    config.gain = ADS1219_GAIN_FOUR;
+    config.rate = ADS1219_DATARATE_1000SPS;
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.applyConfig(config));
+    TEST_ASSERT_EQUAL_HEX8(config.reg(), ADS1219Device.config());
+
+    ADS1219Config readback;
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.readConfig(&readback));
+    TEST_ASSERT_EQUAL_HEX8(config.reg(), readback.reg());
+}
+
+void test_native_linux_i2c_combined(void)
+{
+    uint8_t err;
+
+    // every command with its response is a single ioctl : one per START, register read and RDATA
+    adc.readSingleEnded(0, &err);
+    ADS1219Device.resetCounters();
+    uint32_t n0 = bus.transfers();
+    for ( int i = 0; i < 10; i++ ) {
+        TEST_ASSERT_EQUAL_INT32(4096000, adc.readSingleEnded(0, &err));
+        TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    }
+    uint32_t n = bus.transfers() - n0;
+    TEST_ASSERT_EQUAL_UINT32(ADS1219Device.starts() + ADS1219Device.registerReads() + ADS1219Device.dataReads(), n);
+    TEST_ASSERT_EQUAL_UINT32(10, ADS1219Device.dataReads());
+
+    // without the repeated START the command and the response are two ioctls
+    adc.setRepeatedStart(false);
+    ADS1219Device.resetCounters();
+    n0 = bus.transfers();
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    n = bus.transfers() - n0;
+    TEST_ASSERT_EQUAL_UINT32(ADS1219Device.starts() + 2 * ( ADS1219Device.registerReads() + ADS1219Device.dataReads() ), n);
+    adc.setRepeatedStart(true);
+}
+
+void test_native_linux_i2c_errors(void)
+{
+    uint8_t err;
+
+    // a NACK fails the ioctl, the errno is kept
+    ADS1219Device.failNext(1);
+    TEST_ASSERT_FALSE(adc.detect());
+    TEST_ASSERT_EQUAL(EREMOTEIO, bus.lastError());
+
+    ADS1219Device.failNext(100);
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_NOT_EQUAL(ADS1219_OK, err);
+    ADS1219Device.failNext(0);
+    TEST_ASSERT_EQUAL_INT32(4096000, adc.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+
+    // a device node which doesn't exist
+    ADS1219LinuxI2C missing("/dev/i2c-does-not-exist", fake_ioctl);
+    TEST_ASSERT_EQUAL(ADS1219_FAILED_TO_END, missing.begin());
+    TEST_ASSERT_EQUAL(ENOENT, missing.lastError());
+}
+
+void test_native_linux_i2c_drdy(void)
+{
+    uint8_t err;
+
+    // DRDY from the backend, no register reads while waiting
+    TEST_ASSERT_EQUAL(ADS1219_READY_BUS, adc_drdy.readyMode());
+    adc_drdy.readSingleEnded(0, &err);
+    emu_drdy.resetCounters();
+
+    TEST_ASSERT_EQUAL_INT32(4096000, adc_drdy.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_UINT32(0, emu_drdy.registerReads());
+    TEST_ASSERT_EQUAL_UINT32(1, emu_drdy.dataReads());
+}
+
+
+// host time and bus time per sample in µs
+static void benchmark( const char* name, ADS1219& dev, double* host_us, double* bus_us )
+{
+    using clock = std::chrono::steady_clock;
+    uint8_t err;
+
+    dev.readSingleEnded(0, &err);
+    fake_bus_time_us = 0;
+    Wire.resetCounters();
+
+    clock::time_point t0 = clock::now();
+    for ( int i = 0; i < TEST_BENCH_NUM; i++ ) dev.readSingleEnded(0, &err);
+    clock::time_point t1 = clock::now();
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+
+    *host_us = std::chrono::duration<double, std::micro>(t1 - t0).count() / TEST_BENCH_NUM;
+    *bus_us  = static_cast<double>( fake_bus_time_us + Wire.busTime() ) / TEST_BENCH_NUM;
+    printf("%-22s : %6.3f us/sample host, %7.1f us/sample bus, %8.0f samples/s host\n", name, *host_us, *bus_us, 1e6 / *host_us);
+}
+
+void test_native_linux_i2c_benchmark(void)
+{
+    double linux_host, linux_bus, wire_host, wire_bus;
+
+    adc.setDataRate(ADS1219_DATARATE_1000SPS);
+    adc_wire.setDataRate(ADS1219_DATARATE_1000SPS);
+    benchmark("Linux i2c-dev (fake)", adc, &linux_host, &linux_bus);
+    benchmark("TwoWire", adc_wire, &wire_host, &wire_bus);
+
+    // same bus traffic either way
+    TEST_ASSERT_FLOAT_WITHIN(1., wire_bus, linux_bus);
+}
+
+#else
+
+void setUp(void) {}
+void tearDown(void) {}
+
+#endif
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+#if defined(__linux__)
+    RUN_TEST(test_native_linux_i2c_readout);
+    RUN_TEST(test_native_linux_i2c_combined);
+    RUN_TEST(test_native_linux_i2c_errors);
+    RUN_TEST(test_native_linux_i2c_drdy);
+    RUN_TEST(test_native_linux_i2c_benchmark);
+#endif
+
+    UNITY_END();
+}
+
+void loop(){}
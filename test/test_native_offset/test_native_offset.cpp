@@ -0,0 +1,151 @@
+#include "unity.h"
+
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Emulator.h"
+
+// The offset cache : calibration, correction at no extra conversion, background refresh in the scans by 
+// scan count, timer and request, and the exponential average following a drifting offset
+
+ADS1219 adc;
+ADS1219ScanPlan plan;
+int32_t results[4];
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    adc.begin();
+    adc.reset();
+    adc.clearOffsets();
+    adc.setOffsetCorrection(false);
+    adc.setOffsetRefresh(0);
+
+    plan.clear();
+    for ( uint8_t i = 0; i < 4; i++ ) {
+        plan.addSingleEnded(i);
+        ADS1219Device.setInput(i, 100.f * ( i + 1 ));
+    }
+    ADS1219Device.setOffset(120);
+}
+
+void tearDown(void)
+{
+}
+
+
+void test_native_offset_cached(void)
+{
+    int32_t offset;
+    uint8_t err;
+
+    TEST_ASSERT_FALSE(adc.cachedOffset(ADS1219_DATARATE_20SPS, ADS1219_GAIN_ONE, &offset));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.calibrateOffset(4));
+    TEST_ASSERT_TRUE(adc.cachedOffset(ADS1219_DATARATE_20SPS, ADS1219_GAIN_ONE, &offset));
+    TEST_ASSERT_EQUAL_INT32(120, offset);
+    TEST_ASSERT_FALSE(adc.cachedOffset(ADS1219_DATARATE_20SPS, ADS1219_GAIN_FOUR, &offset));
+    TEST_ASSERT_FALSE(adc.cachedOffset(ADS1219_DATARATE_90SPS, ADS1219_GAIN_ONE, &offset));
+
+    // the cached offset costs no conversion, against 10 extra with offset samples
+    adc.setOffsetCorrection(true);
+    ADS1219Device.resetCounters();
+    unsigned long t0 = micros();
+    TEST_ASSERT_EQUAL_INT32(409600, adc.readSingleEnded(0, &err));
+    unsigned long cached_us = micros() - t0;
+    TEST_ASSERT_EQUAL(1, ADS1219Device.conversions());
+
+    t0 = micros();
+    TEST_ASSERT_EQUAL_INT32(409600, adc.readSingleEnded(0, &err, 10));
+    unsigned long measured_us = micros() - t0;
+    TEST_ASSERT_EQUAL(1 + 11, ADS1219Device.conversions());
+    printf("cached offset %lu us, 10 offset samples %lu us\n", cached_us, measured_us);
+
+    // another gain has its own slot, not calibrated yet
+    adc.setGain(ADS1219_GAIN_FOUR);
+    TEST_ASSERT_EQUAL_INT32(1638400 + 120, adc.readSingleEnded(0, &err));
+}
+
+void test_native_offset_refresh(void)
+{
+    int32_t offset;
+
+    adc.setOffsetCorrection(true);
+    adc.setOffsetRefresh(10);
+
+    // nothing cached : the first scan adds a shorted conversion
+    ADS1219Device.resetCounters();
+    adc.scan(plan, results);
+    TEST_ASSERT_EQUAL(5, ADS1219Device.conversions());
+    TEST_ASSERT_EQUAL(1, adc.offsetRefreshes());
+    TEST_ASSERT_TRUE(adc.cachedOffset(ADS1219_DATARATE_20SPS, ADS1219_GAIN_ONE, &offset));
+
+    // then one every 10 scans, and the results are corrected from the second scan on
+    for ( int s = 1; s <= 30; s++ ) {
+        adc.scan(plan, results);
+        for ( uint8_t i = 0; i < 4; i++ ) TEST_ASSERT_EQUAL_INT32(409600 * ( i + 1 ), results[i]);
+    }
+    TEST_ASSERT_EQUAL(4, adc.offsetRefreshes());
+    TEST_ASSERT_EQUAL(31 * 4 + 4, ADS1219Device.conversions());
+
+    // on request, e.g. after a temperature change
+    adc.requestOffsetRefresh();
+    adc.scan(plan, results);
+    TEST_ASSERT_EQUAL(5, adc.offsetRefreshes());
+
+    // on a timer
+    adc.setOffsetRefresh(0, 1000000UL);
+    for ( int s = 0; s < 20; s++ ) adc.scan(plan, results);  // ~4 s
+    TEST_ASSERT_INT_WITHIN(1, 5 + 4, adc.offsetRefreshes());
+}
+
+void test_native_offset_tracking(void)
+{
+    int32_t offset;
+
+    adc.setOffsetCorrection(true);
+    adc.setDataRate(ADS1219_DATARATE_1000SPS);
+
+    // with a noisy offset the average smooths, then follows a drift
+    ADS1219Device.setNoise(16.f, 5);
+    adc.setOffsetRefresh(1, 0, 4);
+    for ( int s = 0; s < 100; s++ ) adc.scan(plan, results);
+    TEST_ASSERT_TRUE(adc.cachedOffset(ADS1219_DATARATE_1000SPS, ADS1219_GAIN_ONE, &offset));
+    TEST_ASSERT_INT_WITHIN(12, 120, offset);
+
+    ADS1219Device.setOffset(-300);
+    for ( int s = 0; s < 100; s++ ) adc.scan(plan, results);
+    TEST_ASSERT_TRUE(adc.cachedOffset(ADS1219_DATARATE_1000SPS, ADS1219_GAIN_ONE, &offset));
+    printf("offset after the drift to -300 : %ld\n", static_cast<long>(offset));
+    TEST_ASSERT_INT_WITHIN(12, -300, offset);
+
+    // entries at both gains : the refreshes take them in turns, and leave the gain as the scan did (that of
+    // the last entry)
+    plan.clear();
+    plan.addSingleEnded(0, ADS1219_GAIN_FOUR);
+    plan.addSingleEnded(3, ADS1219_GAIN_ONE);
+    for ( int s = 0; s < 10; s++ ) {
+        uint8_t gain;
+        adc.scan(plan, results);
+        TEST_ASSERT_EQUAL(ADS1219_OK, adc.getGain(&gain));
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, gain);
+        TEST_ASSERT_FALSE(ADS1219Device.config() & ~ADS1219_CONFIG_MASK_GAIN);
+    }
+    TEST_ASSERT_TRUE(adc.cachedOffset(ADS1219_DATARATE_1000SPS, ADS1219_GAIN_FOUR, &offset));
+    TEST_ASSERT_INT_WITHIN(40, -300, offset);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_offset_cached);
+    RUN_TEST(test_native_offset_refresh);
+    RUN_TEST(test_native_offset_tracking);
+
+    UNITY_END();
+}
+
+void loop(){}
@@ -0,0 +1,365 @@
+#include "unity.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <pty.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+#include "ADS1219.h"
+#include "ADS1219Packet.h"
+#include "ADS1219Filter.h"
+#include "ADS1219Window.h"
+#include "ADS1219Emulator.h"
+
+// COBS framed packets : framing, CRC and sequence checks, 1000 SPS streaming from the emulated device, the
+// same through a pseudo terminal, and a decoder benchmark on a few million samples
+
+#define TEST_DRDY_PIN 5
+#define TEST_BENCH_SAMPLES 3000000UL
+
+ADS1219Emulator emu_drdy(Wire, 0x41, TEST_DRDY_PIN);
+ADS1219 adc_drdy(0x41, TEST_DRDY_PIN);
+
+
+// Print into memory
+class BufferPrint : public Print {
+public:
+    size_t write( uint8_t c ) override { data.push_back(c); return 1; }
+    size_t write( const uint8_t* buffer, size_t size ) override { data.insert(data.end(), buffer, buffer + size); return size; }
+    std::vector<uint8_t> data;
+};
+
+// samples collected by ADS1219PacketDecoder
+static void collect( const ADS1219PacketSample& s, void* context )
+{
+    static_cast<std::vector<ADS1219PacketSample>*>( context )->push_back( s );
+}
+
+
+void setUp(void)
+{
+    emu_drdy.powerCycle();
+    adc_drdy.begin();
+    adc_drdy.reset();
+}
+
+void tearDown(void)
+{
+}
+
+
+void test_native_packet_crc_cobs(void)
+{
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, ads1219_crc16(reinterpret_cast<const uint8_t*>("123456789"), 9));
+
+    uint8_t out[700], back[700];
+    const uint8_t a[] = { 0x11, 0x22, 0x00, 0x33 };
+    const uint8_t a_enc[] = { 0x03, 0x11, 0x22, 0x02, 0x33 };
+    TEST_ASSERT_EQUAL(5, ads1219_cobs_encode(a, 4, out));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(a_enc, out, 5);
+    const uint8_t z[] = { 0x00 };
+    TEST_ASSERT_EQUAL(2, ads1219_cobs_encode(z, 1, out));
+    TEST_ASSERT_EQUAL_HEX8(0x01, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, out[1]);
+
+    // random data with more or fewer zeros, up to a few blocks of 254
+    uint32_t rng = 99;
+    for ( size_t len = 1; len < 600; len += 7 ) {
+        uint8_t in[600];
+        for ( size_t i = 0; i < len; i++ ) {
+            rng = rng * 1103515245UL + 12345UL;
+            in[i] = ( len % 3 == 0 ) ? static_cast<uint8_t>( ( rng >> 16 ) | 1 ) : static_cast<uint8_t>( rng >> 24 );
+        }
+        size_t n = ads1219_cobs_encode(in, len, out);
+        TEST_ASSERT_LESS_OR_EQUAL(len + len / 254 + 1, n);
+        for ( size_t i = 0; i < n; i++ ) TEST_ASSERT_NOT_EQUAL(0, out[i]);
+        TEST_ASSERT_EQUAL(len, ads1219_cobs_decode(out, n, back));
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(in, back, len);
+    }
+
+    // a code running past the end, an embedded zero
+    const uint8_t bad1[] = { 0x05, 0x11 };
+    TEST_ASSERT_EQUAL(0, ads1219_cobs_decode(bad1, 2, back));
+    const uint8_t bad2[] = { 0x03, 0x11, 0x00 };
+    TEST_ASSERT_EQUAL(0, ads1219_cobs_decode(bad2, 3, back));
+}
+
+void test_native_packet_reader(void)
+{
+    BufferPrint out;
+    ADS1219PacketWriter writer(out);
+    ADS1219PacketReader reader;
+    std::vector<size_t> ends;
+
+    uint8_t payload[ADS1219_RECORD_MAX_FRAME];
+    for ( int p = 0; p < 5; p++ ) {
+        for ( size_t i = 0; i < sizeof(payload); i++ ) payload[i] = static_cast<uint8_t>( p * 37 + i * ( i & 1 ) );
+        TEST_ASSERT_GREATER_THAN(0, writer.send(ADS1219_PACKET_RECORD, payload, 10 + p));
+        ends.push_back(out.data.size());
+    }
+    TEST_ASSERT_EQUAL(0, writer.send(ADS1219_PACKET_RECORD, payload, ADS1219_RECORD_MAX_FRAME + 1));
+    TEST_ASSERT_EQUAL(5, writer.sequence());
+
+    // packet 1 corrupted, packet 3 lost, garbage without a delimiter in front of packet 4
+    std::vector<uint8_t> rx(out.data.begin(), out.data.begin() + ends[2]);
+    rx[ends[0] + 4] ^= 0x10;
+    for ( int i = 0; i < 300; i++ ) rx.push_back(0x55);
+    rx.insert(rx.end(), out.data.begin() + ends[3], out.data.end());
+
+    std::vector<uint16_t> seqs;
+    for ( size_t i = 0; i < rx.size(); i++ ) {
+        if ( reader.push(rx[i]) ) {
+            seqs.push_back(reader.sequence());
+            TEST_ASSERT_EQUAL(ADS1219_PACKET_RECORD, reader.type());
+            TEST_ASSERT_EQUAL(10 + reader.sequence(), reader.length());
+            TEST_ASSERT_EQUAL_HEX8(reader.sequence() * 37, reader.payload()[0]);
+        }
+    }
+
+    // packet 1 fails its check, packet 4 went with the garbage into an overlong packet
+    TEST_ASSERT_EQUAL(2, seqs.size());
+    TEST_ASSERT_EQUAL(0, seqs[0]);
+    TEST_ASSERT_EQUAL(2, seqs[1]);
+    TEST_ASSERT_EQUAL(2, reader.crcErrors() + reader.framingErrors());
+    TEST_ASSERT_GREATER_OR_EQUAL(1, reader.framingErrors());
+    TEST_ASSERT_EQUAL(1, reader.dropped());
+
+    // the next good packet gets through, with the gap counted
+    ADS1219PacketReader r2;
+    for ( size_t i = 0; i < ends[0]; i++ ) r2.push(out.data[i]);
+    bool got = false;
+    for ( size_t i = ends[3]; i < out.data.size(); i++ ) got = r2.push(out.data[i]) || got;
+    TEST_ASSERT_TRUE(got);
+    TEST_ASSERT_TRUE(r2.gap());
+    TEST_ASSERT_EQUAL(3, r2.dropped());
+}
+
+// stream for duration_us, servicing every 250 µs, optionally feeding a pseudo terminal at the same time
+static void run_stream( ADS1219PacketStream& stream, unsigned long duration_us, void (*drain)(void) = nullptr )
+{
+    unsigned long t0 = micros();
+    while ( micros() - t0 < duration_us ) {
+        delayMicroseconds(250);
+        TEST_ASSERT_EQUAL(ADS1219_OK, stream.service());
+        if ( drain != nullptr ) drain();
+    }
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.end());
+    if ( drain != nullptr ) drain();
+}
+
+static void check_stream( const std::vector<ADS1219PacketSample>& samples, size_t expected )
+{
+    TEST_ASSERT_INT_WITHIN(2, expected, samples.size());
+    for ( size_t i = 0; i < samples.size(); i++ ) {
+        TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_0, samples[i].mux);
+        TEST_ASSERT_EQUAL(ADS1219_DATARATE_1000SPS, samples[i].rate);
+        TEST_ASSERT_INT_WITHIN(60, 4096000, samples[i].value);
+        if ( i > 0 ) {
+            // one conversion period apart, within the packing estimate
+            long dt = static_cast<long>( samples[i].time_us - samples[i - 1].time_us );
+            TEST_ASSERT_INT_WITHIN(300, ads1219_conversion_us(ADS1219_DATARATE_1000SPS, ADS1219_CM_CONTINUOUS), dt);
+        }
+    }
+}
+
+void test_native_packet_stream(void)
+{
+    BufferPrint out;
+    ADS1219PacketStream stream(adc_drdy, out);
+    std::vector<ADS1219PacketSample> samples;
+    ADS1219PacketDecoder decoder(collect, &samples);
+
+    emu_drdy.setInput(0, 1000.f);
+    emu_drdy.setNoise(8.f, 5);
+
+    // one second at 1000 SPS
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+    run_stream(stream, 1000000UL);
+    TEST_ASSERT_EQUAL(0, adc_drdy.overruns());
+
+    decoder.push(out.data.data(), out.data.size());
+    check_stream(samples, 988);
+    TEST_ASSERT_EQUAL(stream.packets(), decoder.reader().packets());
+    TEST_ASSERT_EQUAL(0, decoder.reader().dropped());
+    TEST_ASSERT_EQUAL(0, decoder.skippedFrames());
+
+    // fits in a 115200 baud link (11520 bytes/s) with room to spare
+    Serial.print("1000 SPS stream : "); Serial.print(static_cast<unsigned long>(stream.bytes())); Serial.print(" bytes/s in ");
+    Serial.print(static_cast<unsigned long>(stream.packets())); Serial.println(" packets");
+    TEST_ASSERT_LESS_THAN(11520 / 2, stream.bytes());
+    TEST_ASSERT_EQUAL(out.data.size(), stream.bytes());
+}
+
+void test_native_packet_stream_irregular(void)
+{
+    BufferPrint out;
+    ADS1219PacketStream stream(adc_drdy, out);
+    ADS1219MovingAverage<4> average;
+    ADS1219IIR<2> iir;
+    ADS1219CIC<2, 4> cic;
+    ADS1219Window window;
+
+    // a decimator anywhere in the chain, the stream isn't started
+    TEST_ASSERT_FALSE(average.then(iir).decimating());
+    TEST_ASSERT_FALSE(average.decimating());
+    iir.then(cic);
+    TEST_ASSERT_TRUE(average.decimating());
+    TEST_ASSERT_EQUAL(ADS1219_STREAM_IRREGULAR, stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS, &average));
+    TEST_ASSERT_EQUAL(0, emu_drdy.starts());
+
+    // a window which suppresses samples on the streamed input
+    TEST_ASSERT_TRUE(window.setThresholds(100.f, 200.f));
+    window.setSuppress(true);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.setWindow(ADS1219_MUX_SINGLE_0, &window));
+    TEST_ASSERT_EQUAL(ADS1219_STREAM_IRREGULAR, stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+
+    // fine without suppression, or on another input
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.begin(ADS1219_MUX_SINGLE_1, ADS1219_DATARATE_1000SPS));
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.end());
+    window.setSuppress(false);
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.end());
+    adc_drdy.setWindow(ADS1219_MUX_SINGLE_0, nullptr);
+}
+
+
+#if defined(__linux__)
+
+// Print into the device side of a pseudo terminal
+class FdPrint : public Print {
+public:
+    explicit FdPrint( int fd ) : _fd(fd) {}
+    size_t write( uint8_t c ) override { return write(&c, 1); }
+    size_t write( const uint8_t* buffer, size_t size ) override {
+        size_t n = 0;
+        while ( n < size ) {
+            ssize_t w = ::write(_fd, buffer + n, size - n);
+            if ( w <= 0 ) break;
+            n += static_cast<size_t>( w );
+        }
+        return n;
+    }
+private:
+    int _fd;
+};
+
+static int pty_host = -1;
+static ADS1219PacketDecoder* pty_decoder = nullptr;
+
+static void pty_drain( void )
+{
+    uint8_t buf[4096];
+    ssize_t n;
+    while ( ( n = read(pty_host, buf, sizeof(buf)) ) > 0 ) pty_decoder->push(buf, static_cast<size_t>( n ));
+}
+
+void test_native_packet_pty(void)
+{
+    int master, slave;
+    TEST_ASSERT_EQUAL(0, openpty(&master, &slave, nullptr, nullptr, nullptr));
+
+    // the host reads the slave side in raw mode, like ads1219_decode -t
+    struct termios t;
+    TEST_ASSERT_EQUAL(0, tcgetattr(slave, &t));
+    cfmakeraw(&t);
+    TEST_ASSERT_EQUAL(0, tcsetattr(slave, TCSANOW, &t));
+    fcntl(slave, F_SETFL, fcntl(slave, F_GETFL) | O_NONBLOCK);
+
+    FdPrint out(master);
+    ADS1219PacketStream stream(adc_drdy, out);
+    std::vector<ADS1219PacketSample> samples;
+    ADS1219PacketDecoder decoder(collect, &samples);
+    pty_host    = slave;
+    pty_decoder = &decoder;
+
+    emu_drdy.setInput(0, 1000.f);
+    emu_drdy.setNoise(8.f, 6);
+    TEST_ASSERT_EQUAL(ADS1219_OK, stream.begin(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+    run_stream(stream, 500000UL, pty_drain);
+
+    // the kernel may still hold the last bytes
+    for ( int i = 0; i < 100 && decoder.reader().packets() < stream.packets(); i++ ) {
+        usleep(1000);
+        pty_drain();
+    }
+
+    check_stream(samples, 494);
+    TEST_ASSERT_EQUAL(stream.packets(), decoder.reader().packets());
+    TEST_ASSERT_EQUAL(0, decoder.reader().crcErrors() + decoder.reader().framingErrors() + decoder.reader().dropped());
+
+    pty_decoder = nullptr;
+    close(slave);
+    close(master);
+}
+
+#endif
+
+
+static void count( const ADS1219PacketSample& s, void* context )
+{
+    *static_cast<int64_t*>( context ) += s.value;
+}
+
+void test_native_packet_benchmark(void)
+{
+    using clock = std::chrono::steady_clock;
+    BufferPrint out;
+    ADS1219PacketWriter writer(out);
+    ADS1219RecordEncoder encoder(true, 16);
+    uint8_t frame[ADS1219_RECORD_MAX_FRAME];
+    int64_t sum = 0, check = 0;
+
+    // a slow sine with a little noise, 15 continuous conversions per packet
+    out.data.reserve(TEST_BENCH_SAMPLES * 4);
+    uint32_t rng = 7;
+    clock::time_point t0 = clock::now();
+    for ( unsigned long s = 0; s < TEST_BENCH_SAMPLES; s += ADS1219_PACKET_SAMPLES ) {
+        encoder.beginFrame(s * 1012UL, ADS1219_DATARATE_1000SPS);
+        for ( unsigned long i = s; i < s + ADS1219_PACKET_SAMPLES; i++ ) {
+            rng = rng * 1103515245UL + 12345UL;
+            int32_t v = static_cast<int32_t>( 4000000. * sin( i * 1e-4 ) ) + static_cast<int32_t>( ( rng >> 16 ) & 0x3F ) - 32;
+            check += v;
+            encoder.add(ADS1219_MUX_SINGLE_0, ADS1219_GAIN_ONE, v);
+        }
+        size_t len = encoder.endFrame(frame, sizeof(frame));
+        writer.send(ADS1219_PACKET_RECORD, frame, len);
+    }
+    clock::time_point t1 = clock::now();
+
+    ADS1219PacketDecoder decoder(count, &sum);
+    decoder.push(out.data.data(), out.data.size());
+    clock::time_point t2 = clock::now();
+
+    TEST_ASSERT_EQUAL(TEST_BENCH_SAMPLES, decoder.samples());
+    TEST_ASSERT_TRUE(sum == check);
+
+    double enc_s = std::chrono::duration<double>(t1 - t0).count();
+    double dec_s = std::chrono::duration<double>(t2 - t1).count();
+    printf("%lu samples, %.2f bytes/sample : encode %.1f Msamples/s, decode %.1f Msamples/s (%.0f MB/s)\n",
+           TEST_BENCH_SAMPLES, static_cast<double>(out.data.size()) / TEST_BENCH_SAMPLES, TEST_BENCH_SAMPLES / enc_s / 1e6,
+           TEST_BENCH_SAMPLES / dec_s / 1e6, out.data.size() / dec_s / 1e6);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_packet_crc_cobs);
+    RUN_TEST(test_native_packet_reader);
+    RUN_TEST(test_native_packet_stream);
+    RUN_TEST(test_native_packet_stream_irregular);
+#if defined(__linux__)
+    RUN_TEST(test_native_packet_pty);
+#endif
+    RUN_TEST(test_native_packet_benchmark);
+
+    UNITY_END();
+}
+
+void loop(){}
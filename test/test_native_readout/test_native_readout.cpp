@@ -0,0 +1,550 @@
+#include "unity.h"
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Group.h"
+#include "ADS1219Emulator.h"
+
+// Tests against the emulated ADS1219, only for the native environment. The default device sits on Wire at 
+// 0x40 without DRDY, a second one at 0x41 has its DRDY output wired to pin 5.
+
+#define TEST_DRDY_PIN 5
+
+ADS1219Emulator emu_drdy(Wire, 0x41, TEST_DRDY_PIN);
+ADS1219Emulator emu_2(Wire, 0x42);
+ADS1219Emulator emu_3(Wire, 0x43);
+
+ADS1219 adc;
+ADS1219 adc_drdy(0x41, TEST_DRDY_PIN);
+
+
+void setUp(void) 
+{
+    ArduinoNative::setInterruptsAvailable(true);
+
+    ADS1219Device.powerCycle();
+    emu_drdy.powerCycle();
+    emu_2.powerCycle();
+    emu_3.powerCycle();
+
+    adc.begin();
+    adc.reset();
+    adc_drdy.begin();
+    adc_drdy.reset();
+
+    ADS1219Device.setInput(0, 1000.f);
+    emu_drdy.setInput(0, 1000.f);
+    Wire.resetCounters();
+}
+
+void tearDown(void) 
+{
+}
+
+
+void test_native_single_ended_value(void)
+{
+    uint8_t err;
+
+    // 1000 mV on AIN0 with the internal 2048 mV reference
+    int32_t value = adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_INT32(4096000, value);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1000., adc.milliVolts(value, ADS1219_GAIN_ONE, &err));
+}
+
+void test_native_bus_transactions_status(void)
+{
+    uint8_t err;
+
+    // first read changes the mux : WREG, START, 1 status poll (2), RDATA (2)
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_LESS_OR_EQUAL(6, Wire.transactions());
+
+    // same channel again, no register write at all
+    Wire.resetCounters();
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_LESS_OR_EQUAL(5, Wire.transactions());
+    TEST_ASSERT_EQUAL(1, ADS1219Device.registerWrites());
+}
+
+// bus time per sample in µs for n readings on the same channel
+static unsigned long bus_time_per_sample( ADS1219& dev, uint16_t n )
+{
+    uint8_t err;
+    dev.readSingleEnded(0, &err);
+    Wire.resetCounters();
+    for ( uint16_t i = 0; i < n; i++ ) {
+        dev.readSingleEnded(0, &err);
+        TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    }
+    return Wire.busTime() / n;
+}
+
+void test_native_repeated_start(void)
+{
+    // START, 1 status read, RDATA : the reads save a STOP and the bus free time each
+    adc.setRepeatedStart(false);
+    unsigned long separate = bus_time_per_sample(adc, 20);
+    adc.setRepeatedStart(true);
+    unsigned long fused = bus_time_per_sample(adc, 20);
+
+    Serial.print("bus time per sample, STOP + START : "); Serial.print(separate); Serial.print(" us, repeated START : ");
+    Serial.print(fused); Serial.println(" us");
+
+    TEST_ASSERT_EQUAL(40, separate - fused);
+
+    // same results either way
+    uint8_t err;
+    TEST_ASSERT_EQUAL_INT32(4096000, adc.readSingleEnded(0, &err));
+    uint8_t config;
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.syncConfig());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.getConfig(&config));
+    TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_0, config);
+}
+
+void test_native_drdy_interrupt(void)
+{
+    uint8_t err;
+
+    TEST_ASSERT_EQUAL(ADS1219_READY_DRDY_IRQ, adc_drdy.readyMode());
+
+    adc_drdy.readSingleEnded(0, &err);
+    emu_drdy.resetCounters();
+    Wire.resetCounters();
+
+    unsigned long t0 = micros();
+    int32_t value = adc_drdy.readSingleEnded(0, &err);
+    unsigned long dt = micros() - t0;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_INT32(4096000, value);
+
+    // START + RDATA (2), the status register is never read
+    TEST_ASSERT_EQUAL(3, Wire.transactions());
+    TEST_ASSERT_EQUAL(0, emu_drdy.registerReads());
+
+    // no fixed sleep or polling steps : done right after the 50 ms conversion
+    TEST_ASSERT_LESS_THAN(51000, dt);
+}
+
+void test_native_drdy_poll_fallback(void)
+{
+    uint8_t err;
+    ADS1219 adc_poll(0x41, TEST_DRDY_PIN);
+
+    // pin without interrupt, the driver reads the pin instead
+    ArduinoNative::setInterruptsAvailable(false);
+    adc_poll.begin();
+    TEST_ASSERT_EQUAL(ADS1219_READY_DRDY_POLL, adc_poll.readyMode());
+
+    emu_drdy.resetCounters();
+    int32_t value = adc_poll.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_INT32(4096000, value);
+    TEST_ASSERT_EQUAL(0, emu_drdy.registerReads());
+}
+
+void test_native_async_conversion(void)
+{
+    ADS1219Sample sample;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.beginConversion(ADS1219_MUX_SINGLE_0));
+    TEST_ASSERT_EQUAL(ADS1219_STATE_WAITING, adc.conversionState());
+    TEST_ASSERT_EQUAL(ADS1219_BUSY, adc.beginConversion(ADS1219_MUX_SINGLE_1));
+
+    // nothing happens on the bus during the conversion
+    Wire.resetCounters();
+    TEST_ASSERT_FALSE(adc.poll(&sample));
+    delay(40);
+    TEST_ASSERT_FALSE(adc.poll(&sample));
+    TEST_ASSERT_EQUAL(0, Wire.transactions());
+
+    while ( ! adc.poll(&sample) ) delay(1);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, sample.err_code);
+    TEST_ASSERT_EQUAL(ADS1219_MUX_SINGLE_0, sample.mux);
+    TEST_ASSERT_EQUAL_INT32(4096000, sample.value);
+    TEST_ASSERT_EQUAL(ADS1219_STATE_IDLE, adc.conversionState());
+}
+
+void test_native_stream(void)
+{
+    int32_t buf[ADS1219_STREAM_BUFFER_SIZE];
+    size_t  total = 0;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.startStream(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+    emu_drdy.resetCounters();
+
+    // service every 250 µs during 100 ms
+    unsigned long t0 = micros();
+    while ( micros() - t0 < 100000UL ) {
+        delayMicroseconds(250);
+        TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.serviceStream());
+        size_t n = adc_drdy.readBuffered(buf, ADS1219_STREAM_BUFFER_SIZE);
+        for ( size_t j = 0; j < n; j++ ) TEST_ASSERT_EQUAL_INT32(4096000, buf[j]);
+        total += n;
+    }
+
+    TEST_ASSERT_INT_WITHIN(2, 100, total);
+    TEST_ASSERT_EQUAL(0, adc_drdy.overruns());
+    TEST_ASSERT_EQUAL(0, emu_drdy.starts()); // no START after the first one
+    TEST_ASSERT_EQUAL(0, emu_drdy.registerReads());
+
+    // don't service for 10 ms, 9 conversions are lost
+    delay(10);
+    adc_drdy.serviceStream();
+    TEST_ASSERT_INT_WITHIN(1, 9, adc_drdy.overruns());
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.stopStream());
+}
+
+void test_native_scan_plan(void)
+{
+    ADS1219ScanPlan plan;
+    int32_t results[5];
+    uint8_t errs[5];
+
+    ADS1219Device.setInput(1, 500.f);
+    ADS1219Device.setInput(2, -100.f);
+    ADS1219Device.setInput(3, 2000.f);
+
+    plan.add(ADS1219_MUX_SHORTED);
+    for ( uint8_t i = 0; i < 4; i++ ) plan.addSingleEnded(i);
+
+    ADS1219Device.resetCounters();
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, results, errs));
+
+    TEST_ASSERT_EQUAL_INT32(0, results[0]);
+    TEST_ASSERT_EQUAL_INT32(4096000, results[1]);
+    TEST_ASSERT_EQUAL_INT32(2048000, results[2]);
+    TEST_ASSERT_EQUAL_INT32(-409600, results[3]);
+    TEST_ASSERT_EQUAL_INT32(8192000, results[4]);
+
+    // one mux write per entry, no register reads except the status polls
+    TEST_ASSERT_EQUAL(5, ADS1219Device.registerWrites());
+    TEST_ASSERT_EQUAL(5, ADS1219Device.registerReads());
+    TEST_ASSERT_GREATER_THAN(0, plan.scanRate());
+
+    // not under a conversion or a stream in progress, the configuration is left alone
+    ADS1219Sample sample;
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.beginConversion(ADS1219_MUX_DIFF_0_1));
+    uint8_t config = ADS1219Device.config();
+    ADS1219Device.resetCounters();
+    TEST_ASSERT_EQUAL(ADS1219_BUSY, adc.scan(plan, results, errs));
+    TEST_ASSERT_EQUAL(0, ADS1219Device.registerWrites());
+    TEST_ASSERT_EQUAL_HEX8(config, ADS1219Device.config());
+    while ( ! adc.poll(&sample) ) delay(1);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.startStream(ADS1219_MUX_SINGLE_0, ADS1219_DATARATE_1000SPS));
+    config = ADS1219Device.config();
+    TEST_ASSERT_EQUAL(ADS1219_BUSY, adc.scan(plan, results, errs));
+    TEST_ASSERT_EQUAL_HEX8(config, ADS1219Device.config());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.stopStream());
+}
+
+void test_native_auto_range(void)
+{
+    ADS1219ScanPlan plan;
+    int32_t result;
+    uint8_t err;
+
+    plan.addSingleEnded(1, ADS1219_GAIN_AUTO);
+
+    // a small signal moves up to gain 4 after the first scan, then stays there without any register writes
+    ADS1219Device.setInput(1, 100.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, &result));
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, plan.gain(0));
+    TEST_ASSERT_EQUAL_INT32(409600, result);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, &result));
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, plan.gain(0));
+    TEST_ASSERT_EQUAL_INT32(1638400, result);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.f, adc.milliVolts(result, plan.gain(0), &err));
+
+    ADS1219Device.resetCounters();
+    for ( int s = 0; s < 10; s++ ) adc.scan(plan, &result);
+    TEST_ASSERT_EQUAL(0, ADS1219Device.registerWrites());
+    TEST_ASSERT_EQUAL(10, ADS1219Device.conversions());
+
+    // 450 mV is inside the hysteresis band : it stays at gain 4 ...
+    ADS1219Device.setInput(1, 450.f);
+    for ( int s = 0; s < 3; s++ ) adc.scan(plan, &result);
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, plan.gain(0));
+    TEST_ASSERT_EQUAL_INT32(7372800, result);
+
+    // ... a clipped conversion is done again at gain 1 within the same scan ...
+    ADS1219Device.setInput(1, 1500.f);
+    ADS1219Device.resetCounters();
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, &result, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, plan.gain(0));
+    TEST_ASSERT_EQUAL_INT32(6144000, result);
+    TEST_ASSERT_EQUAL(2, ADS1219Device.conversions());
+    TEST_ASSERT_EQUAL(1, plan.rangeRedos());
+
+    // ... and at gain 1 450 mV stays there too
+    ADS1219Device.setInput(1, 450.f);
+    for ( int s = 0; s < 3; s++ ) adc.scan(plan, &result);
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, plan.gain(0));
+    TEST_ASSERT_EQUAL_INT32(1843200, result);
+    TEST_ASSERT_EQUAL(2, plan.gainSwitches());
+}
+
+void test_native_group(void)
+{
+    ADS1219 adc_2(0x42), adc_3(0x43);
+    ADS1219Group group;
+    int32_t results[3];
+
+    adc_2.begin();
+    adc_3.begin();
+    emu_2.setInput(0, 100.f);
+    emu_3.setInput(0, 200.f);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, group.add(&adc));
+    TEST_ASSERT_EQUAL(ADS1219_OK, group.add(&adc_2));
+    TEST_ASSERT_EQUAL(ADS1219_OK, group.add(&adc_3));
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, group.convert(ADS1219_MUX_SINGLE_0, results));
+    TEST_ASSERT_EQUAL_INT32(4096000, results[0]);
+    TEST_ASSERT_EQUAL_INT32(409600, results[1]);
+    TEST_ASSERT_EQUAL_INT32(819200, results[2]);
+
+    // the three 50 ms conversions overlap
+    TEST_ASSERT_LESS_THAN(60000, group.duration());
+    TEST_ASSERT_GREATER_THAN(50, group.throughput());
+
+    ADS1219Group full;
+    for ( uint8_t i = 0; i < ADS1219_GROUP_MAX_DEVICES; i++ ) TEST_ASSERT_EQUAL(ADS1219_OK, full.add(&adc));
+    TEST_ASSERT_EQUAL(ADS1219_GROUP_FULL, full.add(&adc));
+}
+
+void test_native_stats(void)
+{
+    ADS1219Stats stats;
+    uint8_t err;
+
+    adc.readSingleEnded(0, &err);
+    adc.resetStats();
+    adc.readSingleEnded(0, &err);
+    adc.stats(&stats);
+
+    // START, status poll (2) and RDATA (2), the mux is already set
+    TEST_ASSERT_EQUAL(3, stats.writes);
+    TEST_ASSERT_EQUAL(2, stats.reads);
+    TEST_ASSERT_EQUAL(3, stats.bytes_written);
+    TEST_ASSERT_EQUAL(4, stats.bytes_read);
+    TEST_ASSERT_EQUAL(1, stats.ready_polls);
+    TEST_ASSERT_EQUAL(0, stats.timeouts);
+
+    // one readout of about 56 ms, one status register read of a few 100 µs
+    uint16_t readouts = 0, registers = 0;
+    for ( uint8_t i = 0; i < ADS1219_HIST_BUCKETS; i++ ) {
+        readouts  += stats.readout_us[i];
+        registers += stats.register_us[i];
+    }
+    TEST_ASSERT_EQUAL(1, readouts);
+    TEST_ASSERT_EQUAL(1, stats.readout_us[ADS1219Stats::bucket(56000)]);
+    TEST_ASSERT_EQUAL(1, registers);
+
+    // full scale input is flagged
+    ADS1219Device.setInput(0, 3000.f);
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_ADC_OVERFLOW, err);
+    adc.stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.overflows);
+}
+
+void test_native_oversample(void)
+{
+    ADS1219Oversample r;
+
+    ADS1219Device.setOffset(100);
+    ADS1219Device.setNoise(4.f, 42);
+    ADS1219Device.resetCounters();
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.oversample(ADS1219_MUX_SHORTED, 16, &r, 4));
+    TEST_ASSERT_EQUAL(16, r.valid);
+    TEST_ASSERT_INT_WITHIN(3, 100, r.mean);
+    TEST_ASSERT_INT_WITHIN(8, r.mean * 16, r.value);
+    TEST_ASSERT_LESS_OR_EQUAL(r.mean, r.min);
+    TEST_ASSERT_GREATER_OR_EQUAL(r.mean, r.max);
+
+    // one START, mux + continuous mode and back to single shot, an RDATA per sample
+    TEST_ASSERT_EQUAL(1, ADS1219Device.starts());
+    TEST_ASSERT_EQUAL(2, ADS1219Device.registerWrites());
+    TEST_ASSERT_EQUAL(16, ADS1219Device.dataReads());
+    TEST_ASSERT_EQUAL(16, ADS1219Device.conversions());
+
+    uint8_t mode;
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.getConversionMode(&mode));
+    TEST_ASSERT_EQUAL(ADS1219_CM_SINGLE_SHOT, mode);
+}
+
+void test_native_oversample_rounding(void)
+{
+    ADS1219Oversample r;
+    uint8_t err;
+
+    // 3 samples, no noise : exact
+    ADS1219Device.setOffset(-7);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.oversample(ADS1219_MUX_SHORTED, 3, &r, 2));
+    TEST_ASSERT_EQUAL(3, r.valid);
+    TEST_ASSERT_EQUAL_INT32(-7, r.mean);
+    TEST_ASSERT_EQUAL_INT32(-28, r.value);
+
+    // large counts and many samples don't overflow anymore
+    ADS1219Device.setOffset(0);
+    ADS1219Device.setInput(0, 2000.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_330SPS));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.oversample(ADS1219_MUX_SINGLE_0, 1000, &r));
+    TEST_ASSERT_EQUAL_INT32(8192000, r.mean);
+
+    ADS1219Device.setOffset(-5);
+    TEST_ASSERT_EQUAL_INT32(-5, adc.readShorted(&err, 10));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+}
+
+void test_native_apply_config(void)
+{
+    uint8_t err;
+    ADS1219Config profile(ADS1219_MUX_SINGLE_0, ADS1219_GAIN_FOUR, ADS1219_DATARATE_330SPS, 
+                          ADS1219_CM_SINGLE_SHOT, ADS1219_VREF_EXTERNAL, 0.f, 2500.f);
+
+    // all five fields in a single write, where the setters need one each
+    ADS1219Device.resetCounters();
+    Wire.resetCounters();
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.applyConfig(profile));
+    TEST_ASSERT_EQUAL(1, ADS1219Device.registerWrites());
+    TEST_ASSERT_EQUAL(0, ADS1219Device.registerReads());
+    TEST_ASSERT_EQUAL(1, Wire.transactions());
+
+    // the same profile again doesn't touch the bus
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.applyConfig(profile));
+    TEST_ASSERT_EQUAL(1, Wire.transactions());
+
+    // the external reference is used for the conversion : 100 mV at gain 4 of 2500 mV
+    ADS1219Device.setExternalReference(0.f, 2500.f);
+    ADS1219Device.setInput(0, 100.f);
+    int32_t value = adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_INT_WITHIN(1, 1342177, value);
+    int32_t uv;
+    adc.toMicroVolts(&value, &uv, 1);
+    TEST_ASSERT_INT_WITHIN(1, 100000, uv);
+
+    // and one read for all of it
+    ADS1219Config read;
+    ADS1219Device.resetCounters();
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.readConfig(&read));
+    TEST_ASSERT_EQUAL(1, ADS1219Device.registerReads());
+    TEST_ASSERT_EQUAL_HEX8(profile.reg(), read.reg());
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 2500., read.aref_p);
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.applyConfig(ADS1219Config()));
+}
+
+// time per sample and status reads per sample for n single-shot readings
+static void timed_readings( ADS1219& dev, uint16_t n, unsigned long* us, float* polls )
+{
+    uint8_t err;
+    ADS1219Device.resetCounters();
+    unsigned long t0 = micros();
+    for ( uint16_t i = 0; i < n; i++ ) {
+        dev.readSingleEnded(0, &err);
+        TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    }
+    *us    = ( micros() - t0 ) / n;
+    *polls = ADS1219Device.registerReads() / static_cast<float>( n );
+}
+
+void test_native_conversion_time(void)
+{
+    // single-shot times of table 4 in the specs, the ms value rounded up
+    TEST_ASSERT_EQUAL(51, adc.getConversionTime());
+    TEST_ASSERT_EQUAL(50013, adc.getConversionTimeMicros());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_90SPS));
+    TEST_ASSERT_EQUAL(12, adc.getConversionTime());
+    TEST_ASSERT_EQUAL(11287, adc.getConversionTimeMicros());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setConversionMode(ADS1219_CM_CONTINUOUS));
+    TEST_ASSERT_EQUAL(11262, adc.getConversionTimeMicros());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_1000SPS));
+    TEST_ASSERT_EQUAL(1012, adc.getConversionTimeMicros());
+    TEST_ASSERT_EQUAL(2, adc.getConversionTime());
+}
+
+void test_native_adaptive_timing(void)
+{
+    unsigned long fixed_us, adaptive_us;
+    float fixed_polls, adaptive_polls;
+
+    // a device with a 1.5 % fast oscillator
+    ADS1219Device.setOscillatorError(-0.015f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_90SPS));
+    TEST_ASSERT_EQUAL(0, adc.learnedConversionTime(ADS1219_DATARATE_90SPS));
+
+    timed_readings(adc, 50, &fixed_us, &fixed_polls);
+
+    adc.setAdaptiveTiming(true);
+    timed_readings(adc, 300, &adaptive_us, &adaptive_polls);  // learning
+    timed_readings(adc, 200, &adaptive_us, &adaptive_polls);
+    adc.setAdaptiveTiming(false);
+
+    Serial.print("fixed    : "); Serial.print(fixed_us); Serial.print(" us, "); Serial.print(fixed_polls); Serial.println(" polls/sample");
+    Serial.print("adaptive : "); Serial.print(adaptive_us); Serial.print(" us, "); Serial.print(adaptive_polls); Serial.println(" polls/sample");
+
+    // the status read is started early enough to catch the end of the conversion, so the learned time is 
+    // below the actual conversion time by the bus latency
+    unsigned long actual = ADS1219Emulator::conversionTime(ADS1219_DATARATE_90SPS) * 0.985f;
+    TEST_ASSERT_LESS_THAN(actual, adc.learnedConversionTime(ADS1219_DATARATE_90SPS));
+
+    // less time lost after each conversion, hardly any extra status reads
+    TEST_ASSERT_LESS_THAN(fixed_us - 500, adaptive_us);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 1.f, fixed_polls);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 1.f, adaptive_polls);
+}
+
+void test_native_adaptive_timing_drdy(void)
+{
+    uint8_t err;
+
+    // the DRDY pin gives the exact end of the conversion
+    emu_drdy.setOscillatorError(0.01f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc_drdy.setDataRate(ADS1219_DATARATE_330SPS));
+    adc_drdy.setAdaptiveTiming(true);
+    for ( uint8_t i = 0; i < 50; i++ ) adc_drdy.readSingleEnded(0, &err);
+    adc_drdy.setAdaptiveTiming(false);
+
+    unsigned long actual = ADS1219Emulator::conversionTime(ADS1219_DATARATE_330SPS) * 1.01f;
+    TEST_ASSERT_UINT32_WITHIN(actual / 100, actual, adc_drdy.learnedConversionTime(ADS1219_DATARATE_330SPS));
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_single_ended_value);
+    RUN_TEST(test_native_bus_transactions_status);
+    RUN_TEST(test_native_repeated_start);
+    RUN_TEST(test_native_drdy_interrupt);
+    RUN_TEST(test_native_drdy_poll_fallback);
+    RUN_TEST(test_native_async_conversion);
+    RUN_TEST(test_native_stream);
+    RUN_TEST(test_native_scan_plan);
+    RUN_TEST(test_native_auto_range);
+    RUN_TEST(test_native_group);
+    RUN_TEST(test_native_stats);
+    RUN_TEST(test_native_oversample);
+    RUN_TEST(test_native_oversample_rounding);
+    RUN_TEST(test_native_apply_config);
+    RUN_TEST(test_native_conversion_time);
+    RUN_TEST(test_native_adaptive_timing);
+    RUN_TEST(test_native_adaptive_timing_drdy);
+
+    UNITY_END();
+}
+
+void loop(){}
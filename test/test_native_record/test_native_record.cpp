@@ -0,0 +1,247 @@
+#include "unity.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Record.h"
+#include "ADS1219Emulator.h"
+
+// Binary record frames : round trips in both modes, keyframes, damaged streams and the size against the
+// text lines of examples/read_single_ended
+
+#define TEST_RECORD_SCANS 200
+
+ADS1219 adc;
+ADS1219ScanPlan plan;
+
+uint8_t stream[TEST_RECORD_SCANS * ADS1219_RECORD_MAX_FRAME];
+int32_t scans[TEST_RECORD_SCANS][5];
+unsigned long stamps[TEST_RECORD_SCANS];
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    adc.begin();
+    adc.reset();
+}
+
+void tearDown(void)
+{
+}
+
+
+// shorted input and 4 slowly drifting single ended channels with a bit of noise
+static void acquire( void )
+{
+    plan.clear();
+    plan.add(ADS1219_MUX_SHORTED);
+    for ( uint8_t i = 0; i < 4; i++ ) plan.addSingleEnded(i);
+
+    ADS1219Device.setNoise(2.f, 3);
+    for ( int s = 0; s < TEST_RECORD_SCANS; s++ ) {
+        for ( uint8_t i = 0; i < 4; i++ ) ADS1219Device.setInput(i, 250.f * i + 0.05f * s);
+        stamps[s] = micros();
+        TEST_ASSERT_EQUAL(ADS1219_OK, adc.scan(plan, scans[s]));
+    }
+}
+
+static size_t encode_all( ADS1219RecordEncoder& enc )
+{
+    size_t n = 0;
+    for ( int s = 0; s < TEST_RECORD_SCANS; s++ ) {
+        size_t len = enc.encodeScan(plan, scans[s], stamps[s], ADS1219_DATARATE_20SPS, ADS1219_GAIN_ONE, stream + n, sizeof(stream) - n);
+        TEST_ASSERT_GREATER_THAN(0, len);
+        n += len;
+    }
+    return n;
+}
+
+static void check_decode( size_t len )
+{
+    ADS1219RecordDecoder dec;
+    ADS1219RecordFrame frame;
+    uint8_t err;
+    size_t pos = 0;
+
+    for ( int s = 0; s < TEST_RECORD_SCANS; s++ ) {
+        size_t used = dec.decode(stream + pos, len - pos, &frame, &err);
+        TEST_ASSERT_EQUAL(ADS1219_OK, err);
+        TEST_ASSERT_GREATER_THAN(0, used);
+        pos += used;
+
+        TEST_ASSERT_EQUAL(5, frame.size);
+        TEST_ASSERT_EQUAL(static_cast<uint64_t>(stamps[s] & 0xFFFFFFFF), frame.timestamp_us);
+        TEST_ASSERT_EQUAL(ADS1219_DATARATE_20SPS, frame.rate);
+        TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SHORTED, frame.mux[0]);
+        TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_3, frame.mux[4]);
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_ONE, frame.gain[2]);
+        TEST_ASSERT_EQUAL_INT32_ARRAY(scans[s], frame.value, 5);
+    }
+    TEST_ASSERT_EQUAL(len, pos);
+}
+
+// the text line of examples/read_single_ended for a scan
+static size_t text_size( const int32_t* values )
+{
+    char line[200];
+    size_t n = 0;
+    for ( uint8_t i = 0; i < 5; i++ ) n += snprintf(line, sizeof(line), "%ld;", static_cast<long>(values[i]));
+    for ( uint8_t i = 0; i < 5; i++ ) n += snprintf(line, sizeof(line), "%.6f;", values[i] * 2048. / 8388608.);
+    return n - 1 + 2;
+}
+
+void test_native_record_roundtrip(void)
+{
+    acquire();
+
+    size_t text = 0;
+    for ( int s = 0; s < TEST_RECORD_SCANS; s++ ) text += text_size( scans[s] );
+
+    ADS1219RecordEncoder raw;
+    size_t raw_len = encode_all(raw);
+    check_decode(raw_len);
+
+    ADS1219RecordEncoder delta(true);
+    size_t delta_len = encode_all(delta);
+    check_decode(delta_len);
+
+    printf("%d scans of 5 samples : text %u bytes, 24 bit %u bytes (%.1fx), delta %u bytes (%.1fx)\n", TEST_RECORD_SCANS,
+           static_cast<unsigned>(text), static_cast<unsigned>(raw_len), static_cast<double>(text) / raw_len,
+           static_cast<unsigned>(delta_len), static_cast<double>(text) / delta_len);
+
+    TEST_ASSERT_GREATER_OR_EQUAL(3 * raw_len, text);
+    TEST_ASSERT_GREATER_OR_EQUAL(5 * delta_len, text);
+}
+
+void test_native_record_layout(void)
+{
+    ADS1219RecordEncoder enc(true, 4);
+    ADS1219RecordDecoder dec;
+    ADS1219RecordFrame frame;
+    uint8_t buf[ADS1219_RECORD_MAX_FRAME];
+    uint8_t err;
+
+    // keyframe first, then every 4th frame, and on every layout change
+    bool expected[] = { true, false, false, false, true, false, true, true };
+    for ( int f = 0; f < 8; f++ ) {
+        enc.beginFrame(1000UL * f, ADS1219_DATARATE_90SPS);
+        TEST_ASSERT_EQUAL(ADS1219_OK, enc.add(ADS1219_MUX_DIFF_0_1, ADS1219_GAIN_FOUR, -8388608));
+        TEST_ASSERT_EQUAL(ADS1219_OK, enc.add(ADS1219_MUX_SINGLE_2, f < 6 ? ADS1219_GAIN_ONE : ADS1219_GAIN_FOUR, 8388607 - f));
+        if ( f == 7 ) TEST_ASSERT_EQUAL(ADS1219_OK, enc.add(ADS1219_MUX_SINGLE_3, ADS1219_GAIN_ONE, static_cast<int32_t>(0x80000000)));
+        size_t len = enc.endFrame(buf, sizeof(buf));
+
+        TEST_ASSERT_EQUAL(len, dec.decode(buf, len, &frame, &err));
+        TEST_ASSERT_EQUAL(ADS1219_OK, err);
+        TEST_ASSERT_EQUAL(expected[f], frame.keyframe);
+        TEST_ASSERT_EQUAL(1000UL * f, frame.timestamp_us);
+        TEST_ASSERT_EQUAL(ADS1219_DATARATE_90SPS, frame.rate);
+        TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, frame.gain[0]);
+        TEST_ASSERT_EQUAL(f < 6 ? ADS1219_GAIN_ONE : ADS1219_GAIN_FOUR, frame.gain[1]);
+        TEST_ASSERT_EQUAL_INT32(-8388608, frame.value[0]);
+        TEST_ASSERT_EQUAL_INT32(8388607 - f, frame.value[1]);
+        if ( f == 7 ) {
+            TEST_ASSERT_EQUAL(3, frame.size);
+            TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(0x80000000), frame.value[2]);
+        }
+        // the full scale delta of a keyframe takes 4 bytes, the small ones 1
+        if ( f == 1 ) TEST_ASSERT_EQUAL(1 + 2 + 1 + 1, len);
+    }
+
+    // a value outside the 24 bit range, a full frame, a buffer which is too small
+    enc.beginFrame(0, ADS1219_DATARATE_20SPS);
+    TEST_ASSERT_EQUAL(ADS1219_RECORD_INVALID, enc.add(ADS1219_MUX_SHORTED, ADS1219_GAIN_ONE, 8388608));
+    for ( int i = 0; i < ADS1219_RECORD_MAX_SAMPLES; i++ ) TEST_ASSERT_EQUAL(ADS1219_OK, enc.add(ADS1219_MUX_SHORTED, ADS1219_GAIN_ONE, i));
+    TEST_ASSERT_EQUAL(ADS1219_RECORD_FULL, enc.add(ADS1219_MUX_SHORTED, ADS1219_GAIN_ONE, 0));
+    TEST_ASSERT_EQUAL(0, enc.endFrame(buf, sizeof(buf) - 1));
+}
+
+void test_native_record_damaged(void)
+{
+    ADS1219RecordEncoder enc(true, 8);
+    ADS1219RecordDecoder dec;
+    ADS1219RecordFrame frame;
+    uint8_t err;
+
+    acquire();
+    size_t len = encode_all(enc);
+
+    // every prefix of a frame is truncated, and doesn't change the decoder
+    size_t first = dec.decode(stream, len, &frame, &err);
+    for ( size_t i = 0; i < first; i++ ) {
+        ADS1219RecordDecoder d;
+        TEST_ASSERT_EQUAL(0, d.decode(stream, i, &frame, &err));
+        TEST_ASSERT_EQUAL(ADS1219_RECORD_TRUNCATED, err);
+    }
+
+    // reserved bit, no samples
+    uint8_t bad[] = { 0x85, 0x00 };
+    TEST_ASSERT_EQUAL(0, dec.decode(bad, sizeof(bad), &frame, &err));
+    TEST_ASSERT_EQUAL(ADS1219_RECORD_INVALID, err);
+    bad[0] = 0x10;
+    TEST_ASSERT_EQUAL(0, dec.decode(bad, sizeof(bad), &frame, &err));
+    TEST_ASSERT_EQUAL(ADS1219_RECORD_INVALID, err);
+
+    // joining the stream after the first frame : skip up to the next keyframe, then all is in sync
+    ADS1219RecordDecoder late;
+    size_t pos = first;
+    int s = 1, skipped = 0;
+    for ( ; s < TEST_RECORD_SCANS; s++ ) {
+        size_t used = late.decode(stream + pos, len - pos, &frame, &err);
+        TEST_ASSERT_GREATER_THAN(0, used);
+        pos += used;
+        if ( err == ADS1219_RECORD_NO_LAYOUT ) {
+            skipped++;
+            continue;
+        }
+        TEST_ASSERT_EQUAL(ADS1219_OK, err);
+        TEST_ASSERT_EQUAL_INT32_ARRAY(scans[s], frame.value, 5);
+    }
+    TEST_ASSERT_EQUAL(7, skipped);
+    TEST_ASSERT_EQUAL(len, pos);
+}
+
+void test_native_record_benchmark(void)
+{
+    using clock = std::chrono::steady_clock;
+    ADS1219RecordEncoder enc(true);
+    ADS1219RecordDecoder dec;
+    ADS1219RecordFrame frame;
+    uint8_t err;
+    size_t len = 0;
+
+    acquire();
+
+    clock::time_point t0 = clock::now();
+    for ( int r = 0; r < 100; r++ ) {
+        enc.reset();
+        len = encode_all(enc);
+    }
+    clock::time_point t1 = clock::now();
+    for ( int r = 0; r < 100; r++ ) {
+        dec.reset();
+        for ( size_t pos = 0; pos < len; ) pos += dec.decode(stream + pos, len - pos, &frame, &err);
+    }
+    clock::time_point t2 = clock::now();
+
+    double n = 100. * TEST_RECORD_SCANS * 5;
+    printf("delta record : encode %.2f ns/sample, decode %.2f ns/sample\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / n, std::chrono::duration<double, std::nano>(t2 - t1).count() / n);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_record_roundtrip);
+    RUN_TEST(test_native_record_layout);
+    RUN_TEST(test_native_record_damaged);
+    RUN_TEST(test_native_record_benchmark);
+
+    UNITY_END();
+}
+
+void loop(){}
@@ -0,0 +1,266 @@
+#include "unity.h"
+
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219Emulator.h"
+
+// Error recovery against injected bus faults : retries, the retry deadline, clearing a stuck SDA, device
+// resets with the configuration replayed and a soak test with random NACKs
+
+#define TEST_SDA_PIN 20
+#define TEST_SCL_PIN 21
+
+ADS1219 adc;
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    ADS1219Device.setBusPins(TEST_SDA_PIN, TEST_SCL_PIN);
+    adc.begin();
+    adc.reset();
+    adc.setRetry(0);
+    adc.setAutoRecover(false);
+    adc.setBusClearPins(0xFF, 0xFF);
+    adc.resetRecovery();
+
+    ADS1219Device.setInput(0, 1000.f);
+}
+
+void tearDown(void)
+{
+    ADS1219Device.setFaultRate(0.f);
+    ADS1219Device.failNext(0);
+}
+
+
+void test_native_recovery_retry(void)
+{
+    ADS1219Recovery r;
+    uint8_t err;
+
+    // without a policy the error comes straight out
+    ADS1219Device.failNext(1);
+    TEST_ASSERT_EQUAL_INT32(static_cast<int32_t>(0x80000000), adc.readSingleEnded(0, &err));
+    TEST_ASSERT_TRUE(ads1219_bus_error(err));
+
+    // with it, the glitch is invisible
+    adc.setRetry(2);
+    ADS1219Device.failNext(2);
+    TEST_ASSERT_EQUAL_INT32(4096000, adc.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+
+    adc.recovery(&r);
+    TEST_ASSERT_EQUAL(2, r.retries);
+    TEST_ASSERT_EQUAL(1, r.failures);
+    TEST_ASSERT_EQUAL(1, r.bus_clears);  // before the second retry, Wire restarted without pins
+    TEST_ASSERT_GREATER_THAN(0, r.stall_max_us);
+}
+
+void test_native_recovery_deadline(void)
+{
+    ADS1219Recovery r;
+
+    // a device which is gone : the retries stop at the deadline
+    adc.setRetry(200, 3000);
+    ADS1219Device.failNext(1000);
+    unsigned long t0 = micros();
+    TEST_ASSERT_TRUE(ads1219_bus_error(adc.start()));
+    unsigned long stall = micros() - t0;
+
+    adc.recovery(&r);
+    printf("deadline 3000 us : %lu retries, stalled %lu us\n", static_cast<unsigned long>(r.retries), stall);
+    TEST_ASSERT_EQUAL(1, r.failures);
+    TEST_ASSERT_LESS_THAN(200, r.retries);
+    TEST_ASSERT_GREATER_OR_EQUAL(3000, stall);
+    TEST_ASSERT_LESS_THAN(3000 + 500, stall);
+}
+
+void test_native_recovery_bus_clear(void)
+{
+    ADS1219Recovery r;
+    uint8_t err;
+
+    adc.setRetry(3);
+    adc.setBusClearPins(TEST_SDA_PIN, TEST_SCL_PIN);
+    ArduinoNative::setPullUp(TEST_SDA_PIN, true);
+    ArduinoNative::setPullUp(TEST_SCL_PIN, true);
+
+    // the device holds SDA for the rest of a byte : the bus clear clocks it out and sends a STOP
+    ADS1219Device.stickSda(6);
+    TEST_ASSERT_EQUAL(LOW, digitalRead(TEST_SDA_PIN));
+    TEST_ASSERT_EQUAL_INT32(4096000, adc.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_FALSE(ADS1219Device.sdaStuck());
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(TEST_SDA_PIN));
+    TEST_ASSERT_EQUAL(HIGH, digitalRead(TEST_SCL_PIN));
+
+    // open drain : the lines were only pulled low, and are left to the pull-ups
+    TEST_ASSERT_EQUAL(0, ArduinoNative::pinDrivenHigh(TEST_SDA_PIN));
+    TEST_ASSERT_EQUAL(0, ArduinoNative::pinDrivenHigh(TEST_SCL_PIN));
+    TEST_ASSERT_EQUAL(INPUT, ArduinoNative::pinModeOf(TEST_SDA_PIN));
+    TEST_ASSERT_EQUAL(INPUT, ArduinoNative::pinModeOf(TEST_SCL_PIN));
+
+    adc.recovery(&r);
+    TEST_ASSERT_EQUAL(1, r.bus_clears);
+    TEST_ASSERT_EQUAL(0, r.failures);
+}
+
+void test_native_recovery_replay(void)
+{
+    ADS1219Recovery r;
+    uint8_t err;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_90SPS));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setGain(ADS1219_GAIN_FOUR));
+    ADS1219Device.setInput(0, 100.f);
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    uint8_t config = ADS1219Device.config();
+
+    // a brown-out puts the device back to its defaults, and the bus glitches : the retries don't help, 
+    // the recovery resets the device, replays the configuration and redoes the conversion
+    ADS1219Device.powerCycle();
+    ADS1219Device.setInput(0, 100.f);
+    adc.setRetry(1);
+    adc.setAutoRecover(true);
+    ADS1219Device.failNext(2);
+
+    TEST_ASSERT_EQUAL_INT32(1638400, adc.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_HEX8(config, ADS1219Device.config());
+
+    adc.recovery(&r);
+    TEST_ASSERT_EQUAL(1, r.resets);
+    TEST_ASSERT_EQUAL(1, r.failures);
+    TEST_ASSERT_GREATER_THAN(0, r.recover_max_us);
+
+    // the replay itself is NACKed : the device is left with its defaults, the next recovery replays the
+    // configuration again and not the defaults of the reset in between
+    ADS1219Device.powerCycle();
+    ADS1219Device.failWrites(2);
+    TEST_ASSERT_EQUAL(ADS1219_FAILED_TO_END, adc.recover());
+    TEST_ASSERT_EQUAL_HEX8(0x00, ADS1219Device.config());
+
+    // a register change in between builds on the configuration to replay, not on the defaults
+    ADS1219Device.failWrites(2);
+    TEST_ASSERT_EQUAL(ADS1219_FAILED_TO_END, adc.recover());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_330SPS));
+    TEST_ASSERT_EQUAL_HEX8(( config & ADS1219_CONFIG_MASK_DR ) | ( ADS1219_DATARATE_330SPS << 2 ), ADS1219Device.config());
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_90SPS));
+
+    ADS1219Device.powerCycle();
+    ADS1219Device.setInput(0, 100.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.recover());
+    TEST_ASSERT_EQUAL_HEX8(config, ADS1219Device.config());
+    TEST_ASSERT_EQUAL_INT32(1638400, adc.readSingleEnded(0, &err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+}
+
+// 2000 readouts at 1000 SPS with 5 % of the transactions NACKed
+static uint32_t soak( unsigned long* worst_us )
+{
+    uint32_t lost = 0;
+    uint8_t err;
+
+    ADS1219Device.setFaultRate(0.05f, 7);
+    *worst_us = 0;
+    for ( int i = 0; i < 2000; i++ ) {
+        unsigned long t0 = micros();
+        adc.readSingleEnded(0, &err);
+        unsigned long us = micros() - t0;
+        if ( err != ADS1219_OK ) lost++;
+        if ( us > *worst_us ) *worst_us = us;
+    }
+    ADS1219Device.setFaultRate(0.f);
+
+    return lost;
+}
+
+void test_native_recovery_soak(void)
+{
+    ADS1219Recovery r;
+    unsigned long worst;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_1000SPS));
+
+    uint32_t lost = soak(&worst);
+    printf("no policy : %lu of 2000 samples lost, worst readout %lu us\n", static_cast<unsigned long>(lost), worst);
+    TEST_ASSERT_GREATER_THAN(100, lost);
+
+    adc.setRetry(3, 2000);
+    adc.setAutoRecover(true);
+    adc.resetRecovery();
+    lost = soak(&worst);
+
+    adc.recovery(&r);
+    printf("retries + recovery : %lu lost, worst readout %lu us, %lu retries, %lu failures, %lu bus clears, %lu resets, "
+           "stall max %lu us, recovery max %lu us\n", static_cast<unsigned long>(lost), worst,
+           static_cast<unsigned long>(r.retries), static_cast<unsigned long>(r.failures), static_cast<unsigned long>(r.bus_clears),
+           static_cast<unsigned long>(r.resets), r.stall_max_us, r.recover_max_us);
+    TEST_ASSERT_EQUAL(0, lost);
+    TEST_ASSERT_GREATER_THAN(0, r.retries);
+    TEST_ASSERT_LESS_THAN(2000 + 1000, r.stall_max_us);
+    TEST_ASSERT_LESS_THAN(10000, worst);
+}
+
+void test_native_recovery_soak_replay(void)
+{
+    ADS1219Recovery r;
+    uint32_t lost = 0, wrong = 0;
+    unsigned long worst = 0;
+    uint8_t err;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setDataRate(ADS1219_DATARATE_1000SPS));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setGain(ADS1219_GAIN_FOUR));
+    ADS1219Device.setInput(0, 100.f);
+    adc.readSingleEnded(0, &err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    uint8_t config = ADS1219Device.config();
+
+    // no retries : every bus error goes to a recovery, and with 20 % of the transactions NACKed plenty of
+    // the resets and replays fail as well, the first few replays for sure
+    adc.setAutoRecover(true);
+    adc.resetRecovery();
+    ADS1219Device.setFaultRate(0.2f, 11);
+    ADS1219Device.failWrites(3);
+    for ( int i = 0; i < 2000; i++ ) {
+        unsigned long t0 = micros();
+        int32_t value = adc.readSingleEnded(0, &err);
+        unsigned long us = micros() - t0;
+        if ( err != ADS1219_OK ) lost++;
+        else if ( value != 1638400 ) wrong++;
+        if ( us > worst ) worst = us;
+    }
+    ADS1219Device.setFaultRate(0.f);
+
+    adc.recovery(&r);
+    printf("replay soak : %lu lost, %lu wrong, worst readout %lu us, %lu resets\n", static_cast<unsigned long>(lost),
+           static_cast<unsigned long>(wrong), worst, static_cast<unsigned long>(r.resets));
+
+    // lost samples, but never one at the defaults (gain 1, 20 SPS) of a reset without its replay
+    TEST_ASSERT_GREATER_THAN(0, lost);
+    TEST_ASSERT_GREATER_THAN(0, r.resets);
+    TEST_ASSERT_EQUAL(0, wrong);
+    TEST_ASSERT_LESS_THAN(10000, worst);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.recover());
+    TEST_ASSERT_EQUAL_HEX8(config, ADS1219Device.config());
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_recovery_retry);
+    RUN_TEST(test_native_recovery_deadline);
+    RUN_TEST(test_native_recovery_bus_clear);
+    RUN_TEST(test_native_recovery_replay);
+    RUN_TEST(test_native_recovery_soak);
+    RUN_TEST(test_native_recovery_soak_replay);
+
+    UNITY_END();
+}
+
+void loop(){}
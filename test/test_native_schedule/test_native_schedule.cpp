@@ -0,0 +1,207 @@
+#include "unity.h"
+
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Scheduler.h"
+#include "ADS1219Emulator.h"
+
+// Periodic scans on the virtual clock : result alignment, the late policies and the per entry timestamps
+
+#define TEST_PERIOD_US 50000UL
+
+ADS1219 adc;
+ADS1219ScanPlan plan;
+int32_t results[5];
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    adc.begin();
+    adc.reset();
+    adc.setDataRate(ADS1219_DATARATE_330SPS);
+
+    plan.clear();
+    plan.add(ADS1219_MUX_SHORTED);
+    for ( uint8_t i = 0; i < 4; i++ ) plan.addSingleEnded(i);
+}
+
+void tearDown(void)
+{
+}
+
+
+// call run() like a main loop doing 1 ms of other work per pass, until n scans ran
+static void run_scans( ADS1219Scheduler& sched, uint32_t n )
+{
+    for ( uint32_t s = 0; s < n; ) {
+        if ( sched.run(results) ) s++;
+        else delay(1);
+    }
+}
+
+static void print_stats( const char* name, const ADS1219ScheduleStats& st )
+{
+    printf("%s : %lu scans, %lu missed, %lu overruns, jitter max %lu mean %lu rms %lu us, slack min %ld us, lead %lu us\n",
+           name, static_cast<unsigned long>(st.scans), static_cast<unsigned long>(st.missed),
+           static_cast<unsigned long>(st.overruns), st.jitter_max_us, st.jitter_mean_us, st.jitter_rms_us,
+           st.slack_min_us, st.lead_us);
+}
+
+void test_native_schedule_align_result(void)
+{
+    ADS1219Scheduler sched(adc, plan);
+    ADS1219ScheduleStats st;
+
+    sched.begin(TEST_PERIOD_US);
+    unsigned long first = sched.nextTick();
+
+    for ( uint32_t s = 0; s < 100; ) {
+        if ( ! sched.run(results) ) {
+            delay(1);
+            continue;
+        }
+        // on the grid, the result just before the tick
+        TEST_ASSERT_EQUAL(first + s * TEST_PERIOD_US, sched.tick());
+        TEST_ASSERT_TRUE(static_cast<long>(sched.tick() - micros()) >= 0);
+        TEST_ASSERT_TRUE(sched.tick() - micros() < 2000);
+        s++;
+    }
+
+    sched.stats(&st);
+    print_stats("align result", st);
+    TEST_ASSERT_EQUAL(100, st.scans);
+    TEST_ASSERT_EQUAL(0, st.missed);
+    TEST_ASSERT_EQUAL(0, st.overruns);
+    TEST_ASSERT_LESS_THAN(50, st.jitter_max_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, st.slack_min_us);
+}
+
+void test_native_schedule_align_start(void)
+{
+    ADS1219Scheduler sched(adc, plan);
+    ADS1219ScheduleStats st;
+
+    sched.setAlignment(ADS1219_ALIGN_START);
+    sched.begin(TEST_PERIOD_US);
+    run_scans(sched, 20);
+
+    // the last scan started at its tick : the first conversion after the multiplexer write
+    TEST_ASSERT_TRUE(plan.startTime(0) - sched.tick() < 1000);
+    sched.stats(&st);
+    TEST_ASSERT_EQUAL(0, st.overruns);
+    TEST_ASSERT_LESS_THAN(50, st.jitter_max_us);
+}
+
+void test_native_schedule_skip(void)
+{
+    ADS1219Scheduler sched(adc, plan);
+    ADS1219ScheduleStats st;
+
+    sched.begin(TEST_PERIOD_US);
+    run_scans(sched, 5);
+    unsigned long tick = sched.tick();
+
+    // the application blocks for 4 periods : the scans of 3 ticks would start more than a period late and are
+    // dropped, the next one is back on the grid
+    delay(4 * TEST_PERIOD_US / 1000);
+    TEST_ASSERT_TRUE(sched.run(results));
+    TEST_ASSERT_EQUAL(tick + 4 * TEST_PERIOD_US, sched.tick());
+    run_scans(sched, 5);
+    TEST_ASSERT_EQUAL(tick + 9 * TEST_PERIOD_US, sched.tick());
+
+    sched.stats(&st);
+    print_stats("skip", st);
+    TEST_ASSERT_EQUAL(11, st.scans);
+    TEST_ASSERT_EQUAL(3, st.missed);
+}
+
+void test_native_schedule_catch_up(void)
+{
+    ADS1219Scheduler sched(adc, plan);
+    ADS1219ScheduleStats st;
+
+    sched.setPolicy(ADS1219_SCHEDULE_CATCH_UP);
+    sched.begin(TEST_PERIOD_US);
+    run_scans(sched, 5);
+    unsigned long tick = sched.tick();
+
+    // every tick still gets its scan, back to back until on time again
+    delay(3 * TEST_PERIOD_US / 1000 + TEST_PERIOD_US / 2000);
+    for ( int s = 1; s <= 10; s++ ) {
+        while ( ! sched.run(results) ) delay(1);
+        TEST_ASSERT_EQUAL(tick + s * TEST_PERIOD_US, sched.tick());
+    }
+
+    sched.stats(&st);
+    print_stats("catch up", st);
+    TEST_ASSERT_EQUAL(15, st.scans);
+    TEST_ASSERT_EQUAL(0, st.missed);
+    TEST_ASSERT_GREATER_THAN(0, st.overruns);
+    TEST_ASSERT_LESS_THAN(0, st.slack_min_us);
+    TEST_ASSERT_GREATER_THAN(2 * TEST_PERIOD_US, st.jitter_max_us);
+}
+
+void test_native_schedule_entry_times(void)
+{
+    ADS1219Scheduler sched(adc, plan);
+
+    sched.begin(TEST_PERIOD_US);
+    run_scans(sched, 1);
+
+    unsigned long ct = ads1219_conversion_us(ADS1219_DATARATE_330SPS);
+    for ( uint8_t i = 0; i < plan.size(); i++ ) {
+        TEST_ASSERT_TRUE(plan.endTime(i) - plan.startTime(i) >= ct);
+        TEST_ASSERT_TRUE(plan.endTime(i) - plan.startTime(i) < ct + 1000);
+        if ( i > 0 ) TEST_ASSERT_TRUE(static_cast<long>(plan.startTime(i) - plan.endTime(i - 1)) >= 0);
+    }
+    TEST_ASSERT_TRUE(static_cast<long>(sched.tick() - plan.endTime(plan.size() - 1)) >= 0);
+}
+
+void test_native_schedule_busy(void)
+{
+    ADS1219Scheduler sched(adc, plan);
+    ADS1219ScheduleStats st;
+    ADS1219Sample sample;
+
+    sched.begin(TEST_PERIOD_US);
+    unsigned long first = sched.nextTick();
+
+    // a conversion of the application holds the driver past the start of the first scan
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.beginConversion(ADS1219_MUX_SINGLE_0));
+    delay(TEST_PERIOD_US / 1000);
+    TEST_ASSERT_FALSE(sched.run(results));
+    TEST_ASSERT_EQUAL(ADS1219_BUSY, sched.lastError());
+    TEST_ASSERT_EQUAL(first, sched.nextTick());
+    sched.stats(&st);
+    TEST_ASSERT_EQUAL(0, st.scans);
+    TEST_ASSERT_EQUAL(0, st.missed);
+
+    // once it's collected the same tick is scanned
+    while ( ! adc.poll(&sample) ) delay(1);
+    TEST_ASSERT_TRUE(sched.run(results));
+    TEST_ASSERT_EQUAL(ADS1219_OK, sched.lastError());
+    TEST_ASSERT_EQUAL(first, sched.tick());
+    TEST_ASSERT_EQUAL(first + TEST_PERIOD_US, sched.nextTick());
+    sched.stats(&st);
+    TEST_ASSERT_EQUAL(1, st.scans);
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_schedule_align_result);
+    RUN_TEST(test_native_schedule_align_start);
+    RUN_TEST(test_native_schedule_skip);
+    RUN_TEST(test_native_schedule_catch_up);
+    RUN_TEST(test_native_schedule_entry_times);
+    RUN_TEST(test_native_schedule_busy);
+
+    UNITY_END();
+}
+
+void loop(){}
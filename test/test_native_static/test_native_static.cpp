@@ -0,0 +1,142 @@
+#include "unity.h"
+
+#include "ADS1219.h"
+#include "ADS1219T.h"
+#include "ADS1219Emulator.h"
+
+// Compile time specialised driver against the emulated device and the runtime class
+
+typedef ADS1219StaticConfig<ADS1219_GAIN_FOUR, ADS1219_VREF_INTERNAL, ADS1219_DATARATE_330SPS> Config;
+typedef ADS1219StaticConfig<ADS1219_GAIN_ONE, ADS1219_VREF_EXTERNAL, ADS1219_DATARATE_1000SPS, 
+                            ADS1219_CM_SINGLE_SHOT, 500000L, 4500000L> ExternalConfig;
+
+static_assert( Config::reg == 0x18, "gain 4, 330 SPS" );
+static_assert( ExternalConfig::reg == 0x0D, "external reference, 1000 SPS" );
+static_assert( Config::conversion_us == 3068, "330 SPS, 3141 clock periods" );
+
+typedef ADS1219StaticConfig<ADS1219_GAIN_ONE, ADS1219_VREF_INTERNAL, ADS1219_DATARATE_1000SPS,
+                            ADS1219_CM_CONTINUOUS> ContinuousConfig;
+
+ADS1219T<0x40, 0, ADS1219Wire, Config> sadc;
+ADS1219 adc;
+
+
+void setUp(void) 
+{
+    ADS1219Device.powerCycle();
+    ADS1219Device.setInput(0, 300.f);
+    ADS1219Device.setInput(1, -150.f);
+}
+
+void tearDown(void) 
+{
+}
+
+
+void test_native_static_begin(void)
+{
+    TEST_ASSERT_EQUAL(ADS1219_OK, sadc.begin());
+    TEST_ASSERT_EQUAL_HEX8(Config::reg, ADS1219Device.config());
+}
+
+void test_native_static_reset_twice(void)
+{
+    uint8_t err;
+
+    // the cached multiplexer setting matches the one written by reset(), the configuration still goes out
+    TEST_ASSERT_EQUAL(ADS1219_OK, sadc.begin());
+    TEST_ASSERT_EQUAL(ADS1219_OK, sadc.reset());
+    TEST_ASSERT_EQUAL_HEX8(Config::reg, ADS1219Device.config());
+
+    sadc.read<ADS1219_MUX_DIFF_0_1>(&err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, sadc.reset());
+    TEST_ASSERT_EQUAL_HEX8(Config::reg, ADS1219Device.config());
+}
+
+void test_native_static_read(void)
+{
+    uint8_t err;
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, sadc.begin());
+
+    // 300 mV at gain 4
+    int32_t v = sadc.read<ADS1219_MUX_SINGLE_0>(&err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_INT32(4915200, v);
+    TEST_ASSERT_EQUAL_INT32(300000, sadc.microVolts(v));
+
+    v = sadc.read<ADS1219_MUX_SINGLE_1>(&err);
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL_INT32(-150000, sadc.microVolts(v));
+
+    // same mux again : no register write
+    ADS1219Device.resetCounters();
+    sadc.read<ADS1219_MUX_SINGLE_1>(&err);
+    TEST_ASSERT_EQUAL(0, ADS1219Device.registerWrites());
+}
+
+void test_native_static_continuous(void)
+{
+    ADS1219T<0x40, 0, ADS1219Wire, ContinuousConfig> cadc;
+    uint8_t err;
+
+    // the first read after begin() is on the multiplexer setting of reset(), it still needs a START
+    ADS1219Device.setInput(0, 100.f);
+    ADS1219Device.setInput(1, 40.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, cadc.begin());
+    ADS1219Device.resetCounters();
+    TEST_ASSERT_EQUAL_INT32(245760, cadc.read<ADS1219_MUX_DIFF_0_1>(&err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(1, ADS1219Device.starts());
+
+    // then the conversions keep running
+    TEST_ASSERT_EQUAL_INT32(245760, cadc.read<ADS1219_MUX_DIFF_0_1>(&err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(1, ADS1219Device.starts());
+
+    // a new multiplexer setting restarts them
+    TEST_ASSERT_EQUAL_INT32(409600, cadc.read<ADS1219_MUX_SINGLE_0>(&err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(2, ADS1219Device.starts());
+
+    // and so does the next read after a power down
+    TEST_ASSERT_EQUAL(ADS1219_OK, cadc.powerDown());
+    TEST_ASSERT_EQUAL_INT32(409600, cadc.read<ADS1219_MUX_SINGLE_0>(&err));
+    TEST_ASSERT_EQUAL(ADS1219_OK, err);
+    TEST_ASSERT_EQUAL(3, ADS1219Device.starts());
+}
+
+void test_native_static_matches_runtime(void)
+{
+    int32_t counts[3] = { -8388608, 12345, 8388607 };
+    int32_t uv[3];
+
+    adc.begin();
+    adc.reset();
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setGain(ADS1219_GAIN_FOUR));
+    adc.toMicroVolts(counts, uv, 3);
+    for ( uint8_t i = 0; i < 3; i++ ) TEST_ASSERT_EQUAL_INT32(uv[i], sadc.microVolts(counts[i]));
+
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setVREF(ADS1219_VREF_EXTERNAL, 500.f, 4500.f));
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setGain(ADS1219_GAIN_ONE));
+    adc.toMicroVolts(counts, uv, 3);
+    for ( uint8_t i = 0; i < 3; i++ ) 
+        TEST_ASSERT_EQUAL_INT32(uv[i], (ADS1219T<0x40, 0, ADS1219Wire, ExternalConfig>::microVolts(counts[i])));
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_static_begin);
+    RUN_TEST(test_native_static_reset_twice);
+    RUN_TEST(test_native_static_read);
+    RUN_TEST(test_native_static_continuous);
+    RUN_TEST(test_native_static_matches_runtime);
+
+    UNITY_END();
+}
+
+void loop(){}
@@ -0,0 +1,248 @@
+#include "unity.h"
+
+#include <chrono>
+#include <stdio.h>
+
+#include "ADS1219.h"
+#include "ADS1219ScanPlan.h"
+#include "ADS1219Window.h"
+#include "ADS1219Emulator.h"
+
+// Window comparators : thresholds in counts, crossings with hysteresis and debounce on single reads,
+// events only streaming, auto-ranged scans, and the cost per sample
+
+ADS1219 adc;
+
+struct Event {
+    uint8_t mux;
+    uint8_t state;
+    int32_t value;
+};
+
+Event events[64];
+int n_events;
+
+static void on_event( uint8_t mux, uint8_t state, int32_t value, void* context )
+{
+    if ( n_events < 64 ) events[n_events++] = { mux, state, value };
+    ( *static_cast<int*>( context ) )++;
+}
+
+
+void setUp(void)
+{
+    ADS1219Device.powerCycle();
+    adc.begin();
+    adc.reset();
+    n_events = 0;
+}
+
+// the windows live on the stack of the tests
+void tearDown(void)
+{
+    for ( uint8_t i = 0; i < 8; i++ ) adc.setWindow( i << 5, nullptr );
+}
+
+
+void test_native_window_thresholds(void)
+{
+    ADS1219Window w;
+
+    TEST_ASSERT_FALSE(w.setThresholds(200.f, 100.f));
+    TEST_ASSERT_FALSE(w.setThresholds(100.f, 200.f, 100.f));
+    TEST_ASSERT_FALSE(w.setThresholds(100.f, 200.f, -1.f));
+    TEST_ASSERT_TRUE(w.setThresholds(100.f, 200.f, 10.f));
+
+    // 4096 counts per mV at gain 1 with the internal reference, 4 times that at gain 4
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.setWindow(ADS1219_MUX_SINGLE_0, &w));
+    TEST_ASSERT_EQUAL(&w, adc.window(ADS1219_MUX_SINGLE_0));
+    TEST_ASSERT_NULL(adc.window(ADS1219_MUX_SINGLE_1));
+    TEST_ASSERT_EQUAL_INT32(409600, w.low(ADS1219_GAIN_ONE));
+    TEST_ASSERT_EQUAL_INT32(819200, w.high(ADS1219_GAIN_ONE));
+    TEST_ASSERT_EQUAL_INT32(1638400, w.low(ADS1219_GAIN_FOUR));
+    TEST_ASSERT_EQUAL_INT32(3276800, w.high(ADS1219_GAIN_FOUR));
+
+    // a threshold beyond the full scale at gain 4 can't be reached
+    TEST_ASSERT_TRUE(w.setThresholds(-1000.f, 1000.f));
+    TEST_ASSERT_GREATER_THAN(8388607, w.high(ADS1219_GAIN_FOUR));
+
+    // converted again with the reference of the driver
+    ADS1219Device.setExternalReference(0.f, 1024.f);
+    ADS1219Config config(ADS1219_MUX_SINGLE_0, ADS1219_GAIN_ONE, ADS1219_DATARATE_20SPS, ADS1219_CM_SINGLE_SHOT, ADS1219_VREF_EXTERNAL, 0.f, 1024.f);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.applyConfig(config));
+    TEST_ASSERT_EQUAL_INT32(8192000, w.high(ADS1219_GAIN_ONE));
+
+    TEST_ASSERT_EQUAL(ADS1219_INVALID_MUX, adc.setWindow(0x07, &w));
+}
+
+void test_native_window_crossings(void)
+{
+    ADS1219Window w;
+    int calls = 0;
+    uint8_t err;
+
+    w.setThresholds(100.f, 200.f, 10.f);
+    w.onEvent(on_event, &calls);
+    adc.setWindow(ADS1219_MUX_SINGLE_0, &w);
+
+    // only the crossings are reported, the hysteresis holds the state near a threshold
+    const float input[]    = { 150, 199, 201, 250, 195, 191, 190, 150, 100, 99, 105, 110, 150 };
+    const uint8_t state[]  = { 0,   0,   1,   1,   1,   1,   0,   0,   0,   2,  2,   0,   0 };
+    for ( uint8_t i = 0; i < sizeof(input) / sizeof(input[0]); i++ ) {
+        ADS1219Device.setInput(0, input[i]);
+        adc.readSingleEnded(0, &err);
+        TEST_ASSERT_EQUAL(state[i], w.state());
+    }
+    TEST_ASSERT_EQUAL(4, calls);
+    TEST_ASSERT_EQUAL(4, w.events());
+    TEST_ASSERT_EQUAL(ADS1219_WINDOW_ABOVE, events[0].state);
+    TEST_ASSERT_EQUAL_INT32(201 * 4096, events[0].value);
+    TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_0, events[0].mux);
+    TEST_ASSERT_EQUAL(ADS1219_WINDOW_INSIDE, events[1].state);
+    TEST_ASSERT_EQUAL(ADS1219_WINDOW_BELOW, events[2].state);
+    TEST_ASSERT_EQUAL(ADS1219_WINDOW_INSIDE, events[3].state);
+
+    // the flag is cleared on reading
+    TEST_ASSERT_TRUE(w.event());
+    TEST_ASSERT_FALSE(w.event());
+
+    // other multiplexer settings don't go through it
+    ADS1219Device.setInput(1, 500.f);
+    adc.readSingleEnded(1, &err);
+    TEST_ASSERT_FALSE(w.event());
+
+    // debounce : a spike of 2 samples is ignored, 3 in a row change the state
+    w.reset();
+    w.setDebounce(3);
+    const float spikes[] = { 150, 300, 300, 150, 300, 300, 300, 300 };
+    for ( uint8_t i = 0; i < sizeof(spikes) / sizeof(spikes[0]); i++ ) {
+        ADS1219Device.setInput(0, spikes[i]);
+        adc.readSingleEnded(0, &err);
+        TEST_ASSERT_EQUAL(i >= 6 ? ADS1219_WINDOW_ABOVE : ADS1219_WINDOW_INSIDE, w.state());
+    }
+    TEST_ASSERT_EQUAL(1, w.events());
+}
+
+void test_native_window_stream(void)
+{
+    ADS1219Window w;
+    int calls = 0;
+    int32_t buf[ADS1219_STREAM_BUFFER_SIZE];
+    int32_t got[16];
+    int delivered = 0;
+
+    w.setThresholds(-100.f, 100.f, 5.f);
+    w.onEvent(on_event, &calls);
+    w.setSuppress(true);
+    adc.setWindow(ADS1219_MUX_SINGLE_2, &w);
+
+    // 1000 conversions of a slow triangle between 0 and 300 mV with noise : 3 excursions above the window
+    ADS1219Device.setNoise(400.f, 9);
+    TEST_ASSERT_EQUAL(ADS1219_OK, adc.startStream(ADS1219_MUX_SINGLE_2, ADS1219_DATARATE_330SPS));
+    uint32_t conversions = ADS1219Device.conversions();
+    while ( ADS1219Device.conversions() - conversions < 1000 ) {
+        uint32_t n = ADS1219Device.conversions() - conversions;
+        uint32_t t = n % 333;
+        ADS1219Device.setInput(2, 300.f * ( t < 167 ? t : 333 - t ) / 167.f);
+        adc.serviceStream();
+        delivered += adc.readBuffered(got + delivered, 16 - delivered);
+        delayMicroseconds(500);
+    }
+    adc.stopStream();
+    delivered += adc.readBuffered(got + delivered, 16 - delivered);
+
+    // only the events reach the application, the hysteresis keeps the noise from adding any
+    printf("1000 conversions, %d events delivered\n", delivered);
+    TEST_ASSERT_EQUAL(6, calls);
+    TEST_ASSERT_EQUAL(calls, delivered);
+    TEST_ASSERT_EQUAL(0, adc.overruns());
+    for ( int i = 0; i < calls; i++ ) TEST_ASSERT_EQUAL_INT32(events[i].value, got[i]);
+
+    // without suppression everything is delivered
+    w.setSuppress(false);
+    delivered = 0;
+    adc.startStream(ADS1219_MUX_SINGLE_2, ADS1219_DATARATE_330SPS);
+    conversions = ADS1219Device.conversions();
+    while ( ADS1219Device.conversions() - conversions < 100 ) {
+        adc.serviceStream();
+        delivered += adc.readBuffered(buf, ADS1219_STREAM_BUFFER_SIZE);
+        delayMicroseconds(500);
+    }
+    adc.stopStream();
+    delivered += adc.readBuffered(buf, ADS1219_STREAM_BUFFER_SIZE);
+    TEST_ASSERT_INT_WITHIN(1, 100, delivered);
+    TEST_ASSERT_EQUAL(0, adc.overruns());
+}
+
+void test_native_window_scan(void)
+{
+    ADS1219ScanPlan plan;
+    ADS1219Window w0, w1;
+    int calls = 0;
+    int32_t results[2];
+
+    // the same window in mV at either gain
+    w0.setThresholds(-50.f, 50.f);
+    w1.setThresholds(-50.f, 50.f);
+    w0.onEvent(on_event, &calls);
+    w1.onEvent(on_event, &calls);
+    adc.setWindow(ADS1219_MUX_SINGLE_0, &w0);
+    adc.setWindow(ADS1219_MUX_SINGLE_1, &w1);
+
+    plan.addSingleEnded(0, ADS1219_GAIN_AUTO);
+    plan.addSingleEnded(1, ADS1219_GAIN_ONE);
+
+    ADS1219Device.setInput(0, 40.f);
+    ADS1219Device.setInput(1, 40.f);
+    for ( int s = 0; s < 3; s++ ) adc.scan(plan, results);
+    TEST_ASSERT_EQUAL(ADS1219_GAIN_FOUR, plan.gain(0));
+    TEST_ASSERT_EQUAL(0, calls);
+
+    ADS1219Device.setInput(0, 60.f);
+    ADS1219Device.setInput(1, 60.f);
+    adc.scan(plan, results);
+    TEST_ASSERT_EQUAL(2, calls);
+    TEST_ASSERT_EQUAL(ADS1219_WINDOW_ABOVE, w0.state());
+    TEST_ASSERT_EQUAL(ADS1219_WINDOW_ABOVE, w1.state());
+    TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_0, events[0].mux);
+    TEST_ASSERT_EQUAL_HEX8(ADS1219_MUX_SINGLE_1, events[1].mux);
+}
+
+void test_native_window_benchmark(void)
+{
+    using clock = std::chrono::steady_clock;
+    ADS1219Window w;
+    int calls = 0;
+    int32_t values[1024];
+
+    w.setThresholds(-100.f, 100.f, 5.f);
+    w.setDebounce(2);
+    w.onEvent(on_event, &calls);
+    for ( int i = 0; i < 1024; i++ ) values[i] = ( i * 7919 ) % 1000000 - 500000;
+
+    uint32_t delivered = 0;
+    clock::time_point t0 = clock::now();
+    for ( int r = 0; r < 1000; r++ ) {
+        for ( int i = 0; i < 1024; i++ ) delivered += w.check(ADS1219_MUX_SINGLE_0, values[i], false);
+    }
+    clock::time_point t1 = clock::now();
+
+    printf("window check : %.2f ns/sample (%u delivered)\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / 1024000., static_cast<unsigned>(delivered));
+}
+
+
+void setup()
+{
+    UNITY_BEGIN();
+
+    RUN_TEST(test_native_window_thresholds);
+    RUN_TEST(test_native_window_crossings);
+    RUN_TEST(test_native_window_stream);
+    RUN_TEST(test_native_window_scan);
+    RUN_TEST(test_native_window_benchmark);
+
+    UNITY_END();
+}
+
+void loop(){}
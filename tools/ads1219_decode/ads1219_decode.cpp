@@ -0,0 +1,150 @@
+// Host side decoder for the packet stream of ADS1219PacketStream / ADS1219PacketWriter
+//
+// Build (from the repository root) :
+//
+//     g++ -std=gnu++11 -O2 -Iinclude -Ilib/ArduinoNative/src -o ads1219_decode
+//         tools/ads1219_decode/ads1219_decode.cpp src/ADS1219Packet.cpp src/ADS1219Record.cpp
+//
+// Usage : ads1219_decode [-c out.csv] [-b out.bin] [-t] [-n samples] input
+//
+//     input  a capture file, a serial port (e.g. /dev/ttyACM0) or - for stdin
+//     -c     write the samples as CSV : time_us,seq,mux,gain,counts
+//     -b     write the samples as 16 byte little endian records : int64 time_us, int32 counts, uint8 mux id,
+//            uint8 gain, uint16 seq
+//     -t     the input is a serial port, put it in raw mode (any baud rate works for USB CDC)
+//     -n     stop after this many samples
+//
+// A summary goes to stderr : packets, lost packets, CRC and framing errors, samples per input and the
+// decoding rate. The exit status is 3 if any packet was damaged, 2 for bad arguments, 1 if a file can't be
+// opened.
+//
+// test/test_native_decode builds the tool into a native test and runs it on capture files and a pseudo
+// terminal.
+
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include "ADS1219Packet.h"
+
+
+struct Output {
+    FILE*    csv;
+    FILE*    bin;
+    uint64_t limit;
+    uint64_t written;
+    uint64_t per_mux[8];
+};
+
+static const char* mux_name( uint8_t mux )
+{
+    static const char* names[8] = { "AIN0-AIN1", "AIN2-AIN3", "AIN1-AIN2", "AIN0", "AIN1", "AIN2", "AIN3", "SHORTED" };
+    return names[mux >> 5];
+}
+
+static void on_sample( const ADS1219PacketSample& s, void* context )
+{
+    Output* out = static_cast<Output*>( context );
+
+    // the rest of the packet which reached the limit
+    if ( out->limit > 0 && out->written >= out->limit ) return;
+    out->written++;
+    out->per_mux[s.mux >> 5]++;
+
+    if ( out->csv != nullptr )
+        fprintf( out->csv, "%llu,%u,%s,%u,%ld\n", static_cast<unsigned long long>( s.time_us ), s.seq,
+                 mux_name( s.mux ), s.gain, static_cast<long>( s.value ) );
+
+    if ( out->bin != nullptr ) {
+        uint8_t rec[16];
+        for ( int i = 0; i < 8; i++ ) rec[i] = static_cast<uint8_t>( s.time_us >> ( 8 * i ) );
+        for ( int i = 0; i < 4; i++ ) rec[8 + i] = static_cast<uint8_t>( static_cast<uint32_t>( s.value ) >> ( 8 * i ) );
+        rec[12] = s.mux >> 5;
+        rec[13] = s.gain;
+        rec[14] = static_cast<uint8_t>( s.seq );
+        rec[15] = static_cast<uint8_t>( s.seq >> 8 );
+        fwrite( rec, sizeof(rec), 1, out->bin );
+    }
+}
+
+static int usage( void )
+{
+    fprintf( stderr, "usage : ads1219_decode [-c out.csv] [-b out.bin] [-t] [-n samples] input\n" );
+    return 2;
+}
+
+int main( int argc, char** argv )
+{
+    Output out;
+    memset( &out, 0, sizeof(out) );
+    bool tty = false;
+    const char* input = nullptr;
+
+    for ( int i = 1; i < argc; i++ ) {
+        if ( strcmp( argv[i], "-c" ) == 0 && i + 1 < argc ) {
+            out.csv = strcmp( argv[++i], "-" ) == 0 ? stdout : fopen( argv[i], "w" );
+            if ( out.csv == nullptr ) { perror( argv[i] ); return 1; }
+            fprintf( out.csv, "time_us,seq,mux,gain,counts\n" );
+        } else if ( strcmp( argv[i], "-b" ) == 0 && i + 1 < argc ) {
+            out.bin = fopen( argv[++i], "wb" );
+            if ( out.bin == nullptr ) { perror( argv[i] ); return 1; }
+        } else if ( strcmp( argv[i], "-n" ) == 0 && i + 1 < argc ) {
+            out.limit = strtoull( argv[++i], nullptr, 10 );
+        } else if ( strcmp( argv[i], "-t" ) == 0 ) {
+            tty = true;
+        } else if ( input == nullptr ) {
+            input = argv[i];
+        } else {
+            return usage();
+        }
+    }
+    if ( input == nullptr ) return usage();
+
+    int fd = strcmp( input, "-" ) == 0 ? 0 : open( input, O_RDONLY | O_NOCTTY );
+    if ( fd < 0 ) { perror( input ); return 1; }
+
+    // no line discipline : 0x00, CR and LF are data
+    if ( tty ) {
+        struct termios t;
+        if ( tcgetattr( fd, &t ) != 0 ) { perror( input ); return 1; }
+        cfmakeraw( &t );
+        t.c_cc[VMIN]  = 1;
+        t.c_cc[VTIME] = 0;
+        tcsetattr( fd, TCSANOW, &t );
+    }
+
+    ADS1219PacketDecoder decoder( on_sample, &out );
+    static uint8_t buf[1 << 16];
+    uint64_t bytes = 0;
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    while ( out.limit == 0 || out.written < out.limit ) {
+        ssize_t n = read( fd, buf, sizeof(buf) );
+        if ( n < 0 && errno == EINTR ) continue;
+        if ( n <= 0 ) break;
+        decoder.push( buf, static_cast<size_t>( n ) );
+        bytes += static_cast<uint64_t>( n );
+    }
+    double s = std::chrono::duration<double>( std::chrono::steady_clock::now() - t0 ).count();
+
+    const ADS1219PacketReader& r = decoder.reader();
+    fprintf( stderr, "%llu bytes, %u packets, %u lost, %u CRC errors, %u framing errors, %u frames skipped, %u bad frames\n",
+             static_cast<unsigned long long>( bytes ), r.packets(), r.dropped(), r.crcErrors(), r.framingErrors(),
+             decoder.skippedFrames(), decoder.badFrames() );
+    for ( int m = 0; m < 8; m++ )
+        if ( out.per_mux[m] ) fprintf( stderr, "%-10s %llu samples\n", mux_name( m << 5 ), static_cast<unsigned long long>( out.per_mux[m] ) );
+    if ( s > 0 )
+        fprintf( stderr, "%llu samples in %.3f s, %.2f Msamples/s\n", static_cast<unsigned long long>( decoder.samples() ), s,
+                 decoder.samples() / s / 1e6 );
+
+    if ( out.csv != nullptr && out.csv != stdout ) fclose( out.csv );
+    if ( out.bin != nullptr ) fclose( out.bin );
+    if ( fd != 0 ) close( fd );
+
+    return r.crcErrors() + r.framingErrors() + decoder.badFrames() > 0 ? 3 : 0;
+}